@@ -34,14 +34,25 @@
 
 #include <cassert>
 #include <cctype>
+#include <ctime>
 #include <algorithm>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include <cereal/archives/portable_binary.hpp>
+
+#ifdef CONFIG_WIN32
+#include <io.h>
+#endif
+
 #include "display/graphics.h"
 #include "display/surface.h"
 #include "display/palettized_surface.h"
 
 #include "Buzz_inc.h"
+#include "aimast.h"
+#include "asset_registry.h"
 #include "utils.h"
 #include "ast1.h"
 #include "draw.h"
@@ -64,8 +75,9 @@
 #include "prest.h"
 #include "pbm.h"
 #include "legacy.h"
-
-#include <zlib.h>
+#include "save_index.h"
+#include "turn_history.h"
+#include "zlib_stream.h"
 
 #define MODEM_ERROR 4
 #define NOTSAME 2
@@ -91,40 +103,108 @@ enum SaveGameType {
     SAVEGAME_Modem = 0x04
 };
 
+enum SaveFormat {
+    SAVEFORMAT_Binary,
+    SAVEFORMAT_JSON,
+    SAVEFORMAT_PbemDelta
+};
+
 inline SaveGameType operator|(SaveGameType a, SaveGameType b);
 inline SaveGameType operator&(SaveGameType a, SaveGameType b);
 
 struct SFInfo {
     char Name[27], Title[23];
-    uint16_t time, date;
+    uint16_t time, date;    // Modification time in DOS format
     SaveGameType type;
+    SaveFileHdr header;
+    int64_t modified;
 };
 
-/* Result of savegame search */
-struct SaveGameEnumerator : public PhysFsEnumerator {
-    SaveGameType type;
-    int maxSaves = 100;
-    std::vector<SFInfo> results;
+/* Orders in which the save browser can list the saves */
+enum SaveOrder {
+    SAVEORDER_Title,
+    SAVEORDER_Date,
+    SAVEORDER_Turn,
+    SAVEORDER_Count
+};
 
-    SaveGameEnumerator(SaveGameType type, int maxSaves = 100) : type(type), maxSaves(maxSaves), PhysFsEnumerator("/") {}
-    virtual PHYSFS_EnumerateCallbackResult onItem(const std::string &origdir, const std::string &fname);
+/* An autosave being written in the background */
+struct AutosaveJob {
+    std::string name;
+    std::string path;       // Full path of the save file
+    SaveFileHdr header;
+    struct Players data;    // Snapshot of the game state
+    INTERIMDATA interim;
+    TurnHistory history;
+    GameRng rng;
+    int level;
+    SaveFormat format;
+    bool ok;
 };
 
+SDL_Thread *autosaveThread = NULL;
+SDL_mutex *autosaveLock = NULL;
+AutosaveJob *autosaveJob = NULL;
+bool autosaveDone = false;
+bool autosaveUnreported = false;  // An autosave failed, unseen by the player
+
+int RunAutosave(void *arg);
+void WaitForAutosave(bool report);
+
+/* The game state read from a save, before it replaces the live one. */
+struct LoadStage {
+    struct Players data;
+    INTERIMDATA interim;
+    TurnHistory history;
+    GameRng rng;
+    bool fromDelta;         // Rebuilt from a play-by-mail delta
+    uint32_t deltaBase;     // Hash of the delta's base, if so
+};
+
+/* A play-by-mail delta that doesn't apply to any state this side has */
+class PbemMismatch : public std::runtime_error
+{
+public:
+    PbemMismatch(const std::string &message)
+        : std::runtime_error(message) { };
+};
+
+// Kept between loads. Each load swaps the old game into the stage, so
+// the next one reuses its storage.
+LoadStage *loadStage = NULL;
+
+void ReadSaveData(std::istream &stream, const SaveFileHdr &header,
+                  LoadStage &stage);
+void CommitLoad(LoadStage &stage);
+
 
 };  // End of anon namespace
 
 
-void DrawFiles(char now, char loc, const std::vector<SFInfo> &savegames);
+void DrawFiles(int now, int loc, const std::vector<SFInfo> &savegames);
 void DrawTimeCapsule(int display);
 std::vector<SFInfo> GenerateTables(SaveGameType saveType);
+void SortSaves(std::vector<SFInfo> &savegames, SaveOrder order);
 std::string GetBlockName();
 SaveGameType GetSaveType(const SaveFileHdr &header);
-void FileText(const char *name);
+void FileText(const SFInfo &save);
 int FutureCheck(char plr, char type);
 void LoadGame(const char *filename);
 bool OrderSaves(const SFInfo &a, const SFInfo &b);
+bool OrderSavesByDate(const SFInfo &a, const SFInfo &b);
+bool OrderSavesByTurn(const SFInfo &a, const SFInfo &b);
 char RequestX(const char *s, char md);
-void write_save_file(const char *Name, SaveFileHdr header);
+SaveFormat ConfiguredSaveFormat();
+void PrepareSave(SaveFileHdr &header, SaveFormat format);
+bool WriteSaveData(FILE *fout, SaveFileHdr header,
+                   const struct Players &data, const INTERIMDATA &interim,
+                   const TurnHistory &history, const GameRng &rng,
+                   int level, SaveFormat format,
+                   const PbemDelta *delta = NULL);
+void write_save_file(const char *Name, SaveFileHdr header, int level,
+                     SaveFormat format);
+void AutosaveFailed();
+void PbemDeltaMismatch();
 int SaveGame(const std::vector<SFInfo> savegames);
 int PadPurchase[3];
 
@@ -141,6 +221,182 @@ inline SaveGameType operator&(SaveGameType a, SaveGameType b)
     return static_cast<SaveGameType>(
                static_cast<int>(a) & static_cast<int>(b));
 }
+
+/**
+ * Write an autosave to a temporary file, flush it to disk, and
+ * move it over the old save.
+ *
+ * Runs on the autosave thread, so it only touches the job and
+ * doesn't log.
+ */
+int RunAutosave(void *arg)
+{
+    AutosaveJob *job = static_cast<AutosaveJob *>(arg);
+    std::string tempPath = temp_path(job->path);
+    FILE *fout = fopen(tempPath.c_str(), "wb");
+
+    if (fout != NULL) {
+        job->ok = WriteSaveData(fout, job->header, job->data, job->interim,
+                                job->history, job->rng, job->level,
+                                job->format) &&
+                  fflush(fout) == 0 &&
+#ifdef CONFIG_WIN32
+                  _commit(_fileno(fout)) == 0;
+#else
+                  fsync(fileno(fout)) == 0;
+#endif
+
+        if (fclose(fout) != 0) {
+            job->ok = false;
+        }
+
+        if (job->ok) {
+            job->ok = (replace_file(tempPath, job->path) == 0);
+        }
+
+        if (!job->ok) {
+            remove(tempPath.c_str());
+        }
+    }
+
+    if (autosaveLock != NULL) {
+        SDL_LockMutex(autosaveLock);
+        autosaveDone = true;
+        SDL_UnlockMutex(autosaveLock);
+    }
+
+    return job->ok ? 0 : 1;
+}
+
+/**
+ * Wait for the current autosave, update the save index, and report
+ * any failure.
+ *
+ * A failure is kept until it can be shown, so one found where the
+ * player can't be told is shown by the next wait that can.
+ *
+ * \param report  true to tell the player of a failure.
+ */
+void WaitForAutosave(bool report)
+{
+    if (autosaveJob != NULL) {
+        if (autosaveThread != NULL) {
+            SDL_WaitThread(autosaveThread, NULL);
+            autosaveThread = NULL;
+        }
+
+        if (autosaveJob->ok) {
+            UpdateSaveIndex(autosaveJob->name.c_str());
+        } else {
+            ERROR2("can't write autosave `%s'", autosaveJob->path.c_str());
+            autosaveUnreported = true;
+        }
+
+        delete autosaveJob;
+        autosaveJob = NULL;
+    }
+
+    // Games played without display have no one to tell.
+    if (report && autosaveUnreported && !options.want_simulate) {
+        autosaveUnreported = false;
+        AutosaveFailed();
+    }
+}
+
+
+/**
+ * Read the game state from an inflated save into the stage.
+ *
+ * \param stream  the save data, following the header.
+ * \param header  the save file header, whose ID gives the format.
+ * \param stage  receives the game data, interim data, history and,
+ *     from saves that have them, the random number generators.
+ * \throws cereal::Exception  if the data is malformed or of an
+ *     unsupported version.
+ * \throws PbemMismatch  if a play-by-mail delta doesn't match this game.
+ */
+void ReadSaveData(std::istream &stream, const SaveFileHdr &header,
+                  LoadStage &stage)
+{
+    stage.fromDelta = false;
+    stage.history.clear();
+    // Older saves carry on from the current generators
+    stage.rng = gameRng;
+
+    if (header.ID == RaceIntoSpace_Binary_Sig) {
+        cereal::PortableBinaryInputArchive archive(stream);
+        uint32_t version;
+
+        archive(version);
+
+        if (version < 1 || version > SAVE_BINARY_VERSION) {
+            throw cereal::Exception("unsupported binary save version");
+        }
+
+        archive(stage.data);
+        archive(stage.interim);
+
+        if (version >= 5) {
+            archive(stage.history);
+        } else if (version == 4) {
+            // Its turns lack the replay data and generators, so
+            // rewinding to them would mix two timelines.
+            archive(stage.history);
+            stage.history.clear();
+        } else if (version >= 2) {
+            stage.history.skipRawHistory(archive);
+        }
+
+        if (version >= 3) {
+            archive(stage.rng);
+        }
+    } else if (header.ID == RaceIntoSpace_Delta_Sig) {
+        cereal::PortableBinaryInputArchive archive(stream);
+        uint32_t version;
+        PbemDelta delta;
+        std::string state;
+
+        archive(version);
+
+        if (version != SAVE_DELTA_VERSION) {
+            throw cereal::Exception("unsupported delta save version");
+        }
+
+        archive(delta);
+
+        if (!ApplyPbemDelta(delta, state)) {
+            throw PbemMismatch("play-by-mail delta doesn't match this game");
+        }
+
+        DeserializePbemState(state, stage.data);
+        archive(stage.interim);
+        stage.fromDelta = true;
+        stage.deltaBase = delta.baseHash;
+    } else {
+        cereal::JSONInputArchive archive(stream);
+
+        // Load game data
+        archive(cereal::make_nvp("Data", stage.data));
+
+        // Load Replay and Event Data
+        archive(stage.interim);
+    }
+}
+
+
+/**
+ * Make a fully read save the active game.
+ *
+ * The stage is left holding the previous game, whose storage the
+ * next load reuses.
+ */
+void CommitLoad(LoadStage &stage)
+{
+    std::swap(*Data, stage.data);
+    std::swap(interimData, stage.interim);
+    std::swap(turnHistory, stage.history);
+    std::swap(gameRng, stage.rng);
+}
 };
 
 /* Control loop for the Administration Office menu.
@@ -307,73 +563,113 @@ void CacheCrewFile()
 
     fclose(fin);
     fclose(dest);
+    AssetRegistry::invalidate("roster.json");
 }
 
-bool ReadGameSaveInfo(const std::string &fname, SFInfo &saveInfo)
+/**
+ * Describe a save file for the file browser.
+ *
+ * \param entry  the save's entry in the save index.
+ * \param saveInfo  receives the description.
+ * \return  false if the file name is too long to be listed.
+ */
+bool ReadGameSaveInfo(const SaveIndexEntry &entry, SFInfo &saveInfo)
 {
-    SaveFileHdr header;
-    FILE *fin = sOpen(fname.c_str(), "rb", FT_SAVE);
-
-    if (fin == NULL) {
-        NOTICE2("Unable to open save file %s, skipping",
-                fname.c_str());
+    if (entry.name.size() > sizeof(saveInfo.Name) - 1) {
         return false;
     }
 
-    size_t bytes = fread(&header, 1, sizeof(header), fin);
-    fclose(fin);
-
-    if (bytes != sizeof(header)) {
-        NOTICE2("Unable to read save file %s, skipping",
-                fname.c_str());
-        return false;
+    memset(&saveInfo, 0, sizeof(saveInfo));
+    strncpy(saveInfo.Title, entry.header.Name, sizeof(saveInfo.Title) - 1);
+    strncpy(saveInfo.Name, entry.name.c_str(), sizeof(saveInfo.Name) - 1);
+    saveInfo.header = entry.header;
+    saveInfo.modified = entry.modified;
+    saveInfo.type = GetSaveType(entry.header);
+
+    time_t modified = (time_t)entry.modified;
+    struct tm *local = (entry.modified >= 0) ? localtime(&modified) : NULL;
+
+    if (local != NULL && local->tm_year >= 80) {
+        saveInfo.time = (local->tm_hour << 11) | (local->tm_min << 5) |
+                        (local->tm_sec / 2);
+        saveInfo.date = ((local->tm_year - 80) << 9) |
+                        ((local->tm_mon + 1) << 5) | local->tm_mday;
     }
 
-    memset(&saveInfo, 0, sizeof(saveInfo));
-    strncpy(saveInfo.Title, header.Name, sizeof(saveInfo.Title) - 1);
-    strncpy(saveInfo.Name, fname.c_str(), sizeof(saveInfo.Name) - 1);
-    saveInfo.time = 0;  /* Was this ever read from somewhere? */
-    saveInfo.date = 0;
-    saveInfo.type = GetSaveType(header);
     return true;
 }
 
-PHYSFS_EnumerateCallbackResult SaveGameEnumerator::onItem(const std::string &origdir, const std::string &fname)
+/* Creates a list of all the save files of the selected type.
+ *
+ * The list is built from the save index, so the save files
+ * themselves are only read if they have changed.
+ *
+ * \param saveType  Include Normal, Modem, or Play by Email.
+ * \return  Entries ordered by save title.
+ */
+std::vector<SFInfo> GenerateTables(SaveGameType saveType)
 {
-    size_t len = fname.size();
-    SaveGameType type;
-    std::string name;
+    const std::vector<SaveIndexEntry> &index = GetSaveIndex();
+    std::vector<SFInfo> results;
     SFInfo saveInfo;
 
-    if (len >= 4 && xstrncasecmp(fname.c_str() + len - 4, ".SAV", 4) == 0 &&
-        fname.size() <= (sizeof(saveInfo.Name) - 1) &&
-        ReadGameSaveInfo(fname, saveInfo)) {
-        results.push_back(saveInfo);
+    results.reserve(index.size());
+
+    for (size_t i = 0; i < index.size(); i++) {
+        if (ReadGameSaveInfo(index[i], saveInfo)) {
+            results.push_back(saveInfo);
+        }
     }
 
-    if (results.size() < maxSaves) {
-        return PHYSFS_ENUM_OK;
-    } else {
-        return PHYSFS_ENUM_STOP;
+    SortSaves(results, SAVEORDER_Title);
+    return results;
+}
+
+
+/**
+ * Sort the save list by title, by date (newest first), or by game
+ * turn (latest first).
+ */
+void SortSaves(std::vector<SFInfo> &savegames, SaveOrder order)
+{
+    switch (order) {
+    case SAVEORDER_Date:
+        std::sort(savegames.begin(), savegames.end(), OrderSavesByDate);
+        break;
+
+    case SAVEORDER_Turn:
+        std::sort(savegames.begin(), savegames.end(), OrderSavesByTurn);
+        break;
+
+    default:
+        std::sort(savegames.begin(), savegames.end(), OrderSaves);
+        break;
     }
 }
 
-/* Creates a list of all the save files of the selected type, up to 100.
- *
- * Entries are ordered by save title.
+
+/**
+ * Go back to the start of the previous turn, as kept in the turn
+ * history, much as loading a save made then would.
  *
- * Currently, only the first 100 valid savegames are detected.
+ * The game data, the replays and news of the missions flown and the
+ * random number generators are all restored, so the turn plays out
+ * as if the later ones never happened. The newest turn in the history
+ * is the one being played. The turns after the one restored are
+ * dropped when it is recorded again.
  *
- * \param saveType  Include Normal, Modem, or Play by Email.
- * \return  Entries ordered by save title.
+ * \return  false if the history holds no earlier turn.
  */
-std::vector<SFInfo> GenerateTables(SaveGameType saveType)
+bool RewindTurn()
 {
-    SaveGameEnumerator saves(saveType);
-    if (saves.enumerate()) {
-        std::sort(saves.results.begin(), saves.results.end(), OrderSaves);
+    if (turnHistory.size() < 2 ||
+        !turnHistory.stateAt(turnHistory.size() - 2, *Data, interimData,
+                             gameRng)) {
+        return false;
     }
-    return saves.results;
+
+    ResetAI();
+    return true;
 }
 
 
@@ -408,6 +704,9 @@ void FileAccess(char mode)
         sc = 1;  // only allow mail save
     }
 
+    // The browser must see the finished autosave.
+    WaitForAutosave(true);
+
     helpText = "i128";
     keyHelpText = "k128";
     FadeOut(2, 10, 0, 0);
@@ -430,6 +729,7 @@ void FileAccess(char mode)
 #endif
 
     std::vector<SFInfo> savegames = GenerateTables(saveType);
+    SaveOrder order = SAVEORDER_Title;
 
     int enable = ENABLE_PLAY | ENABLE_QUIT;
 
@@ -455,7 +755,7 @@ void FileAccess(char mode)
     DrawFiles(0, 0, savegames);
 
     if (!savegames.empty()) {
-        FileText(&savegames[now].Name[0]);
+        FileText(savegames[now]);
     }
 
     FadeIn(2, 10, 0, 0);
@@ -477,7 +777,7 @@ void FileAccess(char mode)
                 DrawFiles(now, BarB, savegames);
 
                 if (!savegames.empty()) {
-                    FileText(&savegames[now].Name[0]);
+                    FileText(savegames[now]);
                 }
                 
                 WaitForMouseUp();
@@ -542,12 +842,16 @@ void FileAccess(char mode)
             if (i == 1) {
 
                 remove_savedat(savegames[now].Name);
+                RemoveFromSaveIndex(savegames[now].Name);
                 savegames.erase(savegames.begin() + now);
                 // TODO: Preserve positioning
                 now = 0;
                 BarB = 0;
                 DrawFiles(now, BarB, savegames);
-                FileText(&savegames[now].Name[0]);
+
+                if (!savegames.empty()) {
+                    FileText(savegames[now]);
+                }
 
                 if (savegames.size() == 0) {
                     InBox(207, 48, 280, 60);
@@ -562,6 +866,44 @@ void FileAccess(char mode)
 
             }
 
+            key = 0;
+        } else if (key == 'R' && sc == 0 && mode == 0 &&
+                   turnHistory.size() > 1) {
+            // Go back to the start of the previous turn
+            if (RequestX("REWIND A TURN", 1) == 1 && RewindTurn()) {
+                LOAD = done = 1;
+            }
+
+            key = 0;
+        } else if (key == 'O' && savegames.size() > 1) {
+            // Cycle the sort order, keeping the selected save in view
+            std::string selected = savegames[now].Name;
+            order = static_cast<SaveOrder>((order + 1) % SAVEORDER_Count);
+            SortSaves(savegames, order);
+
+            for (i = 0; i < savegames.size(); i++) {
+                if (selected == savegames[i].Name) {
+                    now = i;
+                    break;
+                }
+            }
+
+            BarB = MIN(now, 8);
+            DrawFiles(now, BarB, savegames);
+            FileText(savegames[now]);
+
+            if (now - BarB > 0) {
+                draw_up_arrow_highlight(194, 55);
+            } else {
+                draw_up_arrow(194, 55);
+            }
+
+            if (savegames.size() > now + (9 - BarB)) {
+                draw_down_arrow_highlight(194, 94);
+            } else {
+                draw_down_arrow(194, 94);
+            }
+
             key = 0;
         } else if ((x >= 209 && y >= 106 && x <= 278 && y <= 114 && mousebuttons > 0) || (key == 'P') || key == K_ESCAPE) {
             InBox(209, 106, 278, 114);
@@ -596,7 +938,7 @@ void FileAccess(char mode)
                 if (now > 0) {
                     now--;
                     DrawFiles(now, BarB, savegames);
-                    FileText(&savegames[now].Name[0]);
+                    FileText(savegames[now]);
                 }
             }
 
@@ -604,7 +946,7 @@ void FileAccess(char mode)
                 BarB--;
                 now--;
                 DrawFiles(now, BarB, savegames);
-                FileText(&savegames[now].Name[0]);
+                FileText(savegames[now]);
             }
 
             // WaitForMouseUp();
@@ -626,7 +968,7 @@ void FileAccess(char mode)
             now = 0;
             BarB = 0;
             DrawFiles(now, BarB, savegames);
-            FileText(&savegames[now].Name[0]);
+            FileText(savegames[now]);
 
             if (savegames.size() > 8) {
                 draw_down_arrow_highlight(194, 94);
@@ -649,7 +991,7 @@ void FileAccess(char mode)
                 }
 
                 DrawFiles(now, BarB, savegames);
-                FileText(&savegames[now].Name[0]);
+                FileText(savegames[now]);
             }
 
             if (now == 0) {
@@ -691,7 +1033,7 @@ void FileAccess(char mode)
                     }
 
                     DrawFiles(now, BarB, savegames);
-                    FileText(&savegames[now].Name[0]);
+                    FileText(savegames[now]);
 
                     if (savegames.size() > 7) {
                         draw_up_arrow_highlight(194, 55);
@@ -715,7 +1057,7 @@ void FileAccess(char mode)
             }
 
             DrawFiles(now, BarB, savegames);
-            FileText(&savegames[now].Name[0]);
+            FileText(savegames[now]);
 
             key = 0;
 
@@ -737,7 +1079,7 @@ void FileAccess(char mode)
 
             draw_down_arrow(194, 94);
             DrawFiles(now, BarB, savegames);
-            FileText(&savegames[now].Name[0]);
+            FileText(savegames[now]);
 
             key = 0;
 
@@ -748,7 +1090,7 @@ void FileAccess(char mode)
                 if (now < (savegames.size() - 1)) {
                     now++;
                     DrawFiles(now, BarB, savegames);
-                    FileText(&savegames[now].Name[0]);
+                    FileText(savegames[now]);
                     draw_up_arrow_highlight(194, 55);
                 }
             }
@@ -757,7 +1099,7 @@ void FileAccess(char mode)
                 BarB++;
                 now++;
                 DrawFiles(now, BarB, savegames);
-                FileText(&savegames[now].Name[0]);
+                FileText(savegames[now]);
             }
 
 
@@ -795,7 +1137,7 @@ void FileAccess(char mode)
  * \param loc     The display index of the current save file.
  * \param savegames  TODO
  */
-void DrawFiles(char now, char loc, const std::vector<SFInfo> &savegames)
+void DrawFiles(int now, int loc, const std::vector<SFInfo> &savegames)
 {
     int j = 0;
     int start = now - loc;
@@ -924,24 +1266,100 @@ SaveGameType GetSaveType(const SaveFileHdr &header)
  *   - the Replay information detailing the events of launches
  *   - the event data, consisting of each turn's news text
  *
+ * The game data is copied and written out on a worker thread, so the
+ * game can carry on at once. The save replaces the old one only once
+ * it is complete. CheckAutosave(), or whatever waits for the save
+ * first, reports a failure.
+ *
  * \param name  The filename to write the save under.
  */
 void autosave_game(const char *name)
 {
-    FILE *outf;
     SaveFileHdr hdr;
 
+    // Only one autosave is written at a time.
+    WaitForAutosave(true);
+
     memset(&hdr, 0, sizeof hdr);
 
     hdr.ID = RaceIntoSpace_Signature;
     strcpy(hdr.Name, "AUTOSAVE");
     hdr.Name[sizeof hdr.Name - 1] = 0x1a;
 
-    write_save_file(name, hdr);
+    AutosaveJob *job = new AutosaveJob;
+    job->name = name;
+    job->path = std::string(options.dir_savegame) + "/" + name;
+    job->format = ConfiguredSaveFormat();
+    // Autosaves happen every turn, so favor speed over size.
+    job->level = Z_BEST_SPEED;
+    job->ok = false;
+
+    PrepareSave(hdr, job->format);
+    job->header = hdr;
+    job->data = *Data;
+    job->interim = interimData;
+    job->rng = gameRng;
+
+    if (options.want_save_history) {
+        job->history = turnHistory;
+    }
 
     // Repair data modified by save
     Data->plr[0] = Data->Def.Plr1 = plr[0] = 2 * AI[0];
     Data->plr[1] = Data->Def.Plr2 = plr[1] = 1 + 2 * AI[1];
+
+    if (autosaveLock == NULL) {
+        autosaveLock = SDL_CreateMutex();
+        atexit(FinishAutosave);
+    }
+
+    autosaveJob = job;
+    autosaveDone = false;
+    autosaveThread = (autosaveLock != NULL) ?
+                     SDL_CreateThread(RunAutosave, job) : NULL;
+
+    if (autosaveThread == NULL) {
+        RunAutosave(job);
+        WaitForAutosave(true);
+    }
+}
+
+
+/**
+ * Report on a finished autosave, if there is one.
+ *
+ * This doesn't wait for an autosave still being written, so it is
+ * cheap enough to call from an input loop.
+ */
+void CheckAutosave()
+{
+    if (autosaveJob == NULL) {
+        if (autosaveUnreported) {
+            WaitForAutosave(true);
+        }
+
+        return;
+    }
+
+    SDL_LockMutex(autosaveLock);
+    bool done = autosaveDone;
+    SDL_UnlockMutex(autosaveLock);
+
+    if (done) {
+        WaitForAutosave(true);
+    }
+}
+
+
+/**
+ * Wait for any autosave being written to finish.
+ *
+ * Failures are logged but not shown, since this is called as the
+ * game closes.
+ */
+void FinishAutosave()
+{
+    WaitForAutosave(false);
 }
 
 
@@ -1048,31 +1466,59 @@ void BadFileType()
 }
 
 
+/* Displays an alert popup warning that the autosave failed.
+ */
+void AutosaveFailed()
+{
+    display::LegacySurface local(164, 77);
+    local.copyFrom(display::graphics.legacyScreen(), 39, 50, 202, 126);
+    ShBox(39, 50, 202, 126);
+    InBox(43, 67, 197, 77);
+    fill_rectangle(44, 68, 196, 76, 13);
+    display::graphics.setForegroundColor(11);
+    draw_string(79, 74, "AUTOSAVE FAILED");
+    delay(2000);
+    local.copyTo(display::graphics.legacyScreen(), 39, 50);
+    PauseMouse();
+    local.copyTo(display::graphics.legacyScreen(), 39, 50);
+}
+
+
+/* Displays an alert popup warning that a play-by-mail turn is a delta
+ * against a state this side doesn't have, so the opponent must send
+ * a full save.
+ */
+void PbemDeltaMismatch()
+{
+    display::LegacySurface local(164, 77);
+    local.copyFrom(display::graphics.legacyScreen(), 39, 50, 202, 126);
+    ShBox(39, 50, 202, 126);
+    InBox(43, 67, 197, 77);
+    fill_rectangle(44, 68, 196, 76, 13);
+    display::graphics.setForegroundColor(11);
+    draw_string(67, 74, "DELTA DOESN'T MATCH");
+    display::graphics.setForegroundColor(1);
+    draw_string(67, 95, "ASK FOR A FULL SAVE");
+    delay(2000);
+    local.copyTo(display::graphics.legacyScreen(), 39, 50);
+    PauseMouse();
+    local.copyTo(display::graphics.legacyScreen(), 39, 50);
+}
+
+
 /* Displays a brief text summary of the savegame contents.
  *
  * The summary includes the names of the two space program directors,
  * the type of savegame, and the turn (as year & season).
  *
- * \param name  A savegame filename.
+ * \param save  A savegame entry.
  */
-void FileText(const char *name)
+void FileText(const SFInfo &save)
 {
-    FILE *fin;
-    SaveFileHdr header;
+    SaveFileHdr header = save.header;
 
     fill_rectangle(38, 133, 279, 155, 3);
     display::graphics.setForegroundColor(1);
-    fin = sOpen(name, "rb", FT_SAVE);
-
-    if (fin == NULL) {
-        display::graphics.setForegroundColor(11);
-        draw_string(70, 147, "NO HISTORY RECORDED");
-        return;
-    }
-
-    fread(&header, sizeof(header), 1, fin);
-
-    fclose(fin);
 
     // Make sure player names are null-terminated
     header.PName[0][19] = 0;
@@ -1262,7 +1708,7 @@ int FutureCheck(char plr, char type)
             // TODO: Rewrite this to use a MissionType& and remove the
             // duplicate code.
             if (type == 1) {   // VAB/VIB
-                const struct mStr plan = GetMissionPlan(Data->P[plr].Mission[i].MissionCode);
+                const struct mStr &plan = GetMissionPlan(Data->P[plr].Mission[i].MissionCode);
                 draw_string(111, 41 + i * 51, (plan.Abbr).c_str());
                 int MisCod = Data->P[plr].Mission[i].MissionCode;
 
@@ -1295,7 +1741,7 @@ int FutureCheck(char plr, char type)
                     display::graphics.setForegroundColor(8);
                 }
 
-                const struct mStr plan = GetMissionPlan(Data->P[plr].Future[i].MissionCode);
+                const struct mStr &plan = GetMissionPlan(Data->P[plr].Future[i].MissionCode);
                 display::graphics.setForegroundColor(1);
                 draw_string(111, 41 + i * 51, (plan.Abbr).c_str());
                 int MisCod = Data->P[plr].Future[i].MissionCode;
@@ -1318,7 +1764,7 @@ int FutureCheck(char plr, char type)
                 display::graphics.setForegroundColor(1);
 
                 // Show (RE)ASSIGN FUTURE MISSION in other color if missing requirement penalties
-                const struct mStr plan = GetMissionPlan(Data->P[plr].Future[i].MissionCode);
+                const struct mStr &plan = GetMissionPlan(Data->P[plr].Future[i].MissionCode);
                 int penalty = AchievementPenalty(plr, plan);
 
                 if (penalty > 2) {
@@ -1615,13 +2061,16 @@ int FutureCheck(char plr, char type)
  *        and then of course wouldn't have worked with a winmodem.
  *         -Leon)
  *
- *   header.dataSize   is the size of the uncompressed JSON string
+ *   header.dataSize   is the size of the uncompressed data
+ *   header.ID         is RaceIntoSpace_Binary_Sig for binary saves,
+ *                     RaceIntoSpace_Delta_Sig for play-by-mail deltas,
+ *                     which are otherwise JSON
  *
- * TODO: The new values for the global variables are assigned as they
- * are read, which reduces memory requirements but means the
- * current game state may be overwritten before an error in the file
- * is noticed. This would prevent loading, but make it impossible to
- * return to the active game.
+ * Compressed saves are inflated straight into the deserializer and
+ * read into a staging copy of the game state, which replaces the
+ * active game only once the whole file has been read. A bad file
+ * leaves the active game untouched. Legacy saves are still read
+ * into the globals as they go.
  *
  * TODO: Add error handling on read/write commands.
  *
@@ -1630,12 +2079,8 @@ int FutureCheck(char plr, char type)
  */
 void LoadGame(const char *filename)
 {
-    LEGACY_REPLAY *load_buffer = NULL;
     SaveFileHdr header;
     unsigned char magic[2];
-    unsigned char *cbuf, *buf;
-    uLongf usize = 0;
-    int i, ok, offset;
 
     FILE *fin = sOpen(filename, "rb", FT_SAVE);
 
@@ -1644,50 +2089,49 @@ void LoadGame(const char *filename)
     rewind(fin);
     fread(&header, 1, sizeof(header), fin);
 
-    // Read the uncompressed size in big endian
-    for (i = 3; i >= 0; i--) {
-        usize += header.dataSize[i] << 8 * i;
-    }
-
     fread(magic, 1, 2, fin);
     fseek(fin, -2, SEEK_CUR);
 
-    if (magic[0] == 0x78 && magic[1] == 0xDA) { // zlib magic numbers
-        size_t csize = fileLength - sizeof(header);
-        cbuf = (unsigned char *) malloc(csize);
-        buf = (unsigned char *) malloc(usize);
-        assert(cbuf && buf);
-        fread(cbuf, csize, 1, fin);
-        fclose(fin);
+    if (IsZlibHeader(magic)) {
+        // Inflate straight into the deserializer
+        InflateStreamBuf inflater(fin);
 
-        ok = uncompress(buf, &usize, cbuf, csize);
+        if (loadStage == NULL) {
+            loadStage = new LoadStage;
+        }
 
-        if (ok != Z_OK) {
+        try {
+            std::istream stream(&inflater);
+            ReadSaveData(stream, header, *loadStage);
+        } catch (PbemMismatch &e) {
+            WARNING1(e.what());
+            fclose(fin);
+            PbemDeltaMismatch();
+            return;
+        } catch (std::exception &e) {
+            WARNING1(e.what());
+            fclose(fin);
             BadFileType();
             return;
         }
 
-        // Make sure that the uncompressed data is null-terminated
-        buf[usize - 1] = 0;
-
-        try {
-            stringstream stream;
-            stream << buf;
-            cereal::JSONInputArchive archive(stream);
-
-            // Load game data
-            archive(cereal::make_nvp("Data", *Data));
+        fclose(fin);
 
-            // Load Replay and Event Data
-            archive(interimData);
-        } catch (std::exception &e) {
-            WARNING1(e.what());
+        if (!inflater.good()) {
             BadFileType();
             return;
         }
 
+        CommitLoad(*loadStage);
+
+        // Only now is the delta's base known to be one the opponent has
+        if (loadStage->fromDelta) {
+            AcceptPbemDelta(loadStage->deltaBase);
+        }
+
     } else { // Not zlib compressed data
         if (Help("i174") == 1) {
+            turnHistory.clear();
             LegacyLoad(header, fin, fileLength);
         } else {
             return;
@@ -1703,11 +2147,16 @@ void LoadGame(const char *filename)
         AI[0] = (plr[0] == 2 || plr[0] == 3);
         AI[1] = (plr[1] == 2 || plr[1] == 3);
 
+        ResetAI();
+        ClearPbemBase();
         CacheCrewFile();
         LOAD = 1;
     } else if (GetSaveType(header) == SAVEGAME_PlayByMail) {
         Option = -1;
 
+        // The opponent's next turn will be a delta against this
+        SetPbemBase(SerializePbemState(*Data));
+
         Data->plr[0] = Data->Def.Plr1 = plr[0] = 0;
         Data->plr[1] = Data->Def.Plr2 = plr[1] = 1;
 
@@ -1718,6 +2167,8 @@ void LoadGame(const char *filename)
         CacheCrewFile();
         LOAD = 1;
     } else if (GetSaveType(header) == SAVEGAME_Modem) {
+        ClearPbemBase();
+
         // Modem connect up
         if (header.Country[0] == 6) {
             plr[0] = header.Country[0];
@@ -1783,6 +2234,27 @@ bool OrderSaves(const SFInfo &a, const SFInfo &b)
 }
 
 
+/**
+ * Sort SFInfo objects newest first, then by Title.
+ */
+bool OrderSavesByDate(const SFInfo &a, const SFInfo &b)
+{
+    return (a.modified > b.modified) ||
+           (a.modified == b.modified && OrderSaves(a, b));
+}
+
+
+/**
+ * Sort SFInfo objects by the latest game turn first, then by Title.
+ */
+bool OrderSavesByTurn(const SFInfo &a, const SFInfo &b)
+{
+    int turnA = 2 * a.header.Year + a.header.Season;
+    int turnB = 2 * b.header.Year + b.header.Season;
+    return (turnA > turnB) || (turnA == turnB && OrderSaves(a, b));
+}
+
+
 /* Creates a popup confirmation box, blocking input until resolved.
  *
  * \param s   The heading text.
@@ -1844,18 +2316,28 @@ char RequestX(const char *s, char md)
 }
 
 
-/*
- * Writes the actual save file to disk. Data, replay data, and event
- * data are serialized into a JSON string, compressed by zlib, and
- * written to disk.
+/**
+ * The save format chosen in the configuration file.
+ *
+ * Binary is the default; JSON remains available for debugging and
+ * for exporting game data.
  */
-void write_save_file(const char *Name, SaveFileHdr header)
+SaveFormat ConfiguredSaveFormat()
 {
-    FILE *fin;
-    int i, offset, size;
-    long unsigned int csize;
-    unsigned char *cbuf;
+    return options.want_json_saves ? SAVEFORMAT_JSON : SAVEFORMAT_Binary;
+}
+
 
+/*
+ * Fills in the save file header and applies the player settings the
+ * save is stored with. This changes Data->Def, Data->plr, and for
+ * mail games AI, which autosave_game() restores afterwards.
+ *
+ * \param header  the save file header.
+ * \param format  whether JSON or binary data will be written.
+ */
+void PrepareSave(SaveFileHdr &header, SaveFormat format)
+{
     strcpy(header.PName[0], Data->P[plr[0] % 2].Name);
     strcpy(header.PName[1], Data->P[plr[1] % 2].Name);
 
@@ -1889,42 +2371,169 @@ void write_save_file(const char *Name, SaveFileHdr header)
     header.Season = Data->Season;
     header.Year = Data->Year;
 
-    stringstream stream;
-    {
-        cereal::JSONOutputArchive::Options options = 
-            cereal::JSONOutputArchive::Options::NoIndent();
-        cereal::JSONOutputArchive archive(stream, options);
+    switch (format) {
+    case SAVEFORMAT_Binary:
+        header.ID = RaceIntoSpace_Binary_Sig;
+        break;
 
-        // Save End of Turn Data
-        archive(cereal::make_nvp("Data", *Data));
+    case SAVEFORMAT_PbemDelta:
+        header.ID = RaceIntoSpace_Delta_Sig;
+        break;
 
-        // Save Replay and Event Data
-        archive(interimData);
+    default:
+        header.ID = RaceIntoSpace_Signature;
+        break;
     }
+}
+
 
-    size = sizeof(char) * stream.str().size() + 1;
+/*
+ * Writes a save file's contents. Game data, replay data, and event
+ * data are serialized as JSON or portable binary and compressed by
+ * zlib on their way to disk, so the document is never held in memory
+ * as a whole.
+ *
+ * The header ID tells the formats apart: RaceIntoSpace_Signature for
+ * JSON, RaceIntoSpace_Binary_Sig for binary and RaceIntoSpace_Delta_Sig
+ * for play-by-mail deltas, which hold the delta in place of the game
+ * data and have no turn history.
+ *
+ * The header records the uncompressed size, which is only known once
+ * the data is written, so it is written again afterwards.
+ *
+ * This touches no global state, so it may run on a worker thread.
+ *
+ * \param fout  a file open for writing, positioned at the start.
+ * \param header  the save file header, as set up by PrepareSave().
+ * \param data  the game data.
+ * \param interim  the replay and event data.
+ * \param history  the turn history, stored only in binary saves.
+ * \param rng  the random number generators, stored only in binary saves.
+ * \param level  the zlib compression level, from Z_BEST_SPEED to
+ *     Z_BEST_COMPRESSION.
+ * \param format  whether to write JSON, binary or delta data.
+ * \param delta  the changes to the game data, for delta saves.
+ * \return  true if everything was written.
+ */
+bool WriteSaveData(FILE *fout, SaveFileHdr header,
+                   const struct Players &data, const INTERIMDATA &interim,
+                   const TurnHistory &history, const GameRng &rng,
+                   int level, SaveFormat format, const PbemDelta *delta)
+{
+    // Reserve space for the Save Game Header
+    fwrite(&header, sizeof(header), 1, fout);
+
+    DeflateStreamBuf deflater(fout, level);
+    bool ok;
+
+    {
+        std::ostream stream(&deflater);
+
+        if (format == SAVEFORMAT_Binary) {
+            cereal::PortableBinaryOutputArchive archive(stream);
+            uint32_t version = SAVE_BINARY_VERSION;
+
+            archive(version);
+            archive(data);
+            archive(interim);
+            archive(history);
+            archive(rng);
+        } else if (format == SAVEFORMAT_PbemDelta) {
+            cereal::PortableBinaryOutputArchive archive(stream);
+            uint32_t version = SAVE_DELTA_VERSION;
+
+            assert(delta != NULL);
+            archive(version);
+            archive(*delta);
+            archive(interim);
+        } else {
+            cereal::JSONOutputArchive::Options options =
+                cereal::JSONOutputArchive::Options::NoIndent();
+
+            {
+                cereal::JSONOutputArchive archive(stream, options);
+
+                // Save End of Turn Data
+                archive(cereal::make_nvp("Data", data));
+
+                // Save Replay and Event Data
+                archive(interim);
+            }
+
+            // The document is stored with its null terminator.
+            stream.put('\0');
+        }
+
+        ok = stream.good() && deflater.finish();
+    }
 
-    fin = sOpen(Name, "wb", FT_SAVE);
+    uint32_t size = deflater.totalIn();
 
     // Uncompressed size in big endian
-    for (i = 3; i >= 0; i--) {
+    for (int i = 3; i >= 0; i--) {
         header.dataSize[i] = size >> 8 * i;
     }
 
     // Write the Save Game Header
-    fwrite(&header, sizeof(header), 1, fin);
+    return ok && fseek(fout, 0, SEEK_SET) == 0 &&
+           fwrite(&header, sizeof(header), 1, fout) == 1;
+}
 
-    csize = compressBound(size);
 
-    cbuf = (unsigned char *) malloc(csize);
-    assert(cbuf);
+/*
+ * Writes the actual save file to disk.
+ *
+ * \param Name  the file name, relative to the save directory.
+ * \param header  the save file header.
+ * \param level  the zlib compression level, from Z_BEST_SPEED to
+ *     Z_BEST_COMPRESSION.
+ * \param format  whether to write JSON or binary data.
+ */
+void write_save_file(const char *Name, SaveFileHdr header, int level,
+                     SaveFormat format)
+{
+    // Play-by-mail turns only carry what changed since the opponent's
+    // turn, if this side has the state the opponent last sent.
+    bool pbem = (MAIL != -1);
 
-    compress2(cbuf, &csize, (unsigned char *) stream.str().data(), size, 9);
-    fwrite(cbuf, csize, 1, fin);
+    if (pbem && HavePbemBase() && !options.want_pbem_full_saves) {
+        format = SAVEFORMAT_PbemDelta;
+    }
 
-    fclose(fin);
+    PrepareSave(header, format);
+
+    std::string state;
+    PbemDelta delta;
+
+    if (pbem) {
+        state = SerializePbemState(*Data);
+
+        if (format == SAVEFORMAT_PbemDelta) {
+            delta = MakePbemDelta(state);
+        }
+    }
+
+    FILE *fout = sOpen(Name, "wb", FT_SAVE);
+
+    if (fout == NULL) {
+        ERROR2("can't open save file `%s'", Name);
+        return;
+    }
+
+    TurnHistory noHistory;
+    const TurnHistory &history =
+        options.want_save_history ? turnHistory : noHistory;
+    bool ok = WriteSaveData(fout, header, *Data, interimData, history,
+                            gameRng, level, format, &delta);
+
+    if (fclose(fout) != 0 || !ok) {
+        ERROR2("error writing save file `%s'", Name);
+    } else if (pbem) {
+        // Keep what was sent, as the base for the opponent's reply
+        StorePbemState(state);
+    }
 
-    free(cbuf);
+    UpdateSaveIndex(Name);
 }
 
 /**
@@ -1979,9 +2588,11 @@ int SaveGame(const std::vector<SFInfo> savegames)
 
     if (temp == NOTSAME) {
         std::string filename = title + ".SAV";
-        write_save_file(filename.c_str(), header);
+        write_save_file(filename.c_str(), header, Z_BEST_COMPRESSION,
+                        ConfiguredSaveFormat());
     } else {
-        write_save_file(savegames[i].Name, header);
+        write_save_file(savegames[i].Name, header, Z_BEST_COMPRESSION,
+                        ConfiguredSaveFormat());
     }
 
     return 0;
@@ -6,8 +6,11 @@
 void Admin(char plr);
 void CacheCrewFile();
 void FileAccess(char mode);
+bool RewindTurn();
 int FutureCheck(char plr, char type);
 void autosave_game(const char *name);
+void CheckAutosave();
+void FinishAutosave();
 void BadFileType();
 void CheckMSF ();
 
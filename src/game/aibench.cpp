@@ -0,0 +1,350 @@
+// This file handles the benchmark of the computer player's turn.
+//
+// With --bench-ai the game plays a headless computer-vs-computer game
+// (see simulate.cpp), then takes a mid-game and a late-game turn from
+// its turn history and plays the computer players' half of that turn
+// again and again. Each run starts from the same game state and random
+// numbers, so every run does the same work.
+//
+// Runs are made with cold caches, where every loaded asset is dropped
+// first (the operating system's file cache is left alone), and with
+// warm caches. For each phase of the turn (see AIBenchPhase) the
+// benchmark prints as JSON how many times it was called, how long it
+// took and how many files it opened, per run.
+//
+// Counting memory allocations means replacing the global operator new
+// for the whole program, so it is only done in builds configured with
+// -DBENCH_ALLOCATIONS=ON; the results then have allocations too.
+
+#include "aibench.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "Buzz_inc.h"
+#include "aimast.h"
+#include "asset_registry.h"
+#include "filesystem.h"
+#include "game_main.h"
+#include "news.h"
+#include "options.h"
+#include "rng.h"
+#include "simulate.h"
+#include "turn_history.h"
+
+LOG_DEFAULT_CATEGORY(LOG_ROOT_CAT)
+
+
+namespace
+{
+/* What a phase took over a series of runs. */
+struct PhaseSummary {
+    const char *name;
+    int runs;
+    uint64_t calls;
+    double seconds;
+    double maxSeconds;   // The slowest run
+    uint64_t allocations;
+    uint64_t fileOpens;
+
+    void add(const AIBenchCounts &run)
+    {
+        runs++;
+        calls += run.calls;
+        seconds += run.seconds;
+        maxSeconds = std::max(maxSeconds, run.seconds);
+        allocations += run.allocations;
+        fileOpens += run.fileOpens;
+    }
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        double n = runs ? runs : 1;
+
+        ar(cereal::make_nvp("calls", calls / n));
+        ar(cereal::make_nvp("ms", 1000 * seconds / n));
+        ar(cereal::make_nvp("max_ms", 1000 * maxSeconds));
+#ifdef BENCH_ALLOCATIONS
+        ar(cereal::make_nvp("allocations", allocations / n));
+#endif
+        ar(cereal::make_nvp("file_opens", fileOpens / n));
+    }
+};
+
+/* A series of runs of one turn with warm or cold caches. */
+struct CacheSummary {
+    bool cold;
+    PhaseSummary phases[AIBENCH_PHASES];
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        for (int i = 0; i < AIBENCH_PHASES; i++) {
+            ar(cereal::make_nvp(phases[i].name, phases[i]));
+        }
+    }
+};
+
+/* The benchmark of one turn. */
+struct TurnSummary {
+    const char *name;
+    int year;
+    int season;
+    int missions;       // Flown by both sides so far
+    int astronauts;     // Recruited by both sides so far
+    CacheSummary caches[2];
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(cereal::make_nvp("turn", std::string(name)));
+        ar(cereal::make_nvp("year", 1900 + year));
+        ar(cereal::make_nvp("season", std::string(season ? "fall" : "spring")));
+        ar(cereal::make_nvp("missions", missions));
+        ar(cereal::make_nvp("astronauts", astronauts));
+        ar(cereal::make_nvp("cold", caches[0]));
+        ar(cereal::make_nvp("warm", caches[1]));
+    }
+};
+
+const char *const PHASE_NAMES[AIBENCH_PHASES] = {
+    "AIEvent", "AIMaster", "NewAI", "AIPur", "SelectBest", "AILaunch"
+};
+
+// The counts of the run being timed on this thread, if any
+thread_local AIBenchCounts *benchRun = NULL;
+thread_local uint64_t allocationCount = 0;
+thread_local uint64_t fileOpenCount = 0;
+
+
+/* Play the computer players' half of the turn, timing its phases. */
+void TimeRun(AIBenchCounts (&run)[AIBENCH_PHASES])
+{
+    AIBenchStart(run);
+
+    for (int i = 0; i < NUM_PLAYERS; i++) {
+        {
+            AIBenchScope scope(AIBENCH_AIEvent);
+            AIEvent(i);
+        }
+
+        {
+            AIBenchScope scope(AIBENCH_AIMaster);
+            AIMaster(i);
+        }
+    }
+
+    AIBenchStop();
+}
+
+
+/* Benchmark one turn from the turn history of the game just played. */
+bool BenchTurn(size_t index, const char *name, const GameRng &rng,
+               struct TurnSummary &summary)
+{
+    std::unique_ptr<struct Players> start(new struct Players);
+
+    if (!turnHistory.stateAt(index, *start)) {
+        return false;
+    }
+
+    summary.name = name;
+    summary.year = start->Year;
+    summary.season = start->Season;
+    summary.missions = start->P[0].PastMissionCount +
+                       start->P[1].PastMissionCount;
+    summary.astronauts = start->P[0].AstroCount + start->P[1].AstroCount;
+
+    for (int c = 0; c < 2; c++) {
+        summary.caches[c].cold = (c == 0);
+
+        for (int i = 0; i < AIBENCH_PHASES; i++) {
+            PhaseSummary empty = {PHASE_NAMES[i], 0, 0, 0, 0, 0, 0};
+            summary.caches[c].phases[i] = empty;
+        }
+    }
+
+    // A run with warm caches follows each cold one, so both see the
+    // same turn the same number of times.
+    for (unsigned r = 0; r < options.bench_ai; r++) {
+        for (int c = 0; c < 2; c++) {
+            AIBenchCounts run[AIBENCH_PHASES];
+
+            *Data = *start;
+            gameRng = rng;
+            ResetAI();
+
+            if (summary.caches[c].cold) {
+                AssetRegistry::invalidateAll();
+            }
+
+            TimeRun(run);
+
+            for (int i = 0; i < AIBENCH_PHASES; i++) {
+                summary.caches[c].phases[i].add(run[i]);
+            }
+        }
+    }
+
+    return true;
+}
+};
+
+
+AIBenchScope::AIBenchScope(AIBenchPhase phase)
+    : phase(phase), active(benchRun != NULL)
+{
+    if (active) {
+        allocations = allocationCount;
+        fileOpens = fileOpenCount;
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+
+AIBenchScope::~AIBenchScope()
+{
+    if (!active || benchRun == NULL) {
+        return;
+    }
+
+    std::chrono::duration<double> took =
+        std::chrono::steady_clock::now() - start;
+    AIBenchCounts &counts = benchRun[phase];
+
+    counts.calls++;
+    counts.seconds += took.count();
+    counts.allocations += allocationCount - allocations;
+    counts.fileOpens += fileOpenCount - fileOpens;
+}
+
+
+/**
+ * Start counting what the phases of the turn take on this thread.
+ *
+ * \param run  receives the counts, which are cleared first.
+ */
+void AIBenchStart(AIBenchCounts (&run)[AIBENCH_PHASES])
+{
+    for (int i = 0; i < AIBENCH_PHASES; i++) {
+        run[i].calls = 0;
+        run[i].seconds = 0;
+        run[i].allocations = 0;
+        run[i].fileOpens = 0;
+    }
+
+    benchRun = run;
+}
+
+
+/**
+ * Stop counting on this thread.
+ */
+void AIBenchStop(void)
+{
+    benchRun = NULL;
+}
+
+
+/**
+ * Count a file opened, for the benchmark.
+ *
+ * RunAIBenchmark() installs this as the Filesystem open hook.
+ */
+void AIBenchFileOpened(void)
+{
+    fileOpenCount++;
+}
+
+
+/**
+ * Benchmark the computer player's turn and print the results.
+ *
+ * A game is played from --seed, as --simulate would, and the turn
+ * halfway through it and its last turn are each played --bench-ai
+ * times with cold caches and as many with warm caches.
+ *
+ * \return  the exit status for the program.
+ */
+int RunAIBenchmark(void)
+{
+    uint64_t seed = BaseSeed();
+
+    Filesystem::setOpenHook(AIBenchFileOpened);
+
+    if (!SetupSimulation(seed)) {
+        return EXIT_FAILURE;
+    }
+
+    MainLoop();
+
+    if (turnHistory.size() == 0) {
+        CRITICAL1("the benchmark game has no turns");
+        return EXIT_FAILURE;
+    }
+
+    const GameRng rng = gameRng;
+    std::vector<struct TurnSummary> turns(2);
+
+    if (!BenchTurn(turnHistory.size() / 2, "mid", rng, turns[0]) ||
+        !BenchTurn(turnHistory.size() - 1, "late", rng, turns[1])) {
+        CRITICAL1("can't restore the benchmark game's turns");
+        return EXIT_FAILURE;
+    }
+
+    {
+        cereal::JSONOutputArchive archive(std::cout);
+
+        archive(cereal::make_nvp("seed", (unsigned long long)seed));
+        archive(cereal::make_nvp("runs", options.bench_ai));
+        archive(cereal::make_nvp("turns", turns));
+    }
+
+    std::cout << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+
+#ifdef BENCH_ALLOCATIONS
+// Count every memory allocation made with new, for the benchmark.
+// The count is kept for each thread, so it costs next to nothing.
+void *operator new(std::size_t size)
+{
+    void *p = malloc(size ? size : 1);
+
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+
+    allocationCount++;
+    return p;
+}
+
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+#endif // BENCH_ALLOCATIONS
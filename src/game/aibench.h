@@ -0,0 +1,60 @@
+#ifndef AIBENCH_H
+#define AIBENCH_H
+
+#include <stdint.h>
+
+#include <chrono>
+
+/* The parts of the computer player's turn timed by --bench-ai. */
+enum AIBenchPhase {
+    AIBENCH_AIEvent,
+    AIBENCH_AIMaster,
+    AIBENCH_NewAI,
+    AIBENCH_AIPur,
+    AIBENCH_SelectBest,
+    AIBENCH_AILaunch,
+    AIBENCH_PHASES
+};
+
+/* What one phase took in a run of the benchmark. */
+struct AIBenchCounts {
+    uint64_t calls;
+    double seconds;
+    uint64_t allocations;   // Only counted with BENCH_ALLOCATIONS
+    uint64_t fileOpens;
+};
+
+
+/**
+ * Times one call of a phase of the computer player's turn, for the
+ * benchmark.
+ *
+ * The time, memory allocations and file opens between its
+ * construction and destruction are added to the phase, including
+ * those of any phases nested within it. Outside a benchmark, or on a
+ * thread the benchmark isn't running on, it does nothing.
+ */
+class AIBenchScope
+{
+public:
+    explicit AIBenchScope(AIBenchPhase phase);
+    ~AIBenchScope();
+
+private:
+    AIBenchPhase phase;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+    uint64_t allocations;
+    uint64_t fileOpens;
+
+    AIBenchScope(const AIBenchScope &);
+    AIBenchScope &operator=(const AIBenchScope &);
+};
+
+
+void AIBenchStart(AIBenchCounts (&run)[AIBENCH_PHASES]);
+void AIBenchStop(void);
+void AIBenchFileOpened(void);
+int RunAIBenchmark(void);
+
+#endif // AIBENCH_H
@@ -34,8 +34,8 @@
 #include "aipur.h"
 #include "pace.h"
 
-char Level_Check;
-enum Opponent_Status Cur_Status;
+GAME_LOCAL char Level_Check;
+GAME_LOCAL enum Opponent_Status Cur_Status;
 
 // Track[0] - orbital satellite
 // Track[1] - end stage location holder
@@ -73,7 +73,7 @@ void AIMaster(char plr)
     }
 
     // Randomly select the AI strategy
-    P_total = brandom(100);
+    P_total = brandom(100, RNG_AI);
 
     if (Data->P[plr].AIStrategy[AI_STRATEGY] == 0) {
         if (P_total < 33) {
@@ -804,7 +804,7 @@ void PickModule(char plr)
 void MoonVoting(char plr)
 {
     int high = -1, val;
-    val = brandom(100) + 1;
+    val = brandom(100, RNG_AI) + 1;
 
     if (val < 70) {
         high = 0;
@@ -933,7 +933,7 @@ void MoonProgram(char plr, char m)
 void ProgramVoting(char plr)
 {
     int i = 0;
-    i = brandom(100);
+    i = brandom(100, RNG_AI);
 
     if (i < 65) {
         Data->P[plr].AIPrim = 8;
@@ -944,7 +944,18 @@ void ProgramVoting(char plr)
     return;
 }
 
-/* EOF */
-
 
+/**
+ * Reset the computer players' state that isn't kept in the game data,
+ * so each new or loaded game plays the same however many games came
+ * before it.
+ */
+void ResetAI(void)
+{
+    Level_Check = 0;
+    Cur_Status = Equal;
+    ResetAIMissions();
+    ResetAIPurchases();
+}
 
+/* EOF */
@@ -28,10 +28,13 @@
 
 #include "aimis.h"
 #include "Buzz_inc.h"
+#include "aibench.h"
+#include "aiplan.h"
 #include "aipur.h"
 #include "game_main.h"
 #include "hardware.h"
 #include "mission_util.h"
+#include "options.h"
 #include "state_utils.h"
 #include "vab.h"
 #include "mc.h"
@@ -42,11 +45,11 @@
 
 LOG_DEFAULT_CATEGORY(mission)
 
-struct {
+GAME_LOCAL struct {
     int16_t cost, sf, i;
 } Mew[5];
-int whe[2], rck[2];
-char pc[2], bc[2], Alt_A[2] = {0, 0}, Alt_B[2] = {0, 0};
+GAME_LOCAL int whe[2], rck[2];
+GAME_LOCAL char pc[2], bc[2], Alt_A[2] = {0, 0}, Alt_B[2] = {0, 0};
 void Strategy_One(char plr, int *m_1, int *m_2, int *m_3);
 void Strategy_Two(char plr, int *m_1, int *m_2, int *m_3);
 void Strategy_Thr(char plr, int *m_1, int *m_2, int *m_3);
@@ -64,7 +67,7 @@ void AIVabCheck(char plr, char mis, char prog)
 {
     VASqty = 0;
     //prog=1; 0=UnM : 1=1Mn ...
-    const struct mStr plan = GetMissionPlan(mis);
+    const struct mStr &plan = GetMissionPlan(mis);
     whe[0] = whe[1] = -1;
 
     if (prog == 5) {
@@ -877,6 +880,8 @@ void Strategy_Thr(char plr, int *m_1, int *m_2, int *m_3)
 
 void NewAI(char plr, char frog)
 {
+    AIBenchScope benchScope(AIBENCH_NewAI);
+
     char i, spc[2], prg[2], primaryPad, secondaryPad, hsf, Panic_Check = 0;
     int mis1, mis2, mis3, val;
 
@@ -1113,7 +1118,11 @@ void NewAI(char plr, char frog)
             mis2 = Mission_Lunar_Probe;
         }
 
-    const struct mStr plan = GetMissionPlan(mis1);
+    if (options.ai_planner && mis1 > 0) {
+        mis1 = PlanMission(plr, mis1, frog);
+    }
+
+    const struct mStr &plan = GetMissionPlan(mis1);
 
 // deal with lunar modules
     if (plan.LM == 1) {
@@ -1354,7 +1363,7 @@ void AIFuture(char plr, char mis, char pad, char *prog)
         prog[1] = prog[0];
     }
 
-    const struct mStr plan = GetMissionPlan(mis);
+    const struct mStr &plan = GetMissionPlan(mis);
 
     for (i = 0; i < (plan.Jt + 1); i++) {
         Data->P[plr].Future[pad + i].MissionCode = mis;
@@ -1475,13 +1484,12 @@ void AIFuture(char plr, char mis, char pad, char *prog)
                 Data->P[plr].Future[pad + i].PCrew = 0;
                 Data->P[plr].Future[pad + i].BCrew = 0;
 
-                Downgrader::Options options = LoadJsonDowngrades("DOWNGRADES.JSON");
-                Downgrader replace(Data->P[plr].Future[pad + i], options);
+                Downgrader replace(Data->P[plr].Future[pad + i], *GetDowngrades());
                 char mcode = -1;
 
                 //  Find a mission that can be flown unmanned
                 try {
-                    std::vector<struct mStr> missionData = GetMissionData();
+                    const std::vector<struct mStr> &missionData = GetMissionData();
 
                     while (mcode < 0) {
 
@@ -1570,6 +1578,8 @@ void AIFuture(char plr, char mis, char pad, char *prog)
 
 void AILaunch(char plr)
 {
+    AIBenchScope benchScope(AIBENCH_AILaunch);
+
     int i, j, k = 0, l = 0, JR = 0, wgt, bwgt[7];
     char boos[7], bdex[7];
 
@@ -1812,5 +1822,20 @@ void AILaunch(char plr)
     return;
 }
 
-/* EOF */
 
+/**
+ * Forget the mission planning state carried between turns, for a new
+ * game.
+ */
+void ResetAIMissions(void)
+{
+    memset(Mew, 0x00, sizeof(Mew));
+
+    for (int i = 0; i < NUM_PLAYERS; i++) {
+        whe[i] = rck[i] = 0;
+        pc[i] = bc[i] = 0;
+        Alt_A[i] = Alt_B[i] = 0;
+    }
+}
+
+/* EOF */
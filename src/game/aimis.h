@@ -4,6 +4,7 @@
 void AIFuture(char plr, char mis, char pad, char *prog);
 void AILaunch(char plr);
 void NewAI(char plr, char frog);
+void ResetAIMissions(void);
 
 
 #endif // AIMIS_H
@@ -0,0 +1,261 @@
+// This file handles the AI's lookahead over its mission choices.
+//
+// NewAI() picks the computer player's next mission by fixed rules.
+// When the ai_planner option is set, PlanMission() weighs that pick
+// against every other mission of the same kind (single or joint). Each
+// candidate is planned and launched as NewAI() and AILaunch() would do
+// it, on a copy of the game, and then staged to work out its odds with
+// StagedMissionOdds(). The candidate expected to earn the most prestige
+// is flown.
+//
+// Candidates are spread across worker threads, each with its own copy
+// of the game in a GameContext, and no candidate is started once the
+// option's time budget has run out. The threads share the odds cache,
+// so what one call works out is there for the next.
+
+#include "aiplan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Buzz_inc.h"
+#include "aimis.h"
+#include "downgrader.h"
+#include "game_context.h"
+#include "game_main.h"
+#include "ioexception.h"
+#include "mc.h"
+#include "mission_odds.h"
+#include "mission_util.h"
+#include "options.h"
+#include "prest.h"
+
+LOG_DEFAULT_CATEGORY(mission)
+
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+/* A mission NewAI() might schedule, and what flying it is worth. */
+struct Candidate {
+    int mis;
+    char prog;
+    bool rated;   // Set once the candidate has been worked out
+    bool viable;  // The candidate could be crewed and launched
+    double value; // Expected prestige
+};
+
+/* The work shared by the planner's threads. */
+struct Planning {
+    char plr;
+    Clock::time_point deadline;
+    std::atomic<size_t> next;
+    std::vector<Candidate> candidates;
+};
+
+/* The crew program NewAI() gives a mission. */
+char CrewProgram(int mis, char frog)
+{
+    if (mis == Mission_DirectAscent_LL) {
+        return 5;
+    }
+
+    if (mis == Mission_LunarFlyby || mis == Mission_Lunar_Probe) {
+        return 0;
+    }
+
+    return frog;
+}
+
+
+/**
+ * The prestige a mission is expected to earn.
+ *
+ * A success earns what PrestCheck() says it would, and a partial
+ * success half of that. A failure costs the mission's negative
+ * prestige, down to the -7 AllotPrest() allows a failure without a
+ * death, and a crew loss the full -10.
+ */
+double MissionValue(char plr, int mis, const struct MissionOdds &odds)
+{
+    const struct mStr &plan = GetMissionPlan(mis);
+    int loss = 0;
+
+    for (int i = 0; i < 5; i++) {
+        if (plan.PCat[i] != -1) {
+            loss += Data->Prestige[plan.PCat[i]].Add[3];
+        }
+    }
+
+    double gain = PrestCheck(plr, mis);
+
+    return (odds.success + odds.partial / 2) * gain +
+           odds.failure * MAX(loss, -7) - odds.crewLoss * 10;
+}
+
+
+/**
+ * Work out a candidate on the calling thread's live game, which is
+ * left changed.
+ */
+void Rate(char plr, struct Candidate &candidate)
+{
+    const int pad = 0;
+    char prog[2] = {candidate.prog, candidate.prog};
+
+    candidate.rated = true;
+    candidate.viable = false;
+    candidate.value = -std::numeric_limits<double>::infinity();
+
+    memset(Data->P[plr].Future, 0x00, sizeof(Data->P[plr].Future));
+    memset(Data->P[plr].Mission, 0x00, sizeof(Data->P[plr].Mission));
+
+    AIFuture(plr, candidate.mis, pad, prog);
+
+    // AIFuture() falls back on an unmanned mission if it finds no crew.
+    if (Data->P[plr].Future[pad].MissionCode != candidate.mis) {
+        return;
+    }
+
+    for (int i = 0; i < MAX_MISSIONS; i++) {
+        memcpy(&Data->P[plr].Mission[i], &Data->P[plr].Future[i],
+               sizeof(struct MissionType));
+        memset(&Data->P[plr].Future[i], 0x00, sizeof(struct MissionType));
+    }
+
+    AILaunch(plr);
+
+    // AILaunch() clears the mission if no hardware will do.
+    if (Data->P[plr].Mission[pad].MissionCode != candidate.mis) {
+        return;
+    }
+
+    STEP = FINAL = PastBANG = 0;
+    memset(MH, 0x00, sizeof MH);
+    memset(Mev, 0x00, sizeof Mev);
+    MANNED[0] = Data->P[plr].Mission[pad].Men;
+    MANNED[1] = Data->P[plr].Mission[pad].Joint ?
+                Data->P[plr].Mission[pad + 1].Men : 0;
+    JOINT = Data->P[plr].Mission[pad].Joint;
+
+    StageMission(plr, pad);
+
+    candidate.viable = true;
+    candidate.value = MissionValue(plr, candidate.mis,
+                                   StagedMissionOdds(plr, pad));
+}
+
+
+/**
+ * Rate candidates on a copy of the game until none are left or the
+ * time is up.
+ */
+void RateCandidates(GameContext *game, struct Planning *planning)
+{
+    game->swap();
+
+    std::unique_ptr<struct Players> start(new struct Players(*Data));
+    size_t i;
+
+    while ((i = planning->next++) < planning->candidates.size() &&
+           (i == 0 || Clock::now() < planning->deadline)) {
+        *Data = *start;
+        Rate(planning->plr, planning->candidates[i]);
+    }
+
+    game->swap();
+}
+};
+
+
+/**
+ * Choose the computer player's next mission by its odds.
+ *
+ * \param plr  The computer player.
+ * \param mis  The mission NewAI() chose.
+ * \param frog  The crew program NewAI() is planning with.
+ * \return  the mission expected to earn the most prestige, or mis if
+ *          none was found to beat it within the time budget.
+ */
+int PlanMission(char plr, int mis, char frog)
+{
+    const std::vector<struct mStr> &missions = GetMissionData();
+    const Clock::time_point start = Clock::now();
+    struct Planning planning;
+
+    planning.plr = plr;
+    planning.deadline = start + std::chrono::milliseconds(options.ai_planner);
+    planning.next = 0;
+
+    // Load the downgrades here rather than on the worker threads.
+    try {
+        GetDowngrades();
+    } catch (IOException &err) {
+        CRITICAL2("Error loading mission downgrades: %s", err.what());
+        return mis;
+    }
+
+    // NewAI()'s choice goes first, so it is always rated.
+    struct Candidate candidate = {mis, CrewProgram(mis, frog), false, false, 0};
+    planning.candidates.push_back(candidate);
+
+    for (int i = Mission_None + 1; i < (int)missions.size(); i++) {
+        if (i != mis && missions[i].Jt == missions[mis].Jt) {
+            candidate.mis = i;
+            candidate.prog = CrewProgram(i, frog);
+            planning.candidates.push_back(candidate);
+        }
+    }
+
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, planning.candidates.size());
+
+    std::vector<std::unique_ptr<GameContext> > games;
+    std::vector<std::thread> workers;
+
+    for (size_t i = 0; i < threads; i++) {
+        games.push_back(std::unique_ptr<GameContext>(new GameContext));
+        games.back()->snapshot();
+    }
+
+    for (size_t i = 0; i < threads; i++) {
+        workers.push_back(std::thread(RateCandidates, games[i].get(),
+                                      &planning));
+    }
+
+    for (size_t i = 0; i < threads; i++) {
+        workers[i].join();
+    }
+
+    const struct Candidate *best = &planning.candidates[0];
+    int rated = 0;
+
+    for (size_t i = 0; i < planning.candidates.size(); i++) {
+        const struct Candidate &c = planning.candidates[i];
+
+        if (!c.rated) {
+            continue;
+        }
+
+        rated++;
+
+        if (c.viable && best->rated && c.value > best->value) {
+            best = &c;
+        }
+    }
+
+    DEBUG4("AI planner chose mission %d (rules chose %d) of %d rated",
+           best->mis, mis, rated);
+    DEBUG3("AI planner: expected prestige %.2f, took %d ms", best->value,
+           (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+               Clock::now() - start).count());
+
+    return best->mis;
+}
@@ -0,0 +1,6 @@
+#ifndef AIPLAN_H
+#define AIPLAN_H
+
+int PlanMission(char plr, int mis, char frog);
+
+#endif // AIPLAN_H
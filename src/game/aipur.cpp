@@ -32,6 +32,8 @@
 
 #include "aipur.h"
 #include "Buzz_inc.h"
+#include "aibench.h"
+#include "asset_registry.h"
 #include "options.h"   //Naut Randomize && Naut Compatibility, Nikakd, 10/8/10
 #include "draw.h"
 #include "hardef.h"
@@ -45,10 +47,10 @@
 #include "pace.h"
 #include "serialize.h"
 
-std::vector<struct ManPool> Men;
+GAME_LOCAL std::vector<struct ManPool> Men;
 std::vector<std::vector<int8_t>> portbuttons;//(7, std::vector<int8_t>(570));
   //std::vector<std::vector<int8_t>> portbuttons = {{1, 1, 1}, {2, 2, 2}, {3, 3, 3}, {4, 4, 4}};
-uint8_t AIsel[25];
+GAME_LOCAL uint8_t AIsel[25];
 
 
 void DrawStatistics(char Win);
@@ -121,7 +123,7 @@ void DrawStatistics(char Win)
     starty = 118;
     display::LegacySurface local(30, 19);
     
-    DESERIALIZE_JSON_FILE(&portbuttons, locate_file("portbut.json", FT_DATA));
+    portbuttons = *AssetRegistry::get<std::vector<std::vector<int8_t> > >("portbut.json");
     
     OutBox(152, 41, 183, 61); // directors ranking
 
@@ -428,11 +430,11 @@ void AIRandomizeNauts()
     int i;
 
     for (i = 0; i < Men.size(); i++) {
-        Men[i].Cap = brandom(5);
-        Men[i].LM  = brandom(5);
-        Men[i].EVA = brandom(5);
-        Men[i].Docking = brandom(5);
-        Men[i].Endurance = brandom(5);
+        Men[i].Cap = brandom(5, RNG_AI);
+        Men[i].LM  = brandom(5, RNG_AI);
+        Men[i].EVA = brandom(5, RNG_AI);
+        Men[i].Docking = brandom(5, RNG_AI);
+        Men[i].Endurance = brandom(5, RNG_AI);
     }
 }
 
@@ -459,6 +461,8 @@ void AIRandomizeNauts()
  */
 void SelectBest(char plr, int pos)
 {
+    AIBenchScope benchScope(AIBENCH_SelectBest);
+
     int count = 0, now, MaxMen = 0, Index, AIMaxSel = 0, i, j;
     FILE *fin;
     char tot, done;
@@ -479,7 +483,8 @@ void SelectBest(char plr, int pos)
     }
 
     memset(buffer, 0x00, 5000);
-    DESERIALIZE_JSON_FILE(&Men, locate_file("roster.json", FT_SAVE));
+    Men = *AssetRegistry::get<std::vector<struct ManPool>,
+          SaveAsset<std::vector<struct ManPool> > >("roster.json");
 
     if (options.feat_random_nauts == 1) {
         AIRandomizeNauts();    //Naut Randomize, Nikakd, 10/8/10
@@ -561,18 +566,18 @@ void SelectBest(char plr, int pos)
         pData->Pool[i + pData->AstroCount].oldAssign = -1;
         pData->Pool[i + pData->AstroCount].TrainingLevel = 1;
         pData->Pool[i + pData->AstroCount].Group = pData->AstroLevel;
-        pData->Pool[i + pData->AstroCount].CR = brandom(2) + 1;
-        pData->Pool[i + pData->AstroCount].CL = brandom(2) + 1;
+        pData->Pool[i + pData->AstroCount].CR = brandom(2, RNG_AI) + 1;
+        pData->Pool[i + pData->AstroCount].CL = brandom(2, RNG_AI) + 1;
         pData->Pool[i + pData->AstroCount].Task = 0;
         pData->Pool[i + pData->AstroCount].Crew = 0;
         pData->Pool[i + pData->AstroCount].Unassigned = 0;
         pData->Pool[i + pData->AstroCount].Pool = 0;
-        pData->Pool[i + pData->AstroCount].Compat = brandom(options.feat_compat_nauts) + 1;  //Naut Compatibility, Nikakd, 10/8/10
+        pData->Pool[i + pData->AstroCount].Compat = brandom(options.feat_compat_nauts, RNG_AI) + 1;  //Naut Compatibility, Nikakd, 10/8/10
         pData->Pool[i + pData->AstroCount].Mood = 100;
-        pData->Pool[i + pData->AstroCount].Face = brandom(77);
+        pData->Pool[i + pData->AstroCount].Face = brandom(77, RNG_AI);
 
         if (pData->Pool[i + pData->AstroCount].Sex == 1) {
-            pData->Pool[i + pData->AstroCount].Face = 77 + brandom(8);
+            pData->Pool[i + pData->AstroCount].Face = 77 + brandom(8, RNG_AI);
         }
     }
 
@@ -838,7 +843,7 @@ void CheckAdv(char plr)
     if (count <= 3) {
         for (int i = 0; i < pData->AstroCount; i++) {
             if (pData->Pool[i].Status == AST_ST_ACTIVE && pData->Pool[i].Assign == 0) {
-                pData->Pool[i].Focus = brandom(4) + 1;
+                pData->Pool[i].Focus = brandom(4, RNG_AI) + 1;
 
                 if (pData->Pool[i].Focus > 0) {
                     pData->Cash -= 3;
@@ -911,6 +916,8 @@ void RDafford(char plr, int equipment_class, int index)
  */
 void AIPur(char plr)
 {
+    AIBenchScope benchScope(AIBENCH_AIPur);
+
     struct BuzzData *pData = &Data->P[plr];
 
     if (pData->AIStat == 0) {
@@ -1379,4 +1386,13 @@ int GenPur(char plr, int hardware_index, int unit_index)
 }
 
 
+/**
+ * Forget the recruiting state of the last game, for a new game.
+ */
+void ResetAIPurchases(void)
+{
+    Men.clear();
+    memset(AIsel, 0x00, sizeof(AIsel));
+}
+
 /* EOF */
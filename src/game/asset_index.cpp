@@ -0,0 +1,283 @@
+// This file handles the lookup tables over the game's asset data.
+
+#include "asset_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/algorithm/string/join.hpp>
+
+#include "Buzz_inc.h"
+#include "game_main.h"
+
+
+namespace
+{
+typedef std::unordered_map<std::string, size_t> EntryMap;
+typedef std::pair<int32_t, size_t> FailKey;  // percentage, entry
+
+/* Failure entries for a single mission step. */
+struct FailTable {
+    // Every entry, ordered by percentage (then file order).
+    std::vector<FailKey> exact;
+    // The entries whose percentage exceeds that of every entry
+    // before it in the file. The first entry in the file above any
+    // given value is always one of these, and they are in rising
+    // order, so it can be found with a binary search.
+    std::vector<FailKey> rising;
+};
+
+EntryMap helpIndex;
+std::vector<std::string> helpPages;
+std::unordered_map<std::string, FailTable> failIndex;
+EntryMap sSeqIndex;       // MissionIdSequence -> sSeq entry
+EntryMap fSeqIndex;       // MissionIdSequence -> fSeq entry
+EntryMap sSeqNames;       // Hardware name -> first sSeq entry
+EntryMap fSeqNames;       // Step + hardware name -> first fSeq entry
+
+/* Codes are matched on their first four characters. */
+std::string CodeKey(const char *code)
+{
+    return std::string(code, strnlen(code, 4));
+}
+
+std::string UpperCodeKey(const char *code)
+{
+    std::string key = CodeKey(code);
+    std::transform(key.begin(), key.end(), key.begin(), ::toupper);
+    return key;
+}
+
+std::string StepNameKey(const std::string &step, const std::string &name)
+{
+    return step + '\0' + name;
+}
+
+int Lookup(const EntryMap &index, const std::string &key)
+{
+    EntryMap::const_iterator it = index.find(key);
+    return (it == index.end()) ? -1 : (int)it->second;
+}
+
+bool ByPercentage(const FailKey &a, const FailKey &b)
+{
+    return a.first < b.first;
+}
+
+void IndexSequences(const std::vector<struct MissionSequenceKey> &seqs,
+                    EntryMap &byId)
+{
+    byId.clear();
+
+    for (size_t i = 0; i < seqs.size(); i++) {
+        byId.emplace(seqs[i].MissionIdSequence, i);
+    }
+}
+};
+
+
+/**
+ * Build the lookup tables for the help, failure and sequence data.
+ *
+ * Where several entries share a key, lookups return the first in
+ * file order, the same entry a front-to-back search would find.
+ */
+void IndexAssets(const struct AssetData &assets)
+{
+    helpIndex.clear();
+    helpPages.clear();
+    helpPages.reserve(assets.help.size());
+
+    for (size_t i = 0; i < assets.help.size(); i++) {
+        helpIndex.emplace(UpperCodeKey(assets.help[i].Code.c_str()), i);
+        helpPages.push_back(
+            boost::algorithm::join(assets.help[i].description, "\r\n") + "\r\n");
+    }
+
+    failIndex.clear();
+
+    for (size_t i = 0; i < assets.fails.size(); i++) {
+        const struct XFails &fail = assets.fails[i];
+        FailTable &table = failIndex[UpperCodeKey(fail.MissionStep.c_str())];
+        FailKey key(fail.percentage, i);
+
+        table.exact.push_back(key);
+
+        if (table.rising.empty() || table.rising.back().first < key.first) {
+            table.rising.push_back(key);
+        }
+    }
+
+    for (std::unordered_map<std::string, FailTable>::iterator it =
+             failIndex.begin(); it != failIndex.end(); ++it) {
+        std::stable_sort(it->second.exact.begin(), it->second.exact.end(),
+                         ByPercentage);
+    }
+
+    IndexSequences(assets.sSeq, sSeqIndex);
+    IndexSequences(assets.fSeq, fSeqIndex);
+
+    sSeqNames.clear();
+
+    for (size_t i = 0; i < assets.sSeq.size(); i++) {
+        const std::string &id = assets.sSeq[i].MissionIdSequence;
+
+        if (id.size() >= 3) {
+            sSeqNames.emplace(id.substr(3), i);
+        }
+    }
+
+    // Failure sequences are searched only within the first run of
+    // entries for their mission step.
+    fSeqNames.clear();
+    std::unordered_map<std::string, bool> seenSteps;
+
+    for (size_t i = 0; i < assets.fSeq.size();) {
+        std::string step = CodeKey(assets.fSeq[i].MissionStep.c_str());
+        bool first = seenSteps.emplace(step, true).second;
+
+        for (; i < assets.fSeq.size() &&
+             CodeKey(assets.fSeq[i].MissionStep.c_str()) == step; i++) {
+            const std::string &id = assets.fSeq[i].MissionIdSequence;
+
+            if (first && id.size() >= 3) {
+                fSeqNames.emplace(StepNameKey(step, id.substr(3)), i);
+            }
+        }
+    }
+}
+
+
+/**
+ * Find the help entry for a help code.
+ *
+ * \param code  The help code; only the first 4 characters are
+ *              compared, without regard to case.
+ * \return  the index of the entry in Assets->help, or -1.
+ */
+int FindHelp(const char *code)
+{
+    return Lookup(helpIndex, UpperCodeKey(code));
+}
+
+
+/**
+ * The description of a help entry, as a single block of text.
+ *
+ * \param entry  An index returned by FindHelp().
+ * \return  the description lines, each terminated by "\r\n".
+ */
+const std::string &HelpText(int entry)
+{
+    return helpPages.at(entry);
+}
+
+
+/**
+ * Find the failure entry for a mission step.
+ *
+ * \param step  The failure code of the mission step.
+ * \param rnum  between -1 and -5 for unmanned steps, to be matched
+ *              exactly, or 0 to 10000 for manned steps, in which case
+ *              the first entry with a greater percentage is chosen.
+ * \return  the failure entry, or NULL if there is none.
+ */
+const struct XFails *FindFailure(const char *step, int rnum)
+{
+    std::unordered_map<std::string, FailTable>::const_iterator it =
+        failIndex.find(UpperCodeKey(step));
+
+    if (it == failIndex.end()) {
+        return NULL;
+    }
+
+    const FailTable &table = it->second;
+    FailKey key(rnum, 0);
+    std::vector<FailKey>::const_iterator entry;
+
+    if (rnum < 0) {
+        entry = std::lower_bound(table.exact.begin(), table.exact.end(),
+                                 key, ByPercentage);
+
+        if (entry == table.exact.end() || entry->first != rnum) {
+            return NULL;
+        }
+    } else {
+        entry = std::upper_bound(table.rising.begin(), table.rising.end(),
+                                 key, ByPercentage);
+
+        if (entry == table.rising.end()) {
+            return NULL;
+        }
+    }
+
+    return &Assets->fails.at(entry->second);
+}
+
+
+/**
+ * Find a mission sequence by its full ID.
+ *
+ * \param failure  true to search Assets->fSeq, false for Assets->sSeq.
+ * \param id  The MissionIdSequence of the entry.
+ * \return  the index of the entry, or -1.
+ */
+int FindSequence(bool failure, const std::string &id)
+{
+    return Lookup(failure ? fSeqIndex : sSeqIndex, id);
+}
+
+
+/**
+ * Find the success sequence matching a mission step.
+ *
+ * A sequence matches if its hardware name is a prefix of seq.
+ *
+ * \param seq  The step's sequence string.
+ * \return  the index of the first matching entry in Assets->sSeq, or -1.
+ */
+int FindSuccessSequence(const char *seq)
+{
+    std::string key(seq);
+    int best = -1;
+
+    for (size_t len = 0; len <= key.size(); len++) {
+        int entry = Lookup(sSeqNames, key.substr(0, len));
+
+        if (entry >= 0 && (best < 0 || entry < best)) {
+            best = entry;
+        }
+    }
+
+    return best;
+}
+
+
+/**
+ * Find the failure sequence matching a mission step.
+ *
+ * \param step  The failure code of the mission step.
+ * \param seq  The step's sequence string.
+ * \return  the index of the first matching entry in Assets->fSeq, or -1.
+ * \see FindSuccessSequence
+ */
+int FindFailureSequence(const char *step, const char *seq)
+{
+    std::string stepKey = CodeKey(step);
+    std::string key(seq);
+    int best = -1;
+
+    for (size_t len = 0; len <= key.size(); len++) {
+        int entry = Lookup(fSeqNames, StepNameKey(stepKey, key.substr(0, len)));
+
+        if (entry >= 0 && (best < 0 || entry < best)) {
+            best = entry;
+        }
+    }
+
+    return best;
+}
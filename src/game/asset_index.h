@@ -0,0 +1,25 @@
+#ifndef ASSET_INDEX_H
+#define ASSET_INDEX_H
+
+#include <string>
+
+struct AssetData;
+struct Help;
+struct XFails;
+
+/**
+ * Lookup tables over the contents of Assets.
+ *
+ * The tables refer to Assets by position, so they must be rebuilt
+ * with IndexAssets() whenever Assets is reloaded.
+ */
+void IndexAssets(const struct AssetData &assets);
+
+int FindHelp(const char *code);
+const std::string &HelpText(int entry);
+const struct XFails *FindFailure(const char *step, int rnum);
+int FindSequence(bool failure, const std::string &id);
+int FindSuccessSequence(const char *seq);
+int FindFailureSequence(const char *step, const char *seq);
+
+#endif // ASSET_INDEX_H
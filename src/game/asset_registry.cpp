@@ -0,0 +1,98 @@
+// This file handles the shared store of game data assets.
+
+#include "asset_registry.h"
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include "logging.h"
+
+
+LOG_DEFAULT_CATEGORY(filesys);
+
+
+namespace
+{
+// Assets are keyed by file name and type, since a file can be read
+// into more than one representation.
+typedef std::pair<std::string, std::string> AssetKey;
+typedef std::map<AssetKey, boost::shared_ptr<const void> > AssetMap;
+
+AssetMap &LoadedAssets()
+{
+    static AssetMap assets;
+    return assets;
+}
+
+// Guards LoadedAssets(); assets are loaded outside it
+std::mutex &AssetsLock()
+{
+    static std::mutex lock;
+    return lock;
+}
+};
+
+
+boost::shared_ptr<const void> AssetRegistry::find(const std::string &name,
+        const std::type_info &type)
+{
+    std::lock_guard<std::mutex> guard(AssetsLock());
+    AssetMap::const_iterator it = LoadedAssets().find(AssetKey(name, type.name()));
+
+    if (it == LoadedAssets().end()) {
+        return boost::shared_ptr<const void>();
+    }
+
+    return it->second;
+}
+
+
+/**
+ * Store a loaded asset, unless another thread stored it first.
+ *
+ * \return  the stored asset.
+ */
+boost::shared_ptr<const void> AssetRegistry::insert(const std::string &name,
+        const std::type_info &type, boost::shared_ptr<const void> asset)
+{
+    std::lock_guard<std::mutex> guard(AssetsLock());
+    std::pair<AssetMap::iterator, bool> stored =
+        LoadedAssets().insert(std::make_pair(AssetKey(name, type.name()), asset));
+
+    if (stored.second) {
+        DEBUG2("loaded asset `%s'", name.c_str());
+    }
+
+    return stored.first->second;
+}
+
+
+/**
+ * Drop every loaded asset read from the given file.
+ *
+ * \param name  The name of the file backing the asset(s).
+ */
+void AssetRegistry::invalidate(const std::string &name)
+{
+    std::lock_guard<std::mutex> guard(AssetsLock());
+    AssetMap &assets = LoadedAssets();
+
+    for (AssetMap::iterator it = assets.begin(); it != assets.end();) {
+        if (it->first.first == name) {
+            assets.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+}
+
+
+/**
+ * Drop all loaded assets.
+ */
+void AssetRegistry::invalidateAll()
+{
+    std::lock_guard<std::mutex> guard(AssetsLock());
+    LoadedAssets().clear();
+}
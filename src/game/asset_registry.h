@@ -0,0 +1,107 @@
+#ifndef ASSET_REGISTRY_H
+#define ASSET_REGISTRY_H
+
+#include <fstream>
+#include <string>
+#include <typeinfo>
+
+#include <boost/shared_ptr.hpp>
+
+#include "fs.h"
+#include "ioexception.h"
+#include "json_cache.h"
+
+
+/**
+ * Loads an asset from a JSON file in the game data directory,
+ * through the binary cache.
+ */
+template<class T, class Layout = JsonCache::Value<T> >
+struct DataAsset {
+    static void load(T &x, const std::string &name)
+    {
+        DeserializeCachedJSON<T, Layout>(&x, name.c_str());
+    }
+};
+
+/**
+ * Loads an asset from a JSON file in the save directory.
+ *
+ * Files in the save directory are written by the game itself,
+ * so they are parsed directly rather than cached.
+ */
+template<class T, class Layout = JsonCache::Value<T> >
+struct SaveAsset {
+    static void load(T &x, const std::string &name)
+    {
+        std::ifstream is(locate_file(name.c_str(), FT_SAVE));
+
+        if (!is) {
+            throw IOException("Could not open " + name);
+        }
+
+        cereal::JSONInputArchive iarchive(is);
+        Layout::read(iarchive, x);
+    }
+};
+
+
+/**
+ * Parse-once store for game data read from files.
+ *
+ * Assets are loaded on first use and then shared, as immutable
+ * instances, by every caller asking for the same file and type.
+ * Callers that need to modify the data must copy it.
+ *
+ * A loaded asset stays in memory until it is invalidated. Code that
+ * rewrites a file backing an asset (such as roster.json) must call
+ * invalidate() so the next caller sees the new contents. Instances
+ * already handed out remain valid.
+ *
+ * The registry may be used from several threads. If two load the same
+ * asset at once, both read the file but they share the first copy
+ * stored.
+ *
+ * Usage:
+ *   boost::shared_ptr<const std::vector<int> > table =
+ *       AssetRegistry::get<std::vector<int> >("ntable.json");
+ */
+class AssetRegistry
+{
+public:
+    template<class T, class Loader = DataAsset<T> >
+    static boost::shared_ptr<const T> get(const std::string &name);
+
+    static void invalidate(const std::string &name);
+    static void invalidateAll();
+
+private:
+    static boost::shared_ptr<const void> find(const std::string &name,
+            const std::type_info &type);
+    static boost::shared_ptr<const void> insert(const std::string &name,
+            const std::type_info &type, boost::shared_ptr<const void> asset);
+};
+
+
+/**
+ * Fetch an asset, loading it if it isn't in memory.
+ *
+ * \param name  The name of the file holding the asset.
+ * \return  A shared, read-only instance of the asset.
+ * \throws IOException  if the file cannot be read.
+ */
+template<class T, class Loader>
+boost::shared_ptr<const T> AssetRegistry::get(const std::string &name)
+{
+    boost::shared_ptr<const void> cached = find(name, typeid(T));
+
+    if (cached) {
+        return boost::static_pointer_cast<const T>(cached);
+    }
+
+    boost::shared_ptr<T> asset(new T());
+    Loader::load(*asset, name);
+    return boost::static_pointer_cast<const T>(insert(name, typeid(T), asset));
+}
+
+#endif // ASSET_REGISTRY_H
@@ -46,6 +46,7 @@
 #include "display/graphics.h"
 
 #include "Buzz_inc.h"
+#include "asset_registry.h"
 #include "options.h"   //Naut Randomize && Naut Compatibility, Nikakd, 10/8/10
 #include "draw.h"
 #include "game_main.h"
@@ -713,7 +714,8 @@ void AstSel(char plr)
     memset(sel, -1, sizeof(sel));
     memset(MCol, 0x00, sizeof(MCol));
 
-    DESERIALIZE_JSON_FILE(&Men, locate_file("roster.json", FT_SAVE));
+    Men = *AssetRegistry::get<std::vector<struct ManPool>,
+          SaveAsset<std::vector<struct ManPool> > >("roster.json");
 
     if (options.feat_random_nauts == 1) {
         RandomizeNauts();    //Naut Randomize, Nikakd, 10/8/10
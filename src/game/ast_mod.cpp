@@ -9,6 +9,7 @@
 
 #include "display/graphics.h"
 
+#include "asset_registry.h"
 #include "data.h"
 #include "draw.h"
 #include "fs.h"
@@ -112,17 +113,18 @@ void AstronautModification()
                 bool useOriginal = Help("I105") > 0;
 
                 if (useOriginal) {
-                    DESERIALIZE_JSON_FILE(&all, locate_file("crew.json", FT_DATA));
+                    all = *AssetRegistry::get<std::vector<struct ManPool> >("crew.json");
                 }
                 else {
-                    DESERIALIZE_JSON_FILE(&all, locate_file("user.json", FT_SAVE));
+                    all = *AssetRegistry::get<std::vector<struct ManPool>,
+                          SaveAsset<std::vector<struct ManPool> > >("user.json");
                 }
 
             } else {
             // Should this be CNOTICE2?
                 CINFO2(filesys,
                        "user.json not found. Loading crew.json rosters...");
-                DESERIALIZE_JSON_FILE(&all, locate_file("crew.json", FT_DATA));
+                all = *AssetRegistry::get<std::vector<struct ManPool> >("crew.json");
             }
 
             for (int i = 0; i < all.size() / 2; i++) {
@@ -940,6 +942,7 @@ void ExportRoster(const std::vector<struct ManPool> &usaRoster,
     fwrite(str.data(), sizeof(char), str.size(), file);
 
     fclose(file);
+    AssetRegistry::invalidate("user.json");
 }
 
 
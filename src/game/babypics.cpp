@@ -0,0 +1,135 @@
+// This file handles the mission step thumbnails in BABYPICX.CDR.
+
+#include "babypics.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "display/graphics.h"
+#include "display/legacy_surface.h"
+
+#include "fs.h"
+#include "logging.h"
+
+
+LOG_DEFAULT_CATEGORY(multimedia)
+
+
+namespace
+{
+// Each record is a palette followed by the pixels, two to a byte.
+const int RECORD_SIZE = 48 + BABY_WIDTH * BABY_HEIGHT / 2;
+
+std::vector<char> babyData;           // The contents of BABYPICX.CDR
+std::vector<struct BabyPic> babyPics;
+std::vector<bool> babyDecoded;
+
+bool LoadBabyData();
+};
+
+
+/**
+ * Get a mission thumbnail, decoding it on first use.
+ *
+ * BABYPICX.CDR is read into memory the first time any thumbnail is
+ * requested, so later calls don't touch the disk.
+ *
+ * \param index  the image's record number in BABYPICX.CDR.
+ * \return  the image, or NULL if there is no such image.
+ */
+const struct BabyPic *GetBabyPic(int index)
+{
+    if (!LoadBabyData() || index < 0 || index >= (int)babyPics.size()) {
+        ERROR2("Cannot read mission thumbnail %d", index);
+        return NULL;
+    }
+
+    struct BabyPic &pic = babyPics[index];
+
+    if (!babyDecoded[index]) {
+        const char *src = &babyData[index * RECORD_SIZE];
+        const int half = BABY_WIDTH * BABY_HEIGHT / 2;
+
+        memcpy(pic.palette, src, sizeof pic.palette);
+        src += sizeof pic.palette;
+
+        // The low nibbles hold the top half of the image, the high
+        // nibbles the bottom half.
+        for (int i = 0; i < half; i++) {
+            pic.pixels[i] = src[i] & 0x0F;
+            pic.pixels[half + i] = (src[i] >> 4) & 0x0F;
+        }
+
+        babyDecoded[index] = true;
+    }
+
+    return &pic;
+}
+
+
+/**
+ * Draw a mission thumbnail to the screen.
+ *
+ * The palette is not changed; the caller is responsible for placing
+ * the image's colors at colorOffset.
+ *
+ * \param pic  the image.
+ * \param x  the top-left x coordinate.
+ * \param y  the top-left y coordinate.
+ * \param colorOffset  the screen palette index of the image's color 0.
+ */
+void DrawBabyPic(const struct BabyPic &pic, int x, int y, int colorOffset)
+{
+    display::LegacySurface surface(BABY_WIDTH, BABY_HEIGHT);
+    char *pixels = surface.pixels();
+
+    for (int i = 0; i < BABY_WIDTH * BABY_HEIGHT; i++) {
+        pixels[i] = pic.pixels[i] + colorOffset;
+    }
+
+    surface.copyTo(display::graphics.legacyScreen(), x, y);
+}
+
+
+namespace
+{
+
+/**
+ * Read BABYPICX.CDR into memory, if it hasn't been already.
+ *
+ * \return  true if the thumbnails are available.
+ */
+bool LoadBabyData()
+{
+    if (!babyData.empty()) {
+        return true;
+    }
+
+    FILE *fin = sOpen("BABYPICX.CDR", "rb", FT_DATA);
+
+    if (!fin) {
+        return false;
+    }
+
+    fseek(fin, 0, SEEK_END);
+    long length = ftell(fin);
+    rewind(fin);
+
+    int count = (length > 0) ? length / RECORD_SIZE : 0;
+    std::vector<char> data(count * RECORD_SIZE);
+    bool read = count > 0 && fread(&data[0], data.size(), 1, fin) == 1;
+    fclose(fin);
+
+    if (!read) {
+        return false;
+    }
+
+    babyData.swap(data);
+    babyPics.resize(count);
+    babyDecoded.assign(count, false);
+    DEBUG2("loaded %d mission thumbnails", count);
+    return true;
+}
+
+};
@@ -0,0 +1,23 @@
+#ifndef BABYPICS_H
+#define BABYPICS_H
+
+#include <stdint.h>
+
+#define BABY_WIDTH 68
+#define BABY_HEIGHT 46
+
+/**
+ * A mission step thumbnail from BABYPICX.CDR.
+ *
+ * Each image uses a 16-color palette, which callers place at some
+ * offset in the screen palette.
+ */
+struct BabyPic {
+    char palette[48];                          /**< 16 RGB triples */
+    uint8_t pixels[BABY_WIDTH * BABY_HEIGHT];  /**< Colors 0-15 */
+};
+
+const struct BabyPic *GetBabyPic(int index);
+void DrawBabyPic(const struct BabyPic &pic, int x, int y, int colorOffset);
+
+#endif // BABYPICS_H
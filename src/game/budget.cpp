@@ -491,7 +491,7 @@ void DrawPreviousMissions(char plr)
 
     while (i > (Data->P[plr].PastMissionCount - olderMiss - 3) && i >= 0) {
 
-        const struct mStr mission =
+        const struct mStr &mission =
             GetMissionPlan(Data->P[plr].History[i].MissionCode);
 
         draw_string(9, 49 + 16 * misnum,
@@ -0,0 +1,112 @@
+// This file handles byte-wise difference encoding of game state.
+
+#include "byte_delta.h"
+
+
+namespace
+{
+/* A run of fewer equal bytes than this is kept inside a literal. */
+const size_t MIN_SKIP = 4;
+
+void PutCount(std::vector<uint8_t> &out, size_t n)
+{
+    while (n >= 0x80) {
+        out.push_back((uint8_t)(n | 0x80));
+        n >>= 7;
+    }
+
+    out.push_back((uint8_t)n);
+}
+
+bool GetCount(const std::vector<uint8_t> &in, size_t &pos, size_t &n)
+{
+    n = 0;
+
+    for (int shift = 0; pos < in.size() && shift < 32; shift += 7) {
+        uint8_t byte = in[pos++];
+        n |= (size_t)(byte & 0x7F) << shift;
+
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+};
+
+
+/**
+ * Encode the difference between two states.
+ *
+ * The result is a series of (skip, length, bytes) records: skip
+ * unchanged bytes, then XOR the next length bytes with those given.
+ */
+std::vector<uint8_t> EncodeDelta(const uint8_t *a, const uint8_t *b,
+                                 size_t size)
+{
+    std::vector<uint8_t> out;
+    size_t i = 0;
+
+    while (i < size) {
+        size_t start = i;
+
+        while (i < size && a[i] == b[i]) {
+            i++;
+        }
+
+        if (i == size) {
+            break;
+        }
+
+        size_t skip = i - start;
+        size_t litStart = i;
+        size_t same = 0;
+
+        // Extend the literal until a run of MIN_SKIP equal bytes.
+        for (; i < size && same < MIN_SKIP; i++) {
+            same = (a[i] == b[i]) ? same + 1 : 0;
+        }
+
+        size_t litEnd = i - same;
+
+        PutCount(out, skip);
+        PutCount(out, litEnd - litStart);
+
+        for (size_t j = litStart; j < litEnd; j++) {
+            out.push_back(a[j] ^ b[j]);
+        }
+
+        i = litEnd;
+    }
+
+    return out;
+}
+
+/**
+ * Apply an encoded difference to a state, in place.
+ *
+ * \return  false if the delta is malformed.
+ */
+bool ApplyDelta(const std::vector<uint8_t> &delta, uint8_t *state,
+                size_t size)
+{
+    size_t pos = 0, at = 0;
+
+    while (pos < delta.size()) {
+        size_t skip, length;
+
+        if (!GetCount(delta, pos, skip) || !GetCount(delta, pos, length) ||
+            at + skip + length > size || pos + length > delta.size()) {
+            return false;
+        }
+
+        at += skip;
+
+        for (size_t j = 0; j < length; j++) {
+            state[at++] ^= delta[pos++];
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,21 @@
+#ifndef BYTE_DELTA_H
+#define BYTE_DELTA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+/**
+ * Encoding of the difference between two equally sized byte buffers.
+ *
+ * Differences are XORed byte by byte and run length encoded, so the
+ * same delta turns either buffer into the other, and buffers that
+ * are mostly the same give small deltas.
+ */
+std::vector<uint8_t> EncodeDelta(const uint8_t *a, const uint8_t *b,
+                                 size_t size);
+bool ApplyDelta(const std::vector<uint8_t> &delta, uint8_t *state,
+                size_t size);
+
+#endif // BYTE_DELTA_H
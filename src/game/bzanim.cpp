@@ -19,29 +19,80 @@
 #include "bzanim.h"
 
 #include <cassert>
+#include <cstring>
+#include <list>
 #include <stdexcept>
+#include <string>
+#include <unordered_map>
 
 #include "display/graphics.h"
 #include "display/palette.h"
 
 #include "data.h"
-#include "endianness.h"
 #include "fs.h"
 #include "ioexception.h"
 #include "logging.h"
+#include "macros.h"
 #include "pace.h"
 
 
 LOG_DEFAULT_CATEGORY(video)
 
 
+/**
+ * An animation as stored in an animation file.
+ *
+ * Frames are decoded from the file data on demand, and kept for
+ * reuse on later loops and by other instances of the animation.
+ */
+struct BZAnimation::Sequence {
+    struct AnimType header;
+    display::Palette palette;
+    // The file data holding the compressed frames.
+    boost::shared_ptr<const std::vector<uint8_t> > data;
+    std::vector<size_t> frameOffsets;
+    std::vector<std::vector<uint8_t> > frames;
+
+    const uint8_t *frame(int index);
+};
+
+
 namespace
 {
-size_t ImportAnimType(FILE *fin, struct AnimType &target);
-size_t ImportBlockHead(FILE *fin, struct BlockHead &target);
-uint8_t *ReadFrame(FILE *fin, int width, int height);
-display::Palette ReadPalette(FILE *fin, int offset, int colors);
-void SeekAnimation(FILE *fin, const char *name);
+// Sizes of the structures as stored in an .abz file
+const size_t INDEX_ENTRY_SIZE = 12;   // ID[4], offset, size
+const size_t ANIM_TYPE_SIZE = 30;     // See ImportAnimType()
+const size_t BLOCK_HEAD_SIZE = 5;     // cType, fSize
+
+// Number of animation files kept in memory
+const size_t FILE_CACHE_SIZE = 4;
+
+struct IndexEntry {
+    uint32_t offset;
+    uint32_t size;
+};
+
+/* The contents of an .abz file, with its index. */
+struct AnimationFile {
+    std::string name;
+    boost::shared_ptr<const std::vector<uint8_t> > data;
+    std::unordered_map<std::string, IndexEntry> index;
+    std::unordered_map<std::string,
+        boost::shared_ptr<BZAnimation::Sequence> > sequences;
+};
+
+typedef std::list<boost::shared_ptr<AnimationFile> > FileCache;
+
+// Most recently used first
+FileCache fileCache;
+
+boost::shared_ptr<AnimationFile> GetAnimationFile(const char *file);
+boost::shared_ptr<BZAnimation::Sequence> ReadSequence(
+    const AnimationFile &file, const IndexEntry &entry);
+size_t ImportAnimType(const uint8_t *src, struct AnimType &target);
+size_t ImportBlockHead(const uint8_t *src, struct BlockHead &target);
+uint16_t ReadLE16(const uint8_t *src);
+uint32_t ReadLE32(const uint8_t *src);
 };
 
 
@@ -55,7 +106,8 @@ void SeekAnimation(FILE *fin, const char *name);
  * \param id    the animation ID.
  * \param x  the top-left x coordinate of the animation window.
  * \param y  the top-left y coordinate of the animation window.
- * \throw IOException  if an error occurs while reading the file.
+ * \throw IOException  if an error occurs while reading the file,
+ *                     or the file has no such animation.
  */
 BZAnimation::Ptr BZAnimation::load(
     const char *file, const char *id, int x, int y)
@@ -68,56 +120,53 @@ BZAnimation::Ptr BZAnimation::load(
         throw std::invalid_argument("Parameter id may not be null.");
     }
 
-    FILE *fin = open_gamedat(file);
+    boost::shared_ptr<AnimationFile> animFile = GetAnimationFile(file);
+    std::string key(id, strnlen(id, 4));
+    boost::shared_ptr<Sequence> &sequence = animFile->sequences[key];
 
-    if (!fin) {
-        std::string msg("Cannot open file ");
-        msg += file;
-        throw IOException(msg);
-    }
-
-    struct AnimType header;
-
-    std::vector<uint8_t *> frames;
-
-    SeekAnimation(fin, id);
-
-    ImportAnimType(fin, header);
+    if (!sequence) {
+        std::unordered_map<std::string, IndexEntry>::const_iterator it =
+            animFile->index.find(key);
 
-    display::Palette palette =
-        ReadPalette(fin, header.cOff, header.cNum);
+        if (it == animFile->index.end()) {
+            animFile->sequences.erase(key);
+            throw IOException("Animation " + key + " not found in " + file);
+        }
 
-    for (int i = 0; i < header.fNum; i++) {
-        uint8_t *pixels = ReadFrame(fin, header.w, header.h);
-        frames.push_back(pixels);
+        sequence = ReadSequence(*animFile, it->second);
     }
 
-    BZAnimation::Ptr animation(
-        new BZAnimation(header, palette, frames, x, y));
+    BZAnimation::Ptr animation(new BZAnimation(sequence, x, y));
 
     return animation;
 }
 
 
+/**
+ * Release the cached animation files.
+ *
+ * Animations already loaded keep the data they use.
+ */
+void BZAnimation::clearCache()
+{
+    fileCache.clear();
+}
+
+
 /**
  * Initializes the animation to the first frame.
  *
  * The constructor exports the animation's palette to the global
- * color space. This instance takes ownership of and responsibility
- * for the memory holding the frame pixel data.
+ * color space.
  *
- * \param header
- * \param palette
- * \param frames   the raw pixel data (as palette indexes).
+ * \param sequence  the animation data.
  * \param x  the top-left x coordinate of the animation window.
  * \param y  the top-left y coordinate of the animation window.
  */
-BZAnimation::BZAnimation(struct AnimType header,
-                         display::Palette palette,
-                         std::vector<uint8_t *> frames,
+BZAnimation::BZAnimation(boost::shared_ptr<Sequence> sequence,
                          int x,
                          int y)
-    : mDisplay(NULL), mHeader(header), mFrameData(frames)
+    : mDisplay(NULL), mSequence(sequence)
 {
     if (x < 0 || x >= display::Graphics::WIDTH) {
         WARNING2("Animation param x=%d out of range.", x);
@@ -130,12 +179,14 @@ BZAnimation::BZAnimation(struct AnimType header,
     mX = x;
     mY = y;
 
-    mDisplay = new display::LegacySurface(mHeader.w, mHeader.h);
+    const struct AnimType &header = mSequence->header;
+
+    mDisplay = new display::LegacySurface(header.w, header.h);
     mDisplay->palette().copy_from(
         display::graphics.legacyScreen()->palette());
 
     mDisplay->palette().copy_from(
-        palette, mHeader.cOff, mHeader.cOff + mHeader.cNum - 1);
+        mSequence->palette, header.cOff, header.cOff + header.cNum - 1);
     display::graphics.legacyScreen()->palette().copy_from(
         mDisplay->palette());
 
@@ -144,17 +195,13 @@ BZAnimation::BZAnimation(struct AnimType header,
 
 
 /**
- * Clean up outstanding memory demands, particularly the pixel data.
+ * Clean up outstanding memory demands.
  */
 BZAnimation::~BZAnimation()
 {
     if (mDisplay) {
         delete mDisplay;
     }
-
-    for (int i = 0; i < mFrameData.size(); i++) {
-        delete[] mFrameData[i];
-    }
 }
 
 
@@ -167,12 +214,14 @@ BZAnimation::~BZAnimation()
  */
 void BZAnimation::advance()
 {
-    if (mCurrentFrame == mHeader.fNum) {
+    const int frameCount = mSequence->frameOffsets.size();
+
+    if (mCurrentFrame == frameCount) {
         mCurrentFrame = 0;
     }
 
-    if (mCurrentFrame < mHeader.fNum) {
-        uint8_t *pixels = mFrameData[mCurrentFrame];
+    if (mCurrentFrame < frameCount) {
+        const uint8_t *pixels = mSequence->frame(mCurrentFrame);
         memcpy(mDisplay->pixels(), pixels, mDisplay->width() * mDisplay->height());
 
         // dply->palette().copy_from(display::graphics.legacyScreen()->palette());
@@ -182,171 +231,252 @@ void BZAnimation::advance()
 }
 
 
-//----------------------------------------------------------------------
-
-namespace
-{
-
 /**
- * Read an AnimType struct stored in a file as raw data.
+ * Get the decoded pixel data for a frame, decoding it if needed.
  *
- * \param fin  Pointer to a FILE object that specifies an input stream.
- * \param target  The destination for the read data.
- * \return  1 if successful, 0 otherwise.
+ * The pixel data is an array of length (width * height), containing
+ * codes corresponding to a 256-color palette.
+ *
+ * \param index  the frame number.
+ * \return  uncompressed pixel data.
  */
-size_t ImportAnimType(FILE *fin, struct AnimType &target)
+const uint8_t *BZAnimation::Sequence::frame(int index)
 {
-    bool success =
-        fread(&target.ID[0], sizeof(target.ID), 1, fin) &&
-        fread(&target.OVL[0], sizeof(target.OVL), 1, fin) &&
-        fread(&target.SD[0][0], sizeof(target.SD), 1, fin) &&
-        fread(&target.w, sizeof(target.w), 1, fin) &&
-        fread(&target.h, sizeof(target.h), 1, fin) &&
-        fread(&target.sPlay[0], sizeof(target.sPlay), 1, fin) &&
-        fread(&target.fNum, sizeof(target.fNum), 1, fin) &&
-        fread(&target.fLoop, sizeof(target.fLoop), 1, fin) &&
-        fread(&target.cOff, sizeof(target.cOff), 1, fin) &&
-        fread(&target.cNum, sizeof(target.cNum), 1, fin);
-
-    Swap16bit(target.w);
-    Swap16bit(target.h);
-    return (success ? 1 : 0);
-}
+    std::vector<uint8_t> &pixels = frames.at(index);
 
+    if (!pixels.empty()) {
+        return &pixels[0];
+    }
 
-/**
- * Read a BlockHead struct stored in a file as raw data.
- *
- * A BlockHead is a header in an animation file, at the beginning of
- * an animation frame. It contains a value for identifying the
- * compression, and the size (in bytes) of the animation pixel data
- * that follows.
- *
- * \param fin  Pointer to a FILE object that specifies an input stream.
- * \param target  The destination for the read data
- * \return  1 if successful, 0 otherwise
- */
-size_t ImportBlockHead(FILE *fin, struct BlockHead &target)
-{
-    int32_t position = ftell(fin);
-    bool success =
-        fread(&target.cType, sizeof(target.cType), 1, fin) &&
-        fread(&target.fSize, sizeof(target.fSize), 1, fin);
+    const int width = header.w, height = header.h;
+    const uint8_t *src = &data->at(frameOffsets[index]);
+    struct BlockHead block;
+    ImportBlockHead(src, block);
+    src += BLOCK_HEAD_SIZE;
+
+    pixels.resize(width * height);
+
+    // TODO: Create an enum for the different compression codes.
+    // TODO: What makes codes 1 & 2 different?  - rnyoakum
+    switch (block.cType) {
+    case 0:
+        memcpy(&pixels[0], src, MIN((size_t)block.fSize, pixels.size()));
+        break;
+
+    case 1:
+    case 2:
+        RLED_img((const char *)src, (char *)&pixels[0], block.fSize,
+                 width, height);
+        break;
 
-    Swap32bit(target.fSize);
-    return (success ? 1 : 0);
+    default:
+        break;
+    }
+
+    pixels[width * height - 1] = pixels[width * height - 2];
+
+    return &pixels[0];
 }
 
 
+//----------------------------------------------------------------------
+
+namespace
+{
+
 /**
- * Reads and decodes the raw pixel data for a frame.
+ * Get an animation file, reading and indexing it if it isn't cached.
  *
- * The returned pixel data is an array of length (width * height),
- * containing codes corresponding ti a 256-color palette. The relevant
- * color space of that palette is found following the Animation Header.
+ * The index at the start of the file has no length field, so it is
+ * read until it runs into the first animation or an entry that
+ * cannot be valid.
  *
- * \param fin     File positioned at the start of the frame.
- * \param width   The frame width (in pixels).
- * \param height  The frame height (in pixels).
- * \return  uncompressed pixel data.
+ * \param file  the animation file name.
+ * \return  the cached file.
+ * \throw IOException  if the file cannot be read.
  */
-uint8_t *ReadFrame(FILE *fin, int width, int height)
+boost::shared_ptr<AnimationFile> GetAnimationFile(const char *file)
 {
-    assert(fin);
+    for (FileCache::iterator it = fileCache.begin();
+         it != fileCache.end(); ++it) {
+        if ((*it)->name == file) {
+            fileCache.splice(fileCache.begin(), fileCache, it);
+            return fileCache.front();
+        }
+    }
 
-    struct BlockHead header;
-    ImportBlockHead(fin, header);
+    FILE *fin = open_gamedat(file);
 
-    assert(header.fSize < 128 * 1024);
-    uint8_t *buf = (uint8_t *)alloca(header.fSize);
-    fread(buf, header.fSize, 1, fin);
+    if (!fin) {
+        std::string msg("Cannot open file ");
+        msg += file;
+        throw IOException(msg);
+    }
 
-    uint8_t *frame = new uint8_t[width * height];
+    fseek(fin, 0, SEEK_END);
+    long length = ftell(fin);
+    rewind(fin);
 
-    // TODO: Create an enum for the different compression codes.
-    // TODO: What makes codes 1 & 2 different?  - rnyoakum
-    switch (header.cType) {
-    case 0:
-        memcpy(frame, buf, header.fSize);
-        break;
+    boost::shared_ptr<std::vector<uint8_t> > data(
+        new std::vector<uint8_t>(MAX(length, 0L)));
+    bool ok = length > 0 &&
+              fread(&(*data)[0], length, 1, fin) == 1;
+    fclose(fin);
 
-    case 1:
-        RLED_img((char *)buf, (char *)frame, header.fSize, width, height);
-        break;
+    if (!ok) {
+        throw IOException(std::string("Could not read ") + file);
+    }
 
-    case 2:
-        RLED_img((char *)buf, (char *)frame, header.fSize, width, height);
-        break;
+    boost::shared_ptr<AnimationFile> animFile(new AnimationFile);
+    animFile->name = file;
+    animFile->data = data;
 
-    default:
-        break;
+    size_t indexEnd = data->size();
+
+    for (size_t pos = 0; pos + INDEX_ENTRY_SIZE <= indexEnd;
+         pos += INDEX_ENTRY_SIZE) {
+        const uint8_t *src = &(*data)[pos];
+        IndexEntry entry = { ReadLE32(src + 4), ReadLE32(src + 8) };
+
+        if ((src[0] | src[1] | src[2] | src[3]) & 0x80 ||
+            entry.offset < pos + INDEX_ENTRY_SIZE ||
+            entry.offset + ANIM_TYPE_SIZE > data->size()) {
+            break;
+        }
+
+        std::string id((const char *)src, strnlen((const char *)src, 4));
+        animFile->index.insert(std::make_pair(id, entry));
+        indexEnd = MIN(indexEnd, (size_t)entry.offset);
     }
 
-    frame[width * height - 1] = frame[width * height - 2];
+    DEBUG3("indexed %d animations in `%s'", (int)animFile->index.size(), file);
+
+    fileCache.push_front(animFile);
+
+    if (fileCache.size() > FILE_CACHE_SIZE) {
+        fileCache.pop_back();
+    }
 
-    return frame;
+    return animFile;
 }
 
 
 /**
- * Reads the raw palette data from a file.
+ * Read an animation's header and palette, and locate its frames.
  *
- * \param fin  File positioned at the start of the animation palette data.
- * \param offset  The start of the color space.
- * \param colors  The number of colors in the color space.
- * \return  a palette with colors defined for [offset, offset + colors).
- * \throws  IOException  if palette data could not be read.
+ * \param file   the animation file.
+ * \param entry  the index entry for the animation.
+ * \return  the animation, with no frames decoded.
+ * \throw IOException  if the animation extends past the end of file.
  */
-display::Palette ReadPalette(FILE *fin, int offset, int colors)
+boost::shared_ptr<BZAnimation::Sequence> ReadSequence(
+    const AnimationFile &file, const IndexEntry &entry)
 {
-    assert(fin);
-    display::Palette palette;
+    const std::vector<uint8_t> &data = *file.data;
+    boost::shared_ptr<BZAnimation::Sequence> sequence(
+        new BZAnimation::Sequence);
+    struct AnimType &header = sequence->header;
+    size_t pos = entry.offset;
+
+    ImportAnimType(&data[pos], header);
+    pos += ANIM_TYPE_SIZE;
+
+    if (pos + header.cNum * 3 > data.size()) {
+        throw IOException("Could not read palette data.");
+    }
 
     {
-        display::AutoPal p(palette);
+        display::AutoPal p(sequence->palette);
+        memcpy(&p.pal[header.cOff * 3], &data[pos], header.cNum * 3);
+    }
+
+    pos += header.cNum * 3;
+
+    for (int i = 0; i < header.fNum; i++) {
+        struct BlockHead block;
+
+        if (pos + BLOCK_HEAD_SIZE > data.size()) {
+            throw IOException("Animation " + header.ID + " is truncated");
+        }
+
+        ImportBlockHead(&data[pos], block);
 
-        if (! fread(&p.pal[offset * 3], colors * 3, 1, fin)) {
-            throw IOException("Could not read palette data.");
+        if (block.fSize < 0 || block.fSize >= 128 * 1024 ||
+            pos + BLOCK_HEAD_SIZE + block.fSize > data.size()) {
+            throw IOException("Animation " + header.ID + " is truncated");
         }
+
+        sequence->frameOffsets.push_back(pos);
+        pos += BLOCK_HEAD_SIZE + block.fSize;
     }
 
-    return palette;
+    sequence->data = file.data;
+    sequence->frames.resize(header.fNum);
+    return sequence;
+}
+
+
+/**
+ * Read an AnimType struct stored in a file as raw data.
+ *
+ * On disk, the struct is laid out as
+ *   char ID[8], OVL[4], SD[2][4];
+ *   int16_t w, h;
+ *   uint8_t sPlay[2], fNum, fLoop, cOff, cNum;
+ *
+ * \param src  The raw data, at least ANIM_TYPE_SIZE bytes.
+ * \param target  The destination for the read data.
+ * \return  the number of bytes read.
+ */
+size_t ImportAnimType(const uint8_t *src, struct AnimType &target)
+{
+    const char *text = (const char *)src;
+
+    target.ID.assign(text, strnlen(text, 8));
+    target.OVL.assign(text + 8, strnlen(text + 8, 4));
+    target.SD[0].assign(text + 12, strnlen(text + 12, 4));
+    target.SD[1].assign(text + 16, strnlen(text + 16, 4));
+    target.w = ReadLE16(src + 20);
+    target.h = ReadLE16(src + 22);
+    target.sPlay[0] = src[24];
+    target.sPlay[1] = src[25];
+    target.fNum = src[26];
+    target.fLoop = src[27];
+    target.cOff = src[28];
+    target.cNum = src[29];
+    return ANIM_TYPE_SIZE;
 }
 
 
 /**
- * Sets the file position to the start of the animation header.
+ * Read a BlockHead struct stored in a file as raw data.
  *
- * After calling the function, the file header will be positioned
- * to read the AnimType data for the specified animation. If the
- * named animation isn't found in the animation index, behavior
- * is undefined.
+ * A BlockHead is a header in an animation file, at the beginning of
+ * an animation frame. It contains a value for identifying the
+ * compression, and the size (in bytes) of the animation pixel data
+ * that follows.
  *
- * \param fin   An open .abz animation file.
- * \param name  The 4-character animation identifier.
+ * \param src  The raw data, at least BLOCK_HEAD_SIZE bytes.
+ * \param target  The destination for the read data
+ * \return  the number of bytes read.
  */
-void SeekAnimation(FILE *fin, const char *name)
+size_t ImportBlockHead(const uint8_t *src, struct BlockHead &target)
+{
+    target.cType = src[0];
+    target.fSize = (int32_t)ReadLE32(src + 1);
+    return BLOCK_HEAD_SIZE;
+}
+
+
+uint16_t ReadLE16(const uint8_t *src)
+{
+    return src[0] | (src[1] << 8);
+}
+
+
+uint32_t ReadLE32(const uint8_t *src)
 {
-    struct BZFileHeader {
-        char ID[4];
-        int32_t offset;
-        int32_t size;
-    } indexEntry;
-
-    assert(fin);
-    fseek(fin, 0, SEEK_SET);
-
-    // TODO: Add a check to make sure fname is found in file, else
-    // this becomes an infinite loop.
-    do {
-        fread(&indexEntry.ID[0], sizeof(indexEntry.ID), 1, fin);
-        fread(&indexEntry.offset, sizeof(indexEntry.offset), 1, fin);
-        fread(&indexEntry.size, sizeof(indexEntry.size), 1, fin);
-    } while (strncmp(indexEntry.ID, name, 4) != 0);
-
-    Swap32bit(indexEntry.offset);
-    Swap32bit(indexEntry.size);
-    fseek(fin, indexEntry.offset, SEEK_SET);
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
 }
 
 };  // End of namespace
@@ -15,6 +15,11 @@
  * This class is an interface for an animation loaded from a .abz
  * animation file.
  *
+ * Animation files are read and indexed once, and kept in a small
+ * cache of recently used files. Frames are decoded when advance()
+ * first reaches them; the decoded frames are shared by every
+ * instance of the same animation.
+ *
  * TODO: Add duration methods to show the animation length & time
  * remaining.
  */
@@ -24,21 +29,22 @@ public:
     typedef boost::shared_ptr<BZAnimation> Ptr;
 
     static Ptr load(const char *file, const char *id, int x, int y);
+    static void clearCache();
 
     ~BZAnimation();
 
     void advance();
 
+    struct Sequence;
+
 private:
     int mX, mY;
     int mCurrentFrame;
     // mDisplay is where frames are staged before being drawn.
     display::LegacySurface *mDisplay;
-    struct AnimType mHeader;
-    std::vector<uint8_t *> mFrameData;
+    boost::shared_ptr<Sequence> mSequence;
 
-    BZAnimation(struct AnimType header, display::Palette palette,
-                std::vector<uint8_t *> frames, int x, int y);
+    BZAnimation(boost::shared_ptr<Sequence> sequence, int x, int y);
 
 };
 
@@ -768,7 +768,7 @@ void DrawHard(char mode, char pad, char mis, char plr)
     }
 
     display::graphics.setForegroundColor(1);
-    const struct mStr plan = GetMissionPlan(mis);
+    const struct mStr &plan = GetMissionPlan(mis);
     draw_string(85, 70, (plan.Abbr).c_str());
 //Missions(plr,85,70,mis,0);
 
@@ -848,7 +848,7 @@ int HardRequest(char plr, char mode, char mis, char pad)
         }
     }
 
-    const struct mStr plan = GetMissionPlan(mis);
+    const struct mStr &plan = GetMissionPlan(mis);
 
     // Exceptions
     // One-man capsules cannot perform Lunar missions, Docking missions.
@@ -1028,7 +1028,7 @@ int SecondHard(char plr, char mode, char mis, char pad)
         }
     }
 
-    const struct mStr plan = GetMissionPlan(mis);
+    const struct mStr &plan = GetMissionPlan(mis);
 
     // Exceptions
     // One-man capsules cannot perform Lunar missions, Docking missions.
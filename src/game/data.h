@@ -1317,6 +1317,28 @@ struct OLDNEWS {
 //#define RaceIntoSpace_Signature   'RiSP'
 #define RaceIntoSpace_Signature 0x52695350
 #define RaceIntoSpace_Old_Sig 0x49443a00  //'ID:\0"
+#define RaceIntoSpace_Binary_Sig 0x52695342  // 'RiSB'
+#define RaceIntoSpace_Delta_Sig 0x52695344  // 'RiSD'
+
+/**
+ * Version of the binary save layout.
+ *
+ * Binary saves hold the output of the serialize() methods of Players
+ * and INTERIMDATA, so this must be bumped whenever they change the
+ * fields they archive. Saves of a newer version are refused.
+ *
+ * Version 2 adds the turn history, which is empty unless the
+ * save_history option is set. Version 3 adds the state of the random
+ * number generators. Version 4 keeps the turn history serialized, so
+ * it no longer depends on the machine; older histories are dropped.
+ */
+#define SAVE_BINARY_VERSION 5
+
+/**
+ * Version of the play-by-mail delta layout: a PbemDelta against the
+ * state last received from the opponent, followed by the interim data.
+ */
+#define SAVE_DELTA_VERSION 1
 
 
 struct SaveFileHdr {
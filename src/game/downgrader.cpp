@@ -24,6 +24,7 @@
 #include <json/json.h>
 
 #include "Buzz_inc.h"
+#include "asset_registry.h"
 #include "ioexception.h"
 #include "logging.h"
 #include "mission_util.h"
@@ -271,3 +272,28 @@ Downgrader::Options LoadJsonDowngrades(std::string filename)
     input.close();
     return options;
 }
+
+
+namespace
+{
+struct DowngradeAsset {
+    static void load(Downgrader::Options &x, const std::string &name)
+    {
+        x = LoadJsonDowngrades(name);
+    }
+};
+};
+
+
+/* Get the shared mission downgrade options from DOWNGRADES.JSON.
+ *
+ * The file is read on first use and kept in the asset registry.
+ *
+ * \return  A collection of MissionType.MissionCode-indexed downgrade
+ *          options.
+ * \throws IOException  If the downgrades file is not readable.
+ */
+boost::shared_ptr<const Downgrader::Options> GetDowngrades()
+{
+    return AssetRegistry::get<Downgrader::Options, DowngradeAsset>("DOWNGRADES.JSON");
+}
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include <boost/shared_ptr.hpp>
+
 #include "data.h"
 
 
@@ -47,6 +49,7 @@ private:
 
 
 Downgrader::Options LoadJsonDowngrades(std::string filename);
+boost::shared_ptr<const Downgrader::Options> GetDowngrades();
 
 
 #endif // DOWNGRADER_H
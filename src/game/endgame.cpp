@@ -32,6 +32,7 @@
 
 #include "Buzz_inc.h"
 #include "aipur.h"
+#include "asset_registry.h"
 #include "draw.h"
 #include "mission_util.h"
 #include "fireworks.h"
@@ -45,6 +46,7 @@
 #include "gr.h"
 #include "pace.h"
 #include "filesystem.h"
+#include "options.h"
 #include "pbm.h"
 
 
@@ -60,6 +62,17 @@ char PF[29][40] = {
 };
 
 
+/* The alternate histories of endgame.json. */
+struct EndgameText {
+    std::vector<std::string> text;
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(CEREAL_NVP(text));
+    }
+};
+
 char Burst(char win);
 void EndGame(char win, char pad);
 void Load_LenFlag(char win);
@@ -236,19 +249,19 @@ void EndGame(char win, char pad)
     r = Data->P[win].AstroCount;
 
     if (man1 <= -1) {
-        man1 = brandom(r);
+        man1 = brandom(r, RNG_Cosmetic);
     }
 
     if (man2 <= -1) {
-        man2 = brandom(r);
+        man2 = brandom(r, RNG_Cosmetic);
     }
 
     if (man3 <= -1) {
-        man3 = brandom(r);
+        man3 = brandom(r, RNG_Cosmetic);
     }
 
     if (man4 <= -1) {
-        man4 = brandom(r);
+        man4 = brandom(r, RNG_Cosmetic);
     }
 
     if (!(Option == -1 || Option == win)) {
@@ -649,7 +662,7 @@ void FakeWin(char win)
 {
     int i, r;
     char miss, prog, man1, man2, man3, man4, bud, yr, monthWin;
-    monthWin = brandom(12);
+    monthWin = brandom(12, RNG_Cosmetic);
 
     FadeOut(2, 10, 0, 0);
     display::graphics.screen()->clear();
@@ -672,7 +685,7 @@ void FakeWin(char win)
     draw_small_flag(win, 4, 4);
     display::graphics.setForegroundColor(1);
     draw_string(258, 13, "CONTINUE");
-    r = brandom(100);
+    r = brandom(100, RNG_Cosmetic);
 
     if (r < 45) {
         miss = Mission_HistoricalLanding;
@@ -692,15 +705,15 @@ void FakeWin(char win)
     display::graphics.setForegroundColor(6);
 
     if (Data->Year <= 65) {
-        r = 65 + brandom(5);
+        r = 65 + brandom(5, RNG_Cosmetic);
     } else if (Data->Year <= 70) {
-        r = 70 + brandom(3);
+        r = 70 + brandom(3, RNG_Cosmetic);
     } else if (Data->Year <= 77) {
         r = Data->Year;
     }
 
     yr = r;
-    r = brandom(100);
+    r = brandom(100, RNG_Cosmetic);
 
     if (miss == Mission_DirectAscent_LL) {
         prog = 5;
@@ -717,16 +730,16 @@ void FakeWin(char win)
     display::graphics.setForegroundColor(8);
     draw_string(0, 0, &Data->P[win].Manned[prog - 1].Name[0]);
     draw_string(0, 0, " ");
-    draw_string(0, 0, RomanNumeral(brandom(15) + 2).c_str());
+    draw_string(0, 0, RomanNumeral(brandom(15, RNG_Cosmetic) + 2).c_str());
     display::graphics.setForegroundColor(6);
     draw_string(0, 0, "  -  ");
     display::graphics.setForegroundColor(8);;
-    draw_number(0, 0, brandom(daysAMonth[monthWin]) + 1);
+    draw_number(0, 0, brandom(daysAMonth[monthWin], RNG_Cosmetic) + 1);
     draw_string(0, 0, " ");
     draw_string(0, 0, Month[monthWin]);
     draw_string(0, 0, "19");
     draw_number(0, 0, yr);
-    r = brandom(100);
+    r = brandom(100, RNG_Cosmetic);
 
     if (win == 1 && prog == 5) {
         bud = 5;
@@ -742,12 +755,12 @@ void FakeWin(char win)
 
     InBox(241, 67, 313, 112);
     EndPict(242, 68, bud, 128);
-    PatchMe(win, 270, 34, prog - 1, brandom(9));
+    PatchMe(win, 270, 34, prog - 1, brandom(9, RNG_Cosmetic));
     r = Data->P[win].AstroCount;
-    man1 = brandom(r);
-    man2 = brandom(r);
-    man3 = brandom(r);
-    man4 = brandom(r);
+    man1 = brandom(r, RNG_Cosmetic);
+    man2 = brandom(r, RNG_Cosmetic);
+    man3 = brandom(r, RNG_Cosmetic);
+    man4 = brandom(r, RNG_Cosmetic);
 
     while (1) {
         if ((man1 != man2) && (man1 != man3) && (man2 != man4) &&
@@ -756,27 +769,27 @@ void FakeWin(char win)
         }
 
         while (man1 == man2) {
-            man2 = brandom(r);
+            man2 = brandom(r, RNG_Cosmetic);
         }
 
         while (man1 == man3) {
-            man3 = brandom(r);
+            man3 = brandom(r, RNG_Cosmetic);
         }
 
         while (man2 == man4) {
-            man2 = brandom(r);
+            man2 = brandom(r, RNG_Cosmetic);
         }
 
         while (man2 == man3) {
-            man3 = brandom(r);
+            man3 = brandom(r, RNG_Cosmetic);
         }
 
         while (man3 == man4) {
-            man4 = brandom(r);
+            man4 = brandom(r, RNG_Cosmetic);
         }
 
         while (man1 == man4) {
-            man4 = brandom(r);
+            man4 = brandom(r, RNG_Cosmetic);
         }
     }
 
@@ -936,17 +949,12 @@ void FakeHistory(char plr, char Fyear)  // holds the winning player
 
 std::string HistFile(unsigned char bud)
 {
-    std::vector<std::string> text;
-    
-    std::string filename = "endgame.json";
-    std::ifstream file(locate_file(filename.c_str(), FT_DATA));
-    if (!file) {
-		throw std::runtime_error(filename + " could not be opened.");
-	}
-    cereal::JSONInputArchive ar(file);
-    ar(CEREAL_NVP(text));
-    
-    return text[bud];
+    boost::shared_ptr<const EndgameText> history =
+        AssetRegistry::get<EndgameText,
+        DataAsset<EndgameText, JsonCache::Fields<EndgameText> > >(
+            "endgame.json");
+
+    return history->text.at(bud);
 }
 
 void PrintHist(const char *buf)
@@ -1182,14 +1190,21 @@ void PlayFirst(char plr, char first)
         }
     }
 
+    // Simulations only need the firsts marked as shown
+    if (options.want_simulate) {
+        return;
+    }
+
     display::graphics.setForegroundColor(7);
     FadeIn(2, 10, 0, 0);
 
-    // Play the mission replay video
-    if (Option == -1 && MAIL == -1) {
-        Replay(plr, Data->P[plr].PastMissionCount - 1, 85, 38, 150, 80, "OOOO");
-    } else {
-        Replay(index, Data->Prestige[first].Index, 85, 38, 150, 80, "OOOO");
+    // Play the mission replay video, unless the presentation is instant
+    if (presentation_speed() != PRESENT_INSTANT) {
+        if (Option == -1 && MAIL == -1) {
+            Replay(plr, Data->P[plr].PastMissionCount - 1, 85, 38, 150, 80, "OOOO");
+        } else {
+            Replay(index, Data->Prestige[first].Index, 85, 38, 150, 80, "OOOO");
+        }
     }
 
     PauseMouse();
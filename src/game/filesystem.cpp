@@ -1,5 +1,6 @@
 #include "filesystem.h"
 
+#include <atomic>
 #include <cassert>
 #include <stdexcept>
 
@@ -32,6 +33,9 @@ using boost::format;
 
 Filesystem Filesystem::singleton;
 
+// Set by the AI benchmark to count file opens; nothing otherwise
+static std::atomic<Filesystem::OpenHook> openHook(NULL);
+
 Filesystem::Filesystem()
 {
     // do nothing
@@ -180,6 +184,8 @@ boost::shared_ptr<File> Filesystem::open(const std::string &filename)
         throw_error_with_detail(filename);
     }
 
+    fileOpened();
+
     boost::shared_ptr<File> file_ptr(new File(file_handle));
     return file_ptr;
 }
@@ -192,6 +198,8 @@ boost::shared_ptr<File> Filesystem::openWrite(const std::string &filename)
         throw_error_with_detail(filename);
     }
 
+    fileOpened();
+
     boost::shared_ptr<File> file_ptr(new File(file_handle));
     return file_ptr;
 }
@@ -237,3 +245,17 @@ boost::shared_ptr<display::PalettizedSurface> Filesystem::readImage(const std::s
     // pass it back to the caller
     return image;
 }
+
+void Filesystem::setOpenHook(OpenHook hook)
+{
+    openHook = hook;
+}
+
+void Filesystem::fileOpened()
+{
+    OpenHook hook = openHook;
+
+    if (hook != NULL) {
+        hook();
+    }
+}
@@ -30,6 +30,11 @@ public:
     static void readToBuffer(const std::string &filename, void *buffer, uint32_t length, uint32_t offset = 0);
     static boost::shared_ptr<display::PalettizedSurface> readImage(const std::string &filename);
     static void addPath(const char *s);
+
+    // Called for each file opened here or with sOpen(), if set
+    typedef void (*OpenHook)(void);
+    static void setOpenHook(OpenHook hook);
+    static void fileOpened();
 };
 
 #endif // FILESYSTEM_H
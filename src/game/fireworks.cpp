@@ -200,23 +200,23 @@ void Fireworks::initBomb()
 {
     uint8_t color = 1;
     int initSpeed, startx, starty;
-    int region = brandom(100);
+    int region = brandom(100, RNG_Cosmetic);
 
     if (region < 60) {
-        startx = 132 + brandom(187);
-        starty = 5 + brandom(39);
+        startx = 132 + brandom(187, RNG_Cosmetic);
+        starty = 5 + brandom(39, RNG_Cosmetic);
     } else {
-        startx = 178 + brandom(66);
-        starty = 11 + brandom(33);
+        startx = 178 + brandom(66, RNG_Cosmetic);
+        starty = 11 + brandom(33, RNG_Cosmetic);
     }
 
     do {
-        initSpeed = brandom(mMaxInitSpeed);
+        initSpeed = brandom(mMaxInitSpeed, RNG_Cosmetic);
     } while (initSpeed < mMinInitSpeed);
 
     for (unsigned int i = 0; i < mParticles; i++) {
         double angle = randomAngle();
-        double speed = double(brandom(initSpeed));
+        double speed = double(brandom(initSpeed, RNG_Cosmetic));
         color = cycleColor(color);
 
         mBomb[i].position[0] = double(startx);
@@ -224,7 +224,7 @@ void Fireworks::initBomb()
         mBomb[i].velocity[0] = speed * std::cos(angle);
         mBomb[i].velocity[1] = speed * std::sin(angle);
         mBomb[i].color = color;
-        mBomb[i].life = brandom(mMaxBombLife);
+        mBomb[i].life = brandom(mMaxBombLife, RNG_Cosmetic);
     }
 
     mBombAge = 0;
@@ -244,5 +244,5 @@ double Fireworks::randomAngle()
 {
     // If using rand(), #include <cstdlib>
     // return 2.0 * PI * (double(rand()) / double(RAND_MAX + 1.0));
-    return double(brandom(2 * PI));
+    return double(brandom(2 * PI, RNG_Cosmetic));
 }
@@ -23,6 +23,7 @@
 
 #include "fs.h"
 
+#include <atomic>
 #include <cassert>
 #include <cctype>
 #include <cerrno>
@@ -31,11 +32,21 @@
 #include <physfs.h>
 
 #include "Buzz_inc.h"
+#include "asset_registry.h"
+#include "filesystem.h"
 #include "options.h"
 #include "pace.h"
 #include "raceintospace_config.h"
 #include "utils.h"
 
+#ifdef CONFIG_WIN32
+#include <windows.h>
+#include <process.h>
+#define getpid _getpid
+#elif defined(HAVE_UNISTD_H)
+#include <unistd.h>
+#endif
+
 /** path separator setup */
 #ifndef PATHSEP
 # if CONFIG_WIN32
@@ -274,6 +285,10 @@ try_find_file(const char *name, const char *mode, int type)
         assert("Unknown FT_* specified");
     }
 
+    if (f.handle != NULL) {
+        Filesystem::fileOpened();
+    }
+
     if (f.handle == NULL && type != FT_SAVE_CHECK) {
         int serrno = errno;
         WARNING3("can't find file `%s' in %s dir(s)", name, where);
@@ -338,6 +353,52 @@ remove_savedat(const char *name)
     return rv;
 }
 
+/** Name a temporary file to write in place of another
+ *
+ * The name is unique to the process and the call, so writers in
+ * different threads or processes never share a temporary file.
+ *
+ * \param path The file that will be replaced
+ *
+ * \return a path next to it, for replace_file()
+ */
+std::string
+temp_path(const std::string &path)
+{
+    static std::atomic<unsigned> serial(0);
+    char suffix[32];
+
+    snprintf(suffix, sizeof(suffix), ".%ld.%u.tmp",
+             (long)getpid(), serial++);
+    return path + suffix;
+}
+
+/** Move a file over another in one step
+ *
+ * Either the old or the new file is in place at any moment, even if
+ * the game stops partway.
+ *
+ * \param from The file written with the new contents
+ * \param to The file to replace, which needn't exist
+ *
+ * \return 0 on success, errno otherwise
+ */
+int
+replace_file(const std::string &from, const std::string &to)
+{
+#ifdef CONFIG_WIN32
+    // rename() won't replace an existing file on Windows
+    if (!MoveFileExA(from.c_str(), to.c_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        return (GetLastError() == ERROR_ACCESS_DENIED) ? EACCES : EIO;
+    }
+
+    return 0;
+#else
+    return (rename(from.c_str(), to.c_str()) == 0) ? 0 : errno;
+#endif
+}
+
 FILE *
 open_gamedat(const char *name)
 {
@@ -353,8 +414,9 @@ open_savedat(const char *name, const char *mode)
 char * load_gamedata(const char *name)
 {
 	// Deserialize in vector data
-	std::vector<uint8_t> data;
-	DESERIALIZE_JSON_FILE(&data, locate_file(name, FT_DATA));
+	boost::shared_ptr<const std::vector<uint8_t> > asset =
+	    AssetRegistry::get<std::vector<uint8_t> >(name);
+	const std::vector<uint8_t> &data = *asset;
 	
 	// Transform vector data in char pointer p
 	char* p = new char[data.size() + 1]; // +1 for null char
@@ -48,6 +48,8 @@ extern FILE *open_savedat(const char *name, const char *mode);
 extern char *load_gamedata(const char *name);
 extern int create_save_dir(void);
 extern int remove_savedat(const char *name);
+extern std::string temp_path(const std::string &path);
+extern int replace_file(const std::string &from, const std::string &to);
 extern void fix_pathsep(char *path);
 
 #endif /* _FS_H */
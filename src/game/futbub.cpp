@@ -29,6 +29,7 @@
 #include "display/surface.h"
 
 #include "Buzz_inc.h"
+#include "asset_registry.h"
 #include "draw.h"
 #include "game_main.h"
 #include "gr.h"
@@ -173,8 +174,8 @@ void MissionPath(char plr, int val, int pad)
     memset(Mev, 0x00, sizeof Mev);
     
     // Deserialize missSteps
-    std::vector<std::string> missSteps;
-    DESERIALIZE_JSON_FILE(&missSteps, locate_file("missSteps.json", FT_DATA));
+    const std::vector<std::string> &missSteps =
+        *AssetRegistry::get<std::vector<std::string> >("missSteps.json");
     
     // Read mission step data and find correct entry
     int index = 0;
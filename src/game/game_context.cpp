@@ -0,0 +1,89 @@
+// This file handles switching between games in progress.
+
+#include "game_context.h"
+
+#include <utility>
+
+#include "Buzz_inc.h"
+#include "game_main.h"
+#include "rng.h"
+#include "turn_history.h"
+#include "utils.h"
+
+
+struct GameContext::State {
+    struct Players *data;
+    char *buffer;
+    INTERIMDATA interim;
+    char ai[NUM_PLAYERS];
+    char players[NUM_PLAYERS];
+    char option;
+    char pNeg[NUM_PLAYERS][MAX_MISSIONS];
+    GameRng rng;
+    TurnHistory history;
+};
+
+
+/**
+ * Create the state for a new game, with empty game data and a scratch
+ * buffer of its own.
+ */
+GameContext::GameContext()
+    : state(new State)
+{
+    state->data = new struct Players;
+    state->buffer = (char *)xmalloc(BUFFER_SIZE);
+    memset(state->buffer, 0x00, BUFFER_SIZE);
+    memset(state->ai, 0x00, sizeof(state->ai));
+    memset(state->players, 0x00, sizeof(state->players));
+    memset(state->pNeg, 0x00, sizeof(state->pNeg));
+    state->option = -1;
+}
+
+
+/**
+ * Free the game held by the context. Swap the context out again first
+ * if its game is live.
+ */
+GameContext::~GameContext()
+{
+    delete state->data;
+    free(state->buffer);
+    delete state;
+}
+
+
+/**
+ * Replace the game held by the context with a copy of the calling
+ * thread's live game, which is left as it was.
+ */
+void GameContext::snapshot()
+{
+    *state->data = *Data;
+    memcpy(state->buffer, buffer, BUFFER_SIZE);
+    state->interim = interimData;
+    memcpy(state->ai, AI, sizeof(state->ai));
+    memcpy(state->players, plr, sizeof(state->players));
+    state->option = Option;
+    memcpy(state->pNeg, pNeg, sizeof(state->pNeg));
+    state->rng = gameRng;
+    state->history = turnHistory;
+}
+
+
+/**
+ * Trade the game held by the context with the calling thread's live
+ * game.
+ */
+void GameContext::swap()
+{
+    std::swap(state->data, Data);
+    std::swap(state->buffer, buffer);
+    std::swap(state->interim, interimData);
+    std::swap(state->ai, AI);
+    std::swap(state->players, plr);
+    std::swap(state->option, Option);
+    std::swap(state->pNeg, pNeg);
+    std::swap(state->rng, gameRng);
+    std::swap(state->history, turnHistory);
+}
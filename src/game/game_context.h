@@ -0,0 +1,49 @@
+#ifndef GAME_CONTEXT_H
+#define GAME_CONTEXT_H
+
+/**
+ * Marks a variable as part of the state of the game being played.
+ *
+ * Each thread has its own copy, so that the AI planner can work on
+ * copies of the game on several threads at once. That is as far as
+ * it goes: the display, the mouse and keyboard state (x, y, key and
+ * the like) and the records table are shared by the process and
+ * belong to the interactive game on the main thread, so code run on
+ * other threads must not reach them. Data loaded from the game files
+ * is shared too, through AssetRegistry, which locks its own store.
+ */
+#define GAME_LOCAL thread_local
+
+
+/**
+ * A game that isn't being played right now.
+ *
+ * The game code works on the calling thread's live state: Data,
+ * interimData, AI, plr and the other GAME_LOCAL variables. A context
+ * holds the lasting part of that state for another game, and swap()
+ * trades it with the live one, so a thread can keep several games and
+ * play them in turn.
+ *
+ * The state of a mission in flight (Mev, STEP and the like) isn't
+ * kept, so contexts may only be swapped between missions. A new
+ * thread starts with no game, and must swap a context in before
+ * playing.
+ */
+class GameContext
+{
+public:
+    GameContext();
+    ~GameContext();
+
+    void snapshot();
+    void swap();
+
+private:
+    struct State;
+    State *state;
+
+    GameContext(const GameContext &);
+    GameContext &operator=(const GameContext &);
+};
+
+#endif // GAME_CONTEXT_H
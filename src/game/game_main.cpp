@@ -41,7 +41,9 @@
 #include "Buzz_inc.h"
 #include "game_main.h"  // Below Buzz_inc.h b/c game_main.h needs data.h
 #include "admin.h"
+#include "aibench.h"
 #include "aimast.h"
+#include "asset_index.h"
 #include "ast4.h"
 #include "crash.h"
 #include "crew.h"
@@ -51,6 +53,8 @@
 #include "hardware.h"
 #include "intel.h"
 #include "intro.h"
+#include "journal.h"
+#include "json_cache.h"
 #include "mc.h"
 #include "mission_util.h"
 #include "museum.h"
@@ -66,8 +70,10 @@
 #include "review.h"
 #include "sdlhelper.h"
 #include "settings.h"
+#include "simulate.h"
 #include "start.h"
 #include "state_utils.h"
+#include "turn_history.h"
 #include "utils.h"
 
 #ifdef CONFIG_MACOSX
@@ -76,31 +82,31 @@
 #include <SDL.h>
 #endif
 
-char Name[20];
-struct Players *Data;
+GAME_LOCAL char Name[20];
+GAME_LOCAL struct Players *Data;
 int x;
 int y;
 int mousebuttons;
 int key;
 int oldx;
 int oldy;
-unsigned char LOAD;
-unsigned char QUIT;
-unsigned char AL_CALL;
-char plr[NUM_PLAYERS];
+GAME_LOCAL unsigned char LOAD;
+GAME_LOCAL unsigned char QUIT;
+GAME_LOCAL unsigned char AL_CALL;
+GAME_LOCAL char plr[NUM_PLAYERS];
 std::string helpText;
 std::string keyHelpText;
-char *buffer;
-char pNeg[NUM_PLAYERS][MAX_MISSIONS];
-int32_t xMODE;
-char Option = -1;
+GAME_LOCAL char *buffer;
+GAME_LOCAL char pNeg[NUM_PLAYERS][MAX_MISSIONS];
+GAME_LOCAL int32_t xMODE;
+GAME_LOCAL char Option = -1;
 // true for fullscreen mission playback, false otherwise
-bool fullscreenMissionPlayback;
-char manOnMoon = 0;
-char dayOnMoon = 20;
-char AI[2] = {0, 0};
+GAME_LOCAL bool fullscreenMissionPlayback;
+GAME_LOCAL char manOnMoon = 0;
+GAME_LOCAL char dayOnMoon = 20;
+GAME_LOCAL char AI[2] = {0, 0};
 // Used to hold mid-turn save game related information
-INTERIMDATA interimData;
+GAME_LOCAL INTERIMDATA interimData;
 struct AssetData *Assets;
 
 const char *S_Name[] = {
@@ -145,11 +151,8 @@ LOG_DEFAULT_CATEGORY(LOG_ROOT_CAT)
 int game_main_impl(int argc, char *argv[]);
 int CheckIfMissionGo(char plr, char launchIdx);
 void ConfigureAudio();
-void InitData(void);
-void MainLoop(void);
 void DockingKludge(void);
 void OpenEmUp(void);
-void CloseEmUp(unsigned char error, unsigned int value);
 void VerifyCrews(char plr);
 
 
@@ -215,16 +218,39 @@ int game_main_impl(int argc, char *argv[])
 
     Assets = new struct AssetData;
 
-    DESERIALIZE_JSON_FILE(&Assets->sSeq, locate_file("seq.json", FT_DATA));
-    DESERIALIZE_JSON_FILE(&Assets->fSeq, locate_file("fseq.json", FT_DATA));
-    DESERIALIZE_JSON_FILE(&Assets->fails, locate_file("fails.json", FT_DATA));
-    DESERIALIZE_JSON_FILE(&Assets->help, locate_file("help.json", FT_DATA));
+    DeserializeCachedJSON(&Assets->sSeq, "seq.json");
+    DeserializeCachedJSON(&Assets->fSeq, "fseq.json");
+    DeserializeCachedJSON(&Assets->fails, "fails.json");
+    DeserializeCachedJSON(&Assets->help, "help.json");
+    IndexAssets(*Assets);
 
     OpenEmUp();                   // OPEN SCREEN AND SETUP GOODIES
 
     ConfigureAudio();
 
-    if (options.want_intro) {
+    if (options.bench_ai) {
+        int result = RunAIBenchmark();
+        display::graphics.destroy();
+        exit(result);
+    }
+
+    if (options.replay_file) {
+        int result = RunReplay();
+        display::graphics.destroy();
+        exit(result);
+    }
+
+    if (options.journal_file) {
+        gameJournal.record(options.journal_file);
+    }
+
+    if (options.want_simulate) {
+        int result = RunSimulation();
+        display::graphics.destroy();
+        exit(result);
+    }
+
+    if (options.want_intro && presentation_speed() != PRESENT_INSTANT) {
         Introd();
     }
 
@@ -234,7 +260,7 @@ int game_main_impl(int argc, char *argv[])
         bool launchGame = false;
         MakeRecords();
 
-        DESERIALIZE_JSON_FILE(Data, locate_file("urast.json", FT_DATA));
+        DeserializeCachedJSON(Data, "urast.json");
 
         if (Data->Checksum != (sizeof(struct Players))) {
             /* XXX: too drastic */
@@ -299,6 +325,8 @@ int game_main_impl(int argc, char *argv[])
                     AI[0] = AI[1] = 0;
                 }
 
+                turnHistory.clear();
+                randomize();
                 InitData();                   // PICK EVENT CARDS N STUFF
                 MainLoop();                   // PLAY GAME
                 display::graphics.screen()->clear();
@@ -468,6 +496,9 @@ void InitData(void)
         }
     }
 
+    ResetAI();                     // FORGET THE LAST GAME'S AI STATE
+    ClearPbemBase();               // AND ANY MAIL GAME'S SHARED STATE
+
     return;
 }
 
@@ -506,9 +537,21 @@ restart:                              // ON A LOAD PROG JUMPS TO HERE
 
     LOAD = 0;                           // CLEAR LOAD FLAG
 
+    gameJournal.recordStart();
+
     while (Data->Year < 78) {            // WHILE THE YEAR IS NOT 1977
 
         if (newTurn) {
+            turn = 2 * (Data->Year - 57) + Data->Season + 1;
+
+            // Check a replay against the journal, which may end it here
+            if (!gameJournal.turn(turn)) {
+                return;
+            }
+
+            // Keep the state at the start of the turn to rewind to
+            turnHistory.record(*Data, interimData, gameRng);
+
             // CLEAR ALL TURN RD MODS
             Data->P[0].RD_Mods_For_Turn = 0;
             Data->P[1].RD_Mods_For_Turn = 0;
@@ -573,6 +616,11 @@ restart:                              // ON A LOAD PROG JUMPS TO HERE
                     helpText = "i136";
                     Data->P[abs(i - 1)].PresRev[0] = 0x7F;
                     helpText = "i000";
+                    QUIT = 1;
+
+                    if (gameJournal.replaying()) {
+                        return;
+                    }
 
                     if (IDLE[0] > 12 || IDLE[1] > 12) {
                         SpecialEnd();
@@ -582,12 +630,19 @@ restart:                              // ON A LOAD PROG JUMPS TO HERE
                     }
 
                     FadeOut(2, 10, 0, 0);
-                    QUIT = 1;
                     return;
                 }
             }
 
-            if (!AI[i]) {
+            if (!AI[i] && gameJournal.replaying()) {
+                // Play the turn as the player did
+                if (!gameJournal.replayDecision(JOURNAL_HalfTurn, plr[i])) {
+                    return;
+                }
+
+                IDLE.at(plr[i])++;
+            } else if (!AI[i]) {
+                gameJournal.beginDecision();
                 NextTurn(plr[i]);
                 VerifySafety(plr[i]);
 
@@ -631,6 +686,7 @@ restart:                              // ON A LOAD PROG JUMPS TO HERE
                     goto restart;    // TEST FOR LOAD
                 }
 
+                gameJournal.recordDecision(JOURNAL_HalfTurn, plr[i]);
                 IDLE.at(plr[i])++;
             } else {
                 AI_Begin(plr[i] - 2); // Turns off Mouse for AI
@@ -668,6 +724,8 @@ restart:                              // ON A LOAD PROG JUMPS TO HERE
         DockingKludge();  // fixup for both sides
 
         // Do Missions Here
+        // Records set by this turn's missions are written out together.
+        RecordsBatch recordsBatch;
         int kik = OrderMissions();
 
         for (int i = 0; i < kik; i++) {
@@ -693,6 +751,11 @@ restart:                              // ON A LOAD PROG JUMPS TO HERE
                         }
 
                         if (Data->Prestige[Prestige_MannedLunarLanding].Place != -1) {
+                            if (options.want_simulate) {
+                                RecordSimulatedTurn();
+                                return;
+                            }
+
                             if (MAIL != 0 && MAIL != 3) {
                                 UpdateRecords(1);
                                 NewEnd(Data->Prestige[Prestige_MannedLunarLanding].Place, Order[i].loc);
@@ -711,7 +774,7 @@ restart:                              // ON A LOAD PROG JUMPS TO HERE
 
                         }
 
-                        if (!(AI[Order[i].plr] || (MAIL == 1 && Order[i].plr == 0) || (MAIL == 2 && Order[i].plr == 1)) && prest != -20) { // -20 means scrubbed
+                        if (!(AI[Order[i].plr] || (MAIL == 1 && Order[i].plr == 0) || (MAIL == 2 && Order[i].plr == 1)) && prest != -20 && !gameJournal.replaying()) { // -20 means scrubbed
                             MisRev(Order[i].plr, prest, Data->P[Order[i].plr].PastMissionCount - 1);
                         }
                     }
@@ -735,6 +798,11 @@ restart:                              // ON A LOAD PROG JUMPS TO HERE
 
         if (Data->Year == 77 && Data->Season == 1 && Data->Prestige[Prestige_MannedLunarLanding].Place == -1) {
             // nobody wins .....
+            if (options.want_simulate) {
+                RecordSimulatedTurn();
+                return;
+            }
+
             SpecialEnd();
             MailSwitchEndgame();
             return;
@@ -769,6 +837,10 @@ restart:                              // ON A LOAD PROG JUMPS TO HERE
             }
         }
 
+        if (options.want_simulate) {
+            RecordSimulatedTurn();
+        }
+
         Data->P[0].Prestige = Data->P[1].Prestige = 0;
 
         if (Data->Season == 1) {
@@ -802,6 +874,10 @@ restart:                              // ON A LOAD PROG JUMPS TO HERE
 
     }
 
+    if (options.want_simulate) {
+        return;
+    }
+
     FadeOut(2, 10, 0, 0);
 
     Museum(0);
@@ -863,7 +939,11 @@ void DestroyPad(char plr, char pad, int cost, char mode)
 void
 GetMouse(void)
 {
-    av_block();
+    // There is no input to wait for in a simulation
+    if (!options.want_simulate) {
+        av_block();
+    }
+
     GetMouse_fast();
 }
 
@@ -1015,7 +1095,7 @@ int MisRandom(void)
     const int brandom_threshold = 66;
     double u1, u2, r_gaussian;
 
-    int r_uniform = brandom(100) + 1;
+    int r_uniform = brandom(100, RNG_Mission) + 1;
 
     if (r_uniform < brandom_threshold) {
         return r_uniform;
@@ -1023,8 +1103,8 @@ int MisRandom(void)
 
     do {
         // Generate two uniformly distributed random numbers.
-        u1 = rand() / (double) RAND_MAX;
-        u2 = rand() / (double) RAND_MAX;
+        u1 = 1.0 - gameRng.stream(RNG_Mission).uniform();
+        u2 = gameRng.stream(RNG_Mission).uniform();
 
         // Box-Muller transform to obtain a Gaussian random variable
         // with mean mu and standard deviation sigma. A value of 0.5
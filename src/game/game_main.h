@@ -3,6 +3,8 @@
 
 #include <string>
 
+#include "game_context.h"
+
 namespace display
 {
 class LegacySurface;
@@ -16,31 +18,33 @@ int MisRandom(void);
 void DestroyPad(char plr, char pad, int cost, char mode);
 void PauseMouse(void);
 void GetMouse_fast(void);
+void InitData(void);
+void MainLoop(void);
 
-extern char Option;
-extern char AI[2];
-extern char manOnMoon;
-extern char dayOnMoon;
-extern bool fullscreenMissionPlayback;
-extern char pNeg[NUM_PLAYERS][MAX_MISSIONS];
-extern unsigned char AL_CALL;
+extern GAME_LOCAL char Option;
+extern GAME_LOCAL char AI[2];
+extern GAME_LOCAL char manOnMoon;
+extern GAME_LOCAL char dayOnMoon;
+extern GAME_LOCAL bool fullscreenMissionPlayback;
+extern GAME_LOCAL char pNeg[NUM_PLAYERS][MAX_MISSIONS];
+extern GAME_LOCAL unsigned char AL_CALL;
 extern std::string helpText;
 extern std::string keyHelpText;
 extern int oldx;
 extern int oldy;
-extern unsigned char LOAD;
-extern unsigned char QUIT;
-extern char plr[NUM_PLAYERS];
-extern struct Players *Data;
+extern GAME_LOCAL unsigned char LOAD;
+extern GAME_LOCAL unsigned char QUIT;
+extern GAME_LOCAL char plr[NUM_PLAYERS];
+extern GAME_LOCAL struct Players *Data;
 extern int x;
 extern int y;
 extern int mousebuttons;
 extern int key;
-extern char Name[20];
-extern char *buffer;
-extern int32_t xMODE;
+extern GAME_LOCAL char Name[20];
+extern GAME_LOCAL char *buffer;
+extern GAME_LOCAL int32_t xMODE;
 extern const char *S_Name[];
-extern INTERIMDATA interimData;
+extern GAME_LOCAL INTERIMDATA interimData;
 extern struct AssetData *Assets;
 
 #endif // GAME_MAIN_H
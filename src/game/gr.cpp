@@ -4,6 +4,7 @@
 #include "display/surface.h"
 
 #include "Buzz_inc.h"
+#include "options.h"
 #include "sdlhelper.h"
 
 using std::swap;
@@ -40,6 +41,11 @@ grGetMouseCurPos(int *xp, int *yp)
 void
 gr_sync(void)
 {
+    // Nothing is shown in a simulation
+    if (options.want_simulate) {
+        return;
+    }
+
     av_sync();
 }
 
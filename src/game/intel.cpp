@@ -522,7 +522,7 @@ void MissionIntel(char plr, bool acc)
  */
 void XSpec(char plr, char mis, char year)
 {
-    const struct mStr plan = GetMissionPlan(mis);
+    const struct mStr &plan = GetMissionPlan(mis);
     display::graphics.setForegroundColor(6);
     draw_string(17, 75, "CLASS: ");
     display::graphics.setForegroundColor(9);
@@ -0,0 +1,577 @@
+// This file handles the game journal, for recording and replaying games.
+
+#include "journal.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
+#include <zlib.h>
+
+#include "Buzz_inc.h"
+#include "admin.h"
+#include "byte_delta.h"
+#include "game_main.h"
+#include "ioexception.h"
+#include "options.h"
+#include "pbm.h"
+#include "turn_history.h"
+#include "utils.h"
+
+LOG_DEFAULT_CATEGORY(LOG_ROOT_CAT)
+
+GAME_LOCAL GameJournal gameJournal;
+
+
+namespace
+{
+/**
+ * A checksum of the game, with the generators that decide it.
+ *
+ * The cosmetic stream is left out, since it is only drawn from while
+ * something is shown. Each generator is summed by the next number it
+ * would give, which is as good as its state for telling them apart.
+ *
+ * \param state  the game, from SerializePbemState().
+ */
+uint32_t GameChecksum(const std::string &state)
+{
+    uint32_t sum = crc32(0L, (const Bytef *)state.data(), state.size());
+
+    for (int i = 0; i < RNG_STREAMS; i++) {
+        if (i != RNG_Cosmetic) {
+            Rng copy = gameRng.stream((RngStream)i);
+            uint64_t next = copy.next();
+            sum = crc32(sum, (const Bytef *)&next, sizeof(next));
+        }
+    }
+
+    return sum;
+}
+
+
+/* The change from one serialized game to another. */
+std::vector<uint8_t> GameDelta(const std::string &from, const std::string &to)
+{
+    size_t size = std::max(from.size(), to.size());
+    std::string paddedFrom(from), paddedTo(to);
+
+    paddedFrom.resize(size, '\0');
+    paddedTo.resize(size, '\0');
+    return EncodeDelta((const uint8_t *)paddedFrom.data(),
+                       (const uint8_t *)paddedTo.data(), size);
+}
+
+
+/**
+ * Make the change an entry records to the game.
+ *
+ * \param entry  a start or decision entry.
+ * \param from  the serialized game the change was made to.
+ * \return  false if the change doesn't fit the game.
+ */
+bool ApplyEntry(const struct JournalEntry &entry, const std::string &from)
+{
+    std::string state(from);
+    state.resize(std::max<size_t>(from.size(), entry.size), '\0');
+
+    if (!ApplyDelta(entry.delta, (uint8_t *)&state[0], state.size())) {
+        return false;
+    }
+
+    state.resize(entry.size);
+
+    try {
+        DeserializePbemState(state, *Data);
+    } catch (cereal::Exception &) {
+        return false;
+    }
+
+    return true;
+}
+
+
+const char *EntryName(int type)
+{
+    switch (type) {
+    case JOURNAL_Start:
+        return "start";
+
+    case JOURNAL_Turn:
+        return "turn";
+
+    case JOURNAL_HalfTurn:
+        return "half turn";
+
+    case JOURNAL_Staging:
+        return "staging";
+
+    case JOURNAL_Choice:
+        return "choice";
+
+    default:
+        return "unknown";
+    }
+}
+
+
+/* The result of a replay, as printed by RunReplay(). */
+struct ReplayResult {
+    int turns;      // Turns checked against the journal
+    bool matched;   // Every check passed
+    int year;
+    int season;
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(cereal::make_nvp("turns", turns));
+        ar(cereal::make_nvp("matched", matched));
+        ar(cereal::make_nvp("year", 1900 + year));
+        ar(cereal::make_nvp("season", std::string(season ? "fall" : "spring")));
+    }
+};
+};
+
+
+GameJournal::GameJournal()
+    : position(0), checked(0), failed(false)
+{
+}
+
+
+GameJournal::~GameJournal()
+{
+}
+
+
+/**
+ * Start recording to a journal file.
+ *
+ * Entries are added to the end of the file, so a journal can span
+ * several sessions.
+ *
+ * \param path  The journal file.
+ * \return  false if the file can't be written.
+ */
+bool GameJournal::record(const std::string &path)
+{
+    out.open(path.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+
+    if (!out) {
+        ERROR2("can't write journal `%s'", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Read a journal file to replay.
+ *
+ * Play is replayed from the last time it started or resumed, which
+ * loading a save or starting a new game both record. A journal cut
+ * short, as by a crash, is replayed as far as it goes.
+ *
+ * \param path  The journal file.
+ * \return  false if the file holds no game.
+ */
+bool GameJournal::replay(const std::string &path)
+{
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+
+    if (!in) {
+        ERROR2("can't read journal `%s'", path.c_str());
+        return false;
+    }
+
+    entries.clear();
+
+    try {
+        cereal::PortableBinaryInputArchive archive(in);
+
+        while (in.peek() != EOF) {
+            struct JournalEntry entry;
+            archive(entry);
+
+            if (entry.type == JOURNAL_Start) {
+                entries.clear();
+            }
+
+            entries.push_back(entry);
+        }
+    } catch (cereal::Exception &err) {
+        WARNING2("journal ends early: %s", err.what());
+    }
+
+    if (entries.empty() || entries[0].type != JOURNAL_Start) {
+        ERROR2("no game in journal `%s'", path.c_str());
+        entries.clear();
+        return false;
+    }
+
+    position = 0;
+    checked = 0;
+    failed = false;
+    return true;
+}
+
+
+bool GameJournal::recording() const
+{
+    return out.is_open();
+}
+
+
+bool GameJournal::replaying() const
+{
+    return !entries.empty();
+}
+
+
+/**
+ * Record the whole game, as play starts or resumes.
+ *
+ * Play-by-mail games aren't recorded, since each side plays on its
+ * own machine.
+ */
+void GameJournal::recordStart()
+{
+    if (!recording() || MAIL != -1) {
+        return;
+    }
+
+    std::string state = SerializePbemState(*Data);
+    struct JournalEntry entry;
+
+    entry.type = JOURNAL_Start;
+    entry.plr = -1;
+    entry.value = 0;
+    entry.checksum = GameChecksum(state);
+    entry.size = state.size();
+    entry.delta = GameDelta(std::string(), state);
+    entry.rng = gameRng;
+
+    for (int i = 0; i < NUM_PLAYERS; i++) {
+        entry.ai[i] = AI[i];
+        entry.players[i] = plr[i];
+    }
+
+    write(entry);
+}
+
+
+/**
+ * Set up the game from the start of the journal being replayed.
+ *
+ * \return  false if the journal's game can't be restored.
+ */
+bool GameJournal::startReplay()
+{
+    const struct JournalEntry &start = entries.at(0);
+
+    if (!ApplyEntry(start, std::string())) {
+        ERROR1("journal has a damaged game");
+        return false;
+    }
+
+    gameRng = start.rng;
+
+    for (int i = 0; i < NUM_PLAYERS; i++) {
+        AI[i] = start.ai[i];
+        plr[i] = start.players[i];
+    }
+
+    position = 1;
+    return true;
+}
+
+
+/**
+ * Mark the start of a turn.
+ *
+ * When recording, this keeps a checksum of the game. When replaying,
+ * it checks the game against the one kept, and says when to stop.
+ *
+ * \param turn  The turn, counting Spring 1957 as 1.
+ * \return  false to stop replaying the game.
+ */
+bool GameJournal::turn(int turn)
+{
+    if (recording() && MAIL == -1) {
+        struct JournalEntry entry;
+        entry.type = JOURNAL_Turn;
+        entry.plr = -1;
+        entry.value = turn;
+        entry.checksum = GameChecksum(SerializePbemState(*Data));
+        write(entry);
+    }
+
+    if (!replaying()) {
+        return true;
+    }
+
+    if (failed) {
+        return false;
+    }
+
+    if (position >= entries.size()) {
+        INFO2("replayed to the end of the journal, turn %d", turn);
+        return false;
+    }
+
+    const struct JournalEntry *entry = next(JOURNAL_Turn, -1);
+
+    if (entry == NULL) {
+        return false;
+    }
+
+    if (entry->value != turn ||
+        entry->checksum != GameChecksum(SerializePbemState(*Data))) {
+        ERROR2("replay differs from the journal at turn %d", turn);
+        failed = true;
+        return false;
+    }
+
+    checked++;
+
+    if (options.replay_to && turn >= (int)options.replay_to) {
+        INFO2("replayed to turn %d", turn);
+        autosave_game("JOURNAL.SAV");
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * \return  the number of turns the replay has checked.
+ */
+int GameJournal::turnsChecked() const
+{
+    return checked;
+}
+
+
+/**
+ * \return  true if the replay has gone differently from the journal.
+ */
+bool GameJournal::diverged() const
+{
+    return failed;
+}
+
+
+/**
+ * Keep the game as a human player starts to make decisions, to record
+ * what they change.
+ */
+void GameJournal::beginDecision()
+{
+    if (!recording() || MAIL != -1) {
+        return;
+    }
+
+    before = SerializePbemState(*Data);
+}
+
+
+/**
+ * Record the decisions since beginDecision().
+ *
+ * \param type  JOURNAL_HalfTurn or JOURNAL_Staging.
+ * \param plr  The player deciding.
+ */
+void GameJournal::recordDecision(JournalEntryType type, char plr)
+{
+    if (!recording() || MAIL != -1 || before.empty()) {
+        return;
+    }
+
+    std::string state = SerializePbemState(*Data);
+    struct JournalEntry entry;
+    entry.type = type;
+    entry.plr = plr;
+    entry.value = 0;
+    entry.checksum = GameChecksum(state);
+    entry.size = state.size();
+    entry.delta = GameDelta(before, state);
+    entry.rng = gameRng;
+    write(entry);
+}
+
+
+/**
+ * Make the decisions recorded at this point of the replay.
+ *
+ * \param type  JOURNAL_HalfTurn or JOURNAL_Staging.
+ * \param plr  The player deciding.
+ * \return  false if the journal has something else here.
+ */
+bool GameJournal::replayDecision(JournalEntryType type, char plr)
+{
+    const struct JournalEntry *entry = next(type, plr);
+
+    if (entry == NULL) {
+        return false;
+    }
+
+    // The delta is of the game as it was when recorded, so if this
+    // one differs the checksum shows it.
+    bool applied = ApplyEntry(*entry, SerializePbemState(*Data));
+    gameRng = entry->rng;
+
+    if (!applied ||
+        entry->checksum != GameChecksum(SerializePbemState(*Data))) {
+        ERROR2("replay differs from the journal in a %s", EntryName(type));
+        failed = true;
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Record a choice a human player made during a mission.
+ */
+void GameJournal::recordChoice(char plr, int value)
+{
+    if (!recording() || MAIL != -1) {
+        return;
+    }
+
+    struct JournalEntry entry;
+    entry.type = JOURNAL_Choice;
+    entry.plr = plr;
+    entry.value = value;
+    entry.checksum = 0;
+    write(entry);
+}
+
+
+/**
+ * The choice recorded at this point of the replay.
+ *
+ * \param otherwise  The choice to make if the journal has none here.
+ */
+int GameJournal::replayChoice(char plr, int otherwise)
+{
+    const struct JournalEntry *entry = next(JOURNAL_Choice, plr);
+    return entry ? entry->value : otherwise;
+}
+
+
+/* Add an entry to the journal file, flushed so it survives a crash. */
+void GameJournal::write(const struct JournalEntry &entry)
+{
+    {
+        cereal::PortableBinaryOutputArchive archive(out);
+        archive(entry);
+    }
+
+    out.flush();
+
+    if (!out) {
+        ERROR1("can't write to the journal, so stopped recording");
+        out.close();
+    }
+}
+
+
+/**
+ * Take the next entry of the replay, which must be of the given type.
+ *
+ * \return  the entry, or NULL if the journal has something else next.
+ */
+const struct JournalEntry *GameJournal::next(JournalEntryType type, char plr)
+{
+    if (failed || position >= entries.size()) {
+        failed = true;
+        return NULL;
+    }
+
+    const struct JournalEntry &entry = entries[position];
+
+    if (entry.type != type || (plr != -1 && entry.plr != plr)) {
+        ERROR3("replay expected a %s but the journal has a %s",
+               EntryName(type), EntryName(entry.type));
+        failed = true;
+        return NULL;
+    }
+
+    position++;
+    return &entry;
+}
+
+
+char JournalView::failure(char plr, int note, char *text)
+{
+    return gameJournal.replayChoice(plr, 0);
+}
+
+
+char JournalView::moonWalker(char plr, char nauts, const struct MisEval &step)
+{
+    return gameJournal.replayChoice(plr, 1);
+}
+
+
+/**
+ * Replay the game in the journal named by --replay, without display,
+ * and print how it went as JSON.
+ *
+ * With --replay-to=N the replay stops at the start of turn N, and
+ * writes the game there to JOURNAL.SAV.
+ *
+ * \return  the exit status for the program: failure if the replay
+ *          went differently from the journal.
+ */
+int RunReplay(void)
+{
+    if (!gameJournal.replay(options.replay_file)) {
+        return EXIT_FAILURE;
+    }
+
+    if (!gameJournal.startReplay()) {
+        return EXIT_FAILURE;
+    }
+
+    Option = -1;
+    QUIT = 0;
+    LOAD = 1;   // Resume the game as it is, like a loaded save
+
+    for (size_t i = 0; i < interimData.tempReplay.size(); i++) {
+        interimData.tempReplay[i].clear();
+    }
+
+    turnHistory.clear();
+
+    try {
+        CacheCrewFile();
+    } catch (IOException &err) {
+        CRITICAL2("%s", err.what());
+        return EXIT_FAILURE;
+    }
+
+    MainLoop();
+    FinishAutosave();
+
+    struct ReplayResult result;
+    result.turns = gameJournal.turnsChecked();
+    result.matched = !gameJournal.diverged();
+    result.year = Data->Year;
+    result.season = Data->Season;
+
+    {
+        cereal::JSONOutputArchive archive(std::cout);
+        archive(cereal::make_nvp("replay", result));
+    }
+
+    std::cout << std::endl;
+
+    return result.matched ? EXIT_SUCCESS : EXIT_FAILURE;
+}
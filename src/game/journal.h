@@ -0,0 +1,128 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <cereal/types/vector.hpp>
+
+#include "data.h"
+#include "game_context.h"
+#include "mis_m.h"
+#include "rng.h"
+
+/* The kinds of entry in a game journal. */
+enum JournalEntryType {
+    JOURNAL_Start,     // The whole game, as play starts or resumes
+    JOURNAL_Turn,      // The start of a turn, to check the replay against
+    JOURNAL_HalfTurn,  // A human player's half of a turn
+    JOURNAL_Staging,   // A human player's go-ahead for a mission
+    JOURNAL_Choice     // A human player's choice during a mission
+};
+
+/* One entry of a game journal. */
+struct JournalEntry {
+    uint8_t type;                // JournalEntryType
+    int8_t plr;                  // The player deciding, or -1
+    int32_t value;               // The turn number, or the choice made
+    uint32_t checksum;           // Of the game after the entry
+    uint32_t size;               // Of the serialized game after the entry
+    std::vector<uint8_t> delta;  // The change to the serialized game
+    GameRng rng;                 // The generators after the entry
+    int8_t ai[NUM_PLAYERS];      // Start only: AI[]
+    int8_t players[NUM_PLAYERS]; // Start only: plr[]
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(type, plr, value, checksum);
+
+        if (type == JOURNAL_Start || type == JOURNAL_HalfTurn ||
+            type == JOURNAL_Staging) {
+            ar(size, delta, rng);
+        }
+
+        if (type == JOURNAL_Start) {
+            ar(ai, players);
+        }
+    }
+};
+
+
+/**
+ * An append-only record of a game, from which it can be played again
+ * exactly.
+ *
+ * The computer player and the missions play the same way again from
+ * the same random numbers, so only what the human players do needs
+ * keeping. Each stretch of play where a human makes decisions (their
+ * half of the turn, and the go-ahead for each of their missions) is
+ * kept as the change it made to the game, with the state of the random
+ * number generators after it. Changes and checksums are taken of the
+ * game as it serializes itself for play-by-mail, so a journal made on
+ * one machine replays on any other. Choices made during a mission are kept
+ * one by one.
+ *
+ * A replay applies the same changes at the same points, with no one
+ * at the controls, and checks the game against a checksum kept at the
+ * start of every turn.
+ */
+class GameJournal
+{
+public:
+    GameJournal();
+    ~GameJournal();
+
+    bool record(const std::string &path);
+    bool replay(const std::string &path);
+    bool recording() const;
+    bool replaying() const;
+
+    void recordStart();
+    bool startReplay();
+    bool turn(int turn);
+    int turnsChecked() const;
+    bool diverged() const;
+
+    void beginDecision();
+    void recordDecision(JournalEntryType type, char plr);
+    bool replayDecision(JournalEntryType type, char plr);
+    void recordChoice(char plr, int value);
+    int replayChoice(char plr, int otherwise);
+
+private:
+    void write(const struct JournalEntry &entry);
+    const struct JournalEntry *next(JournalEntryType type, char plr);
+
+    std::ofstream out;
+    std::vector<struct JournalEntry> entries;  // Being replayed
+    size_t position;
+    std::string before;     // The serialized game at the decision's start
+    int checked;
+    bool failed;
+
+    GameJournal(const GameJournal &);
+    GameJournal &operator=(const GameJournal &);
+};
+
+
+/**
+ * Plays back a human player's choices during a mission from the
+ * journal being replayed, showing nothing.
+ */
+class JournalView : public MissionView
+{
+public:
+    virtual char failure(char plr, int note, char *text);
+    virtual char moonWalker(char plr, char nauts, const struct MisEval &step);
+};
+
+
+int RunReplay(void);
+
+extern GAME_LOCAL GameJournal gameJournal;
+
+#endif // JOURNAL_H
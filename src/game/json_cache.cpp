@@ -0,0 +1,224 @@
+// This file handles the binary cache for deserialized JSON game data.
+
+#include "json_cache.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <zlib.h>
+
+#include "Buzz_inc.h"
+#include "gamedata.h"
+#include "logging.h"
+#include "options.h"
+
+
+LOG_DEFAULT_CATEGORY(filesys);
+
+
+namespace
+{
+// 'RISC' in little endian
+const uint32_t CACHE_MAGIC = 0x43534952;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t build;      /**< BuildHash() of the build that wrote it */
+    uint32_t typeSize;   /**< sizeof() the deserialized type */
+    uint32_t hash;       /**< CRC-32 of the JSON source */
+    uint32_t length;     /**< Length of the cached blob */
+};
+
+// No game data file comes near this; a longer blob is corrupt
+const uint32_t MAX_CACHE_LENGTH = 64 * 1024 * 1024;
+
+/* A checksum identifying the build, from when it was configured. */
+uint32_t BuildHash()
+{
+    static const char build[] = PACKAGE_VERSION " " PACKAGE_BUILD;
+    return crc32(0L, (const Bytef *)build, sizeof(build) - 1);
+}
+
+std::string CacheName(const char *name)
+{
+    return std::string(name) + ".cache";
+}
+
+std::string SavePath(const std::string &name)
+{
+    return std::string(options.dir_savegame) + "/" + name;
+}
+};
+
+
+/**
+ * Read a game data file into memory and compute its checksum.
+ *
+ * \param name  The file name, relative to the game data directory.
+ * \param source  Receives the file contents.
+ * \param hash  Receives the CRC-32 of the file contents.
+ * \return  false if the file could not be read.
+ */
+bool JsonCache::readSource(const char *name, std::string &source,
+                           uint32_t &hash)
+{
+    FILE *fin = sOpen(name, "rb", FT_DATA);
+
+    if (!fin) {
+        return false;
+    }
+
+    fseek(fin, 0, SEEK_END);
+    long length = ftell(fin);
+    rewind(fin);
+
+    if (length < 0) {
+        fclose(fin);
+        return false;
+    }
+
+    source.resize(length);
+    size_t bytes = fread(&source[0], 1, length, fin);
+    fclose(fin);
+
+    if (bytes != (size_t)length) {
+        return false;
+    }
+
+    hash = crc32(0L, (const Bytef *)source.data(), source.size());
+    return true;
+}
+
+
+/**
+ * Read the cached blob for a game data file, if it is up to date.
+ *
+ * \param name  The file name of the JSON source.
+ * \param hash  The CRC-32 of the current JSON source.
+ * \param typeSize  sizeof() the type the blob deserializes into.
+ * \param blob  Receives the cached data.
+ * \return  true if a valid cache entry was found.
+ */
+bool JsonCache::load(const char *name, uint32_t hash, uint32_t typeSize,
+                     std::string &blob)
+{
+    std::string cacheName = CacheName(name);
+    FILE *fin = sOpen(cacheName.c_str(), "rb", FT_SAVE_CHECK);
+
+    if (!fin) {
+        return false;
+    }
+
+    CacheHeader header;
+    bool ok = fread_uint32_t(&header.magic, 1, fin) == 1 &&
+              fread_uint32_t(&header.version, 1, fin) == 1 &&
+              fread_uint32_t(&header.build, 1, fin) == 1 &&
+              fread_uint32_t(&header.typeSize, 1, fin) == 1 &&
+              fread_uint32_t(&header.hash, 1, fin) == 1 &&
+              fread_uint32_t(&header.length, 1, fin) == 1;
+
+    if (!ok || header.magic != CACHE_MAGIC) {
+        fclose(fin);
+        reject(name, "bad header");
+        return false;
+    }
+
+    if (header.version != JSON_CACHE_VERSION || header.build != BuildHash() ||
+        header.typeSize != typeSize || header.hash != hash) {
+        fclose(fin);
+        DEBUG2("cache for `%s' is stale", name);
+        return false;
+    }
+
+    // Check the length against the file before allocating for it
+    long start = ftell(fin);
+    fseek(fin, 0, SEEK_END);
+    long end = ftell(fin);
+    fseek(fin, start, SEEK_SET);
+
+    if (start < 0 || header.length > MAX_CACHE_LENGTH ||
+        end - start != (long)header.length) {
+        fclose(fin);
+        reject(name, "bad length");
+        return false;
+    }
+
+    blob.resize(header.length);
+    ok = fread(&blob[0], 1, header.length, fin) == header.length;
+    fclose(fin);
+
+    if (!ok) {
+        reject(name, "truncated");
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Write the binary cache for a game data file.
+ *
+ * The cache is written to a temporary file and moved into place,
+ * so an interrupted write never leaves a partial cache behind.
+ * Failure to write the cache is not an error; the JSON source will
+ * simply be parsed again next time.
+ *
+ * \param name  The file name of the JSON source.
+ * \param hash  The CRC-32 of the JSON source.
+ * \param typeSize  sizeof() the type the blob deserializes into.
+ * \param blob  The serialized data.
+ */
+void JsonCache::store(const char *name, uint32_t hash, uint32_t typeSize,
+                      const std::string &blob)
+{
+    std::string cachePath = SavePath(CacheName(name));
+    std::string tempPath = temp_path(cachePath);
+    FILE *fout = fopen(tempPath.c_str(), "wb");
+
+    if (!fout) {
+        return;
+    }
+
+    CacheHeader header = {CACHE_MAGIC, JSON_CACHE_VERSION, BuildHash(),
+                          typeSize, hash, (uint32_t)blob.size()
+                         };
+    bool ok = fwrite_uint32_t(&header.magic, 1, fout) == 1 &&
+              fwrite_uint32_t(&header.version, 1, fout) == 1 &&
+              fwrite_uint32_t(&header.build, 1, fout) == 1 &&
+              fwrite_uint32_t(&header.typeSize, 1, fout) == 1 &&
+              fwrite_uint32_t(&header.hash, 1, fout) == 1 &&
+              fwrite_uint32_t(&header.length, 1, fout) == 1 &&
+              fwrite(blob.data(), 1, blob.size(), fout) == blob.size();
+
+    if (fclose(fout) != 0) {
+        ok = false;
+    }
+
+    if (!ok) {
+        WARNING2("can't write cache for `%s'", name);
+        remove(tempPath.c_str());
+        return;
+    }
+
+    int err = replace_file(tempPath, cachePath);
+
+    if (err != 0) {
+        WARNING3("can't replace cache for `%s': %s", name, strerror(err));
+        remove(tempPath.c_str());
+        return;
+    }
+
+    INFO2("rebuilt cache for `%s'", name);
+}
+
+
+/**
+ * Report a cache entry that could not be used.
+ */
+void JsonCache::reject(const char *name, const char *reason)
+{
+    WARNING3("ignoring cache for `%s': %s", name, reason);
+}
@@ -0,0 +1,120 @@
+#ifndef JSON_CACHE_H
+#define JSON_CACHE_H
+
+#include <stdint.h>
+
+#include <sstream>
+#include <string>
+
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
+
+#include "ioexception.h"
+
+
+/**
+ * Version of the binary cache layout.
+ *
+ * The cache stores the output of each struct's serialize() method.
+ * Caches are also tagged with the version and git description of
+ * the build that wrote them, so a new build never reads an old
+ * one's. This still has to be bumped when a serialize() method
+ * changes between builds with the same description, as in a
+ * modified working tree. Stale caches are silently rebuilt from
+ * the JSON source.
+ */
+#define JSON_CACHE_VERSION 2
+
+namespace JsonCache
+{
+bool readSource(const char *name, std::string &source, uint32_t &hash);
+bool load(const char *name, uint32_t hash, uint32_t typeSize,
+          std::string &blob);
+void store(const char *name, uint32_t hash, uint32_t typeSize,
+           const std::string &blob);
+void reject(const char *name, const char *reason);
+
+/**
+ * Reads the JSON document as a single top-level value.
+ *
+ * This is how DESERIALIZE_JSON_FILE reads its files.
+ */
+template<class T>
+struct Value {
+    static void read(cereal::JSONInputArchive &ar, T &x)
+    {
+        ar(x);
+    }
+};
+
+/**
+ * Reads the members of T directly from the top-level JSON object.
+ *
+ * Used for files holding several named values, such as the
+ * spaceport files.
+ */
+template<class T>
+struct Fields {
+    static void read(cereal::JSONInputArchive &ar, T &x)
+    {
+        x.serialize(ar);
+    }
+};
+};
+
+
+/**
+ * Deserialize a JSON game data file, using a precompiled binary cache.
+ *
+ * The JSON file in the game data directory remains the source of
+ * truth. A binary copy of the deserialized object is kept in the
+ * save directory as "<name>.cache", tagged with a checksum of the
+ * JSON source. If the checksum still matches, the object is read
+ * from the binary copy; otherwise the JSON is parsed and the cache
+ * is rewritten.
+ *
+ * With the default Layout this is a drop-in replacement for
+ * DESERIALIZE_JSON_FILE.
+ *
+ * \param x     Pointer to the object to deserialize into.
+ * \param name  The file name, relative to the game data directory.
+ * \throws IOException  if the JSON source cannot be read.
+ */
+template<class T, class Layout = JsonCache::Value<T> >
+void DeserializeCachedJSON(T *x, const char *name)
+{
+    std::string source;
+    uint32_t hash;
+
+    if (!JsonCache::readSource(name, source, hash)) {
+        throw IOException(std::string("Could not open ") + name);
+    }
+
+    std::string blob;
+
+    if (JsonCache::load(name, hash, sizeof(T), blob)) {
+        try {
+            std::istringstream is(blob);
+            cereal::PortableBinaryInputArchive iarchive(is);
+            iarchive(*x);
+            return;
+        } catch (const std::exception &e) {
+            JsonCache::reject(name, e.what());
+        }
+    }
+
+    {
+        std::istringstream is(source);
+        cereal::JSONInputArchive iarchive(is);
+        Layout::read(iarchive, *x);
+    }
+
+    std::ostringstream os;
+    {
+        cereal::PortableBinaryOutputArchive oarchive(os);
+        oarchive(*x);
+    }
+    JsonCache::store(name, hash, sizeof(T), os.str());
+}
+
+#endif // JSON_CACHE_H
@@ -40,7 +40,9 @@
 #include "records.h"
 #include "state_utils.h"
 #include "game_main.h"
+#include "journal.h"
 #include "mis_c.h"
+#include "mission_odds.h"
 #include "mission_util.h"
 #include "sdlhelper.h"
 #include "pace.h"
@@ -49,26 +51,28 @@
 #include "data.h"
 #include "pbm.h"
 
-Equipment *MH[2][8];   // Pointer to the hardware
-struct MisAst MA[2][4];  //[2][4]
-struct MisEval Mev[60];  // was *Mev;
-REPLAY Rep;
-
-char tMen;
-
-char MANNED[2];
-char CAP[2];
-char LM[2];
-char DOC[2];
-char EVA[2];
-char STEP;
-char FINAL;
-char JOINT;
-char PastBANG;
-char mcc;
-char fEarly; /**< kind of a boolean indicating early missions */
-char hero;
-char DMFake;
+LOG_DEFAULT_CATEGORY(mission)
+
+GAME_LOCAL Equipment *MH[2][8];   // Pointer to the hardware
+GAME_LOCAL struct MisAst MA[2][4];  //[2][4]
+GAME_LOCAL struct MisEval Mev[60];  // was *Mev;
+GAME_LOCAL REPLAY Rep;
+
+GAME_LOCAL char tMen;
+
+GAME_LOCAL char MANNED[2];
+GAME_LOCAL char CAP[2];
+GAME_LOCAL char LM[2];
+GAME_LOCAL char DOC[2];
+GAME_LOCAL char EVA[2];
+GAME_LOCAL char STEP;
+GAME_LOCAL char FINAL;
+GAME_LOCAL char JOINT;
+GAME_LOCAL char PastBANG;
+GAME_LOCAL char mcc;
+GAME_LOCAL char fEarly; /**< kind of a boolean indicating early missions */
+GAME_LOCAL char hero;
+GAME_LOCAL char DMFake;
 /* STEP tracks mission step numbers             */
 /* FINAL is the ultimate result of safety check */
 /* JOINT signals the joint mission code         */
@@ -112,65 +116,20 @@ void SetW(char ch)
     Mev[i].Name[2] = ch;
 }
 
-int Launch(char plr, char mis)
+/**
+ * Set up a mission for resolution: assign its hardware and crew,
+ * lay out its steps in Mev, and apply the mission penalties.
+ *
+ * MANNED and JOINT must already be set for the mission, and Mev and
+ * MH cleared.
+ *
+ * \param plr  The player flying the mission.
+ * \param mis  The launch pad of the mission.
+ * \return  the mission plan, with Days set to the mission's duration.
+ */
+struct mStr StageMission(char plr, char mis)
 {
-    int i, j, t, k, mcode, avg, spResult, temp = 0;
-    char total;
-    STEP = FINAL = JOINT = PastBANG = 0;
-    tMen = 0x00; // clear mission status flags
-
-    // Don't do missions twice, just update prestige data
-    if ((MAIL == 1 && plr == 0) || (MAIL == 2 && plr == 1)) {
-        STEPnum = Data->Step[mis];
-        memcpy(Mev, Data->Mev[mis], 60 * sizeof(struct MisEval));
-        // Check for Mission death
-        spResult = Data->P[plr].History[Data->P[plr].PastMissionCount].spResult;
-
-        if (spResult >= 3000 && spResult < 5000) {
-            death = 1;
-        } else {
-            death = 0;
-        }
-
-        MANNED[0] = Data->P[plr].Mission[mis].Men;
-        MANNED[1] = Data->P[plr].Mission[mis].Joint ? Data->P[plr].Mission[mis + 1].Men : 0;
-
-        return Update_Prestige_Data(
-                   plr, mis, Data->P[plr].Mission[mis].MissionCode);
-    }
-
-    remove_savedat("REPLAY.TMP");  // make sure replay buffer isn't there
-
-    if (Data->P[plr].Mission[mis].part == 1) {
-        return 0;
-    }
-
-    memset(buffer, 0x00, BUFFER_SIZE); // Clear Buffer
-    memset(MH, 0x00, sizeof MH);
-    memset(Mev, 0x00, sizeof Mev);
-
-    if (Data->P[plr].Mission[mis].MissionCode == Mission_SubOrbital) {
-        Data->P[plr].Mission[mis].Duration = 1;
-    }
-
-    MANNED[0] = Data->P[plr].Mission[mis].Men;
-    MANNED[1] = Data->P[plr].Mission[mis].Joint ? Data->P[plr].Mission[mis + 1].Men : 0;
-
-    JOINT = Data->P[plr].Mission[mis].Joint;
-
-    temp = CheckCrewOK(plr, mis);
-
-    if (temp == 1) { // found mission no crews
-        ScrubMission(plr, mis - Data->P[plr].Mission[mis].part);
-    }
-
-    if (!AI[plr] && Data->P[plr].Mission[mis].MissionCode) {
-        MisAnn(plr, mis);
-    }
-
-    if (Data->P[plr].Mission[mis].MissionCode == Mission_None) {
-        return -20;
-    }
+    int i, j, t, k, mcode, total;
 
     MissionSetup(plr, mis);
 
@@ -286,6 +245,86 @@ int Launch(char plr, char mis)
     MisRush(plr, Data->P[plr].Mission[mis].Rushing);
     STEPnum = 0;
 
+    return misType;
+}
+
+
+int Launch(char plr, char mis)
+{
+    int i, j, mcode, avg, spResult, temp = 0;
+    char total;
+    STEP = FINAL = JOINT = PastBANG = 0;
+    tMen = 0x00; // clear mission status flags
+
+    // Don't do missions twice, just update prestige data
+    if ((MAIL == 1 && plr == 0) || (MAIL == 2 && plr == 1)) {
+        STEPnum = Data->Step[mis];
+        memcpy(Mev, Data->Mev[mis], 60 * sizeof(struct MisEval));
+        // Check for Mission death
+        spResult = Data->P[plr].History[Data->P[plr].PastMissionCount].spResult;
+
+        if (spResult >= 3000 && spResult < 5000) {
+            death = 1;
+        } else {
+            death = 0;
+        }
+
+        MANNED[0] = Data->P[plr].Mission[mis].Men;
+        MANNED[1] = Data->P[plr].Mission[mis].Joint ? Data->P[plr].Mission[mis + 1].Men : 0;
+
+        return Update_Prestige_Data(
+                   plr, mis, Data->P[plr].Mission[mis].MissionCode);
+    }
+
+    remove_savedat("REPLAY.TMP");  // make sure replay buffer isn't there
+
+    if (Data->P[plr].Mission[mis].part == 1) {
+        return 0;
+    }
+
+    memset(buffer, 0x00, BUFFER_SIZE); // Clear Buffer
+    memset(MH, 0x00, sizeof MH);
+    memset(Mev, 0x00, sizeof Mev);
+
+    if (Data->P[plr].Mission[mis].MissionCode == Mission_SubOrbital) {
+        Data->P[plr].Mission[mis].Duration = 1;
+    }
+
+    MANNED[0] = Data->P[plr].Mission[mis].Men;
+    MANNED[1] = Data->P[plr].Mission[mis].Joint ? Data->P[plr].Mission[mis + 1].Men : 0;
+
+    JOINT = Data->P[plr].Mission[mis].Joint;
+
+    if (!AI[plr] && gameJournal.replaying()) {
+        // Go ahead with the mission as the player did
+        gameJournal.replayDecision(JOURNAL_Staging, plr);
+    } else {
+        if (!AI[plr]) {
+            gameJournal.beginDecision();
+        }
+
+        temp = CheckCrewOK(plr, mis);
+
+        if (temp == 1) { // found mission no crews
+            ScrubMission(plr, mis - Data->P[plr].Mission[mis].part);
+        }
+
+        if (!AI[plr] && Data->P[plr].Mission[mis].MissionCode) {
+            MisAnn(plr, mis);
+        }
+
+        if (!AI[plr]) {
+            gameJournal.recordDecision(JOURNAL_Staging, plr);
+        }
+    }
+
+    if (Data->P[plr].Mission[mis].MissionCode == Mission_None) {
+        return -20;
+    }
+
+    struct mStr misType = StageMission(plr, mis);
+    mcode = Data->P[plr].Mission[mis].MissionCode;
+
     if (!AI[plr] && !fullscreenMissionPlayback) {
         DrawControl(plr);
         FadeIn(2, 10, 0, 0);
@@ -335,6 +374,12 @@ int Launch(char plr, char mis)
     }
 
 
+    if (LOG_ISENABLED(mission, LP_DEBUG)) {
+        const struct MissionOdds odds = StagedMissionOdds(plr, mis);
+        DEBUG5("mission odds: success %.3f partial %.3f failure %.3f crew loss %.3f",
+               odds.success, odds.partial, odds.failure, odds.crewLoss);
+    }
+
     MisCheck(plr, mis); // Mission Resolution
 
     xMODE &= ~xMODE_EASYMODE;
@@ -491,19 +536,19 @@ void MissionPast(char plr, char pad, int prest)
                             if (miscode < 44) {
                                 nd = 8;  // Duration = 8 days
                             } else if (miscode < 44 || miscode == 46 || miscode == 48 || miscode == 50)  {
-                                nd = 8 + brandom(4);  // Random 8-11 days for single lunar orbitals
+                                nd = 8 + brandom(4, RNG_Mission);  // Random 8-11 days for single lunar orbitals
                             } else {
-                                nd = 9 + brandom(4);  // Random 9-12 days for Jt lunar orbitals or any lunar landing
+                                nd = 9 + brandom(4, RNG_Mission);  // Random 9-12 days for Jt lunar orbitals or any lunar landing
                             }
 
                             break;
 
                         case 16:  // Duration E
-                            nd = 13 + brandom(4);  // Random 13-16 days for any Dur E
+                            nd = 13 + brandom(4, RNG_Mission);  // Random 13-16 days for any Dur E
                             break;
 
                         case 20:  // Duration F
-                            nd = 17 + brandom(4);  // Random 17-20 days for any Dur F
+                            nd = 17 + brandom(4, RNG_Mission);  // Random 17-20 days for any Dur F
                             break;
                         }
                     }
@@ -40,7 +40,7 @@
 LOG_DEFAULT_CATEGORY(LOG_ROOT_CAT)
 
 int CrewEndurance(const struct MisAst *crew, size_t crewSize);
-void MissionParse(char plr, struct mStr &misType, char pad);
+void MissionParse(char plr, const struct mStr &misType, char pad);
 char WhichPart(char plr, int which);
 void MissionSteps(char plr, int mcode, int step, int pad,
                   const struct mStr &mission);
@@ -63,7 +63,7 @@ void MissionSteps(char plr, int mcode, int step, int pad,
  */
 void MissionCodes(char plr, char val, char pad)
 {
-    struct mStr plan = GetMissionPlan(val);
+    const struct mStr &plan = GetMissionPlan(val);
     MissionParse(plr, plan, pad);
     return;
 }
@@ -85,7 +85,7 @@ int CrewEndurance(const struct MisAst *crew, size_t crewSize)
 
 
 void
-MissionParse(char plr, struct mStr &misType, char pad)
+MissionParse(char plr, const struct mStr &misType, char pad)
 {
     int i, loc, j;
 
@@ -523,10 +523,10 @@ void MissionSteps(char plr, int mcode, int step, int pad,
         if ((Data->Def.Lev1 == 0 && plr == 0) || (Data->Def.Lev2 == 0 && plr == 1)) {
             Mev[step].dice = MisRandom();
         } else {
-            Mev[step].dice = brandom((AI[plr]) ? 98 : 100) + 1;
+            Mev[step].dice = brandom((AI[plr]) ? 98 : 100, RNG_Mission) + 1;
         }
 
-        Mev[step].rnum = brandom(10000) + 1;
+        Mev[step].rnum = brandom(10000, RNG_Mission) + 1;
         Mev[step].sgoto = 0;
 
         // prevents mission looping
@@ -731,7 +731,7 @@ void MissionSetup(char plr, char mis)
 {
     char i, j, t;
     DMFake = 0;
-    const struct mStr plan =
+    const struct mStr &plan =
         GetMissionPlan(Data->P[plr].Mission[mis].MissionCode);
 
     for (j = 0; j < (1 + Data->P[plr].Mission[mis].Joint); j++) {
@@ -29,6 +29,7 @@
 
 #include <cassert>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
@@ -38,11 +39,15 @@
 
 #include "gamedata.h"
 #include "Buzz_inc.h"
+#include "asset_index.h"
+#include "asset_registry.h"
+#include "babypics.h"
 #include "bzanim.h"
 #include "draw.h"
 #include "mmfile.h"
 #include "utils.h"
 #include "game_main.h"
+#include "journal.h"
 #include "mc.h"
 #include "mis_m.h"
 #include "sdlhelper.h"
@@ -87,23 +92,35 @@ struct BZFileHeader {
 };
 
 
-std::vector<struct BZFileHeader> indexEntry(41);    
-std::vector<struct AnimType> header(41);
+// The animations from LIFTOFF.ABZ, as listed in liftoff.json
+struct LiftoffIndex {
+    std::vector<struct BZFileHeader> indexEntry;
+    std::vector<struct AnimType> header;
+
+    template <class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(CEREAL_NVP(indexEntry));
+        ar(CEREAL_NVP(header));
+    }
+};
+
 std::vector<boost::shared_ptr<display::Surface>> animCache;
+int animCacheIndex = -1;
 boost::shared_ptr<display::Surface> equipAnim;
 int frameCounter = 0;
 
-char SHTS[4];
-char STEPnum;
+GAME_LOCAL char SHTS[4];
+GAME_LOCAL char STEPnum;
 char daysAMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
 
 void Tick(char plr);
+int MCGraph(char plr, int lc, int safety, int val, char prob);
 void Clock(char plr, int clock, int mode, int time);
-void DoPack(char plr, FILE *ffin, char mode, char *cde, char *fName,
+void DoPack(char plr, char mode, char *cde, char *fName,
             const std::vector<struct Infin> &Mob,
             const std::vector<struct OF> &Mob2);
 void GuyDisp(int xa, int ya, struct Astros *Guy);
-char DrawMoonSelection(char plr, char nauts, const struct MisEval &step);
 BZAnimation::Ptr FindHardwareAnim(char plr, const struct MisEval &step);
 int ImportInfin(FILE *fin, struct Infin &target);
 int ImportOF(FILE *fin, struct OF &target);
@@ -112,53 +129,41 @@ std::string getEquipAnimID(char plr, const struct MisEval &step);
 int getEquipAnimIndex(std::string name);
 void loadFrames(int index);
 void playEquipAnim (int index);
-void loadHeader();
-void loadIndexEntry();
+const struct LiftoffIndex &GetLiftoffIndex();
 
 
-/** Finds the video fitting to the current mission step and plays it.
+/** Finds the video fitting to the current mission step.
  *
- * The function does handle variations for the videos
- * and also finds the proper babypics to display.
+ * The function does handle variations for the videos, and records
+ * the choice for the mission replay. Some steps also have their
+ * failure code corrected here.
  *
  * \param plr Player structure
  * \param step Missions step ID
  * \param Seq Sequence-Code for the movies (Mev[STEP].Name + XFails.fail)
  * \param mode mode 1 branches to fseq.dat so it's probably failure. However mode 2 is defined by a female 'naut's presence
+ * \param pick  the chosen sequence.
+ * \return  false if there is nothing to show for the step.
  */
-void PlaySequence(char plr, int step, const char *InSeq, char mode)
+bool PickSequence(char plr, int step, const char *InSeq, char mode,
+                  struct StepSequence &pick)
 {
-    //DEBUG1("->PlaySequence()");
-    DEBUG4("->PlaySequence(plr, step %d, Seq %s, mode %d)", step, InSeq, mode);
-    int keep_going;
-    int i, j, k;
+    DEBUG4("->PickSequence(plr, step %d, Seq %s, mode %d)", step, InSeq, mode);
+    int j;
     unsigned int max;
-    char lnch = 0;
-    char AEPT, BABY, Tst2, Tst3;
-    unsigned char sts = 0, fem = 0;
-    FILE *ffin, *nfin;
+    char Tst2, Tst3;
+    unsigned char fem = 0;
     char err = 0;
-    mm_file vidfile;
-    FILE *mmfp;
-    float fps;
-    int hold_count;
-    std::vector<struct Infin> Mob;
-    std::vector<struct OF> Mob2;
     std::string ID;
 
     // since Seq apparently needs to be mutable, copy the input parameter
-    char Seq[128];
-    strncpy(Seq, InSeq, sizeof(Seq));
-
-    i = j = k = 0; /* XXX check uninitialized */
+    char *Seq = pick.seq;
+    strntcpy(Seq, InSeq, sizeof(pick.seq));
 
-    SHTS[0] = brandom(10);
-    SHTS[1] = brandom(10);
-    SHTS[2] = brandom(10);
-    SHTS[3] = brandom(10);
+    j = 0; /* XXX check uninitialized */
 
     if (fEarly && step != 0) {
-        return;    //Specs: unmanned mission cut short
+        return false;    //Specs: unmanned mission cut short
     }
 
     //Specs: female 'naut kludge
@@ -236,74 +241,28 @@ void PlaySequence(char plr, int step, const char *InSeq, char mode)
         }
     }
 
-    //Specs: launch sync
-    if (Seq[0] == '#') {
-        lnch = 1;
-    } else {
-        lnch = 0;
-    }
-
-    if (Seq[0] == 'A' || Seq[0] == 'E' || Seq[0] == 'P' || Seq[0] == 'T' || Seq[0] == '#') {
-        AEPT = 1;
-    } else {
-        AEPT = 0;
-    }
-
-    if (mode == 1) {
-
-        /* i: the first element in fSeq belonging to the right step */
-        for (i = 0; i < Assets->fSeq.size(); i++) {
-            if (strncmp(Assets->fSeq.at(i).MissionStep.c_str(), Mev[step].FName, 4) == 0) {
-                break;
-            }
-        }
-
-        if (i == Assets->fSeq.size()) {
-            err = 1;
-        }
-
-    }
-
     if (mode == 0) {
-        j = 0;
-        ID = Assets->sSeq.at(j).MissionIdSequence;
+        j = FindSuccessSequence(Seq);
 
-        while (strncmp(&ID[3], Seq, strlen(&ID[3])) != 0) {
-            j++;
-
-            if (j == Assets->sSeq.size()) {
-                err = 1;
-                break;
-            } else {
-                ID = Assets->sSeq.at(j).MissionIdSequence;
-            }
-        }
+        if (j < 0) {
+            err = 1;
+        } else {
+            ID = Assets->sSeq.at(j).MissionIdSequence;
 
-        if (ID[2] - 0x30 == 1) {
-            if (fem == 0) {
-                j++;
-                ID = Assets->sSeq.at(j).MissionIdSequence;
+            if (ID[2] - 0x30 == 1) {
+                if (fem == 0) {
+                    j++;
+                    ID = Assets->sSeq.at(j).MissionIdSequence;
+                }
             }
         }
-    } else if (err == 0) {
-        j = i;
-        ID = Assets->fSeq.at(j).MissionIdSequence;
-
-        while (strncmp(&ID[3], Seq, strlen(&ID[3])) != 0) {
-            j++;
+    } else {
+        j = FindFailureSequence(Mev[step].FName, Seq);
 
-            if (j == Assets->fSeq.size()) {
-                err = 1;
-                break;
-            } else {
-                if (strncmp(Assets->fSeq.at(j).MissionStep.c_str(), Mev[step].FName, 4) != 0) {
-                    // j is already entering the next MissionStep
-                    err = 1;
-                    break;
-                } else {
-                    ID = Assets->fSeq.at(j).MissionIdSequence;
-                }
-            }
+        if (j < 0) {
+            err = 1;
+        } else {
+            ID = Assets->fSeq.at(j).MissionIdSequence;
         }
     }
 
@@ -326,25 +285,67 @@ void PlaySequence(char plr, int step, const char *InSeq, char mode)
         }
     }
 
-    BABY = 0;
-
-    if (mode == 0) {
-        if (j >= 1 && j <= 22) {
-            BABY = 1;
-        }
-    }
-
     if (mode == 0) {
         interimData.tempReplay.at((plr * 100) + Data->P[plr].PastMissionCount).push_back({false, ID});
     } else {
         interimData.tempReplay.at((plr * 100) + Data->P[plr].PastMissionCount).push_back({true, ID});
     }
 
-    if (AI[plr] == 1) {
+    pick.id = ID;
+    pick.entry = j;
+    pick.mode = mode;
+
+    return true;
+}
+
+
+/** Plays a sequence chosen by PickSequence().
+ *
+ * The function also finds the proper babypics to display.
+ *
+ * \param plr Player structure
+ * \param pick  the sequence to play.
+ */
+void ShowSequence(char plr, const struct StepSequence &pick)
+{
+    DEBUG2("->ShowSequence(plr, ID %s)", pick.id.c_str());
+    int keep_going;
+    int i, j, k;
+    unsigned int max;
+    char lnch, AEPT, BABY;
+    char mode = pick.mode;
+    unsigned char sts = 0;
+    FILE *nfin;
+    mm_file vidfile;
+    FILE *mmfp;
+    float fps;
+    int hold_count;
+    std::vector<struct Infin> Mob;
+    std::vector<struct OF> Mob2;
+    const std::string &ID = pick.id;
+    char Seq[sizeof(pick.seq)];
+    strntcpy(Seq, pick.seq, sizeof(Seq));
+
+    SHTS[0] = brandom(10, RNG_Cosmetic);
+    SHTS[1] = brandom(10, RNG_Cosmetic);
+    SHTS[2] = brandom(10, RNG_Cosmetic);
+    SHTS[3] = brandom(10, RNG_Cosmetic);
+
+    if (presentation_speed() == PRESENT_INSTANT) {
         return;
     }
 
-    ffin = open_gamedat("BABYPICX.CDR");
+    //Specs: launch sync
+    lnch = (Seq[0] == '#') ? 1 : 0;
+
+    if (Seq[0] == 'A' || Seq[0] == 'E' || Seq[0] == 'P' || Seq[0] == 'T' || Seq[0] == '#') {
+        AEPT = 1;
+    } else {
+        AEPT = 0;
+    }
+
+    j = pick.entry;
+    BABY = (mode == 0 && j >= 1 && j <= 22) ? 1 : 0;
 
     if (AEPT && !mode) {
         // BABYCLIF.CDR consists of two tables:
@@ -493,7 +494,7 @@ void PlaySequence(char plr, int step, const char *InSeq, char mode)
 
             if (sts < 23) {
                 if (BABY == 0 && !fullscreenMissionPlayback) {
-                    DoPack(plr, ffin, (AEPT && !mode) ? 1 : 0, Seq,
+                    DoPack(plr, (AEPT && !mode) ? 1 : 0, Seq,
                            seq_name, Mob, Mob2);
                 }
 
@@ -549,11 +550,10 @@ void PlaySequence(char plr, int step, const char *InSeq, char mode)
         }
     }
 
-    fclose(ffin);  // Specs: babypicx.cdr
     mm_close(&vidfile);
     display::graphics.videoRect().h = 0;
     display::graphics.videoRect().w = 0;
-    DEBUG1("<-PlaySequence()");
+    DEBUG1("<-ShowSequence()");
 }
 
 
@@ -659,13 +659,12 @@ void Clock(char plr, int clock, int mode, int time)
     }
 }
 
-void DoPack(char plr, FILE *ffin, char mode, char *cde, char *fName,
+void DoPack(char plr, char mode, char *cde, char *fName,
             const std::vector<struct Infin> &Mob,
             const std::vector<struct OF> &Mob2)
 {
     int x, y, attempt, which, mx2, mx1;
-    uint16_t *bot, off = 0;
-    int32_t locl;
+    uint16_t off = 0;
     static char kk = 0, bub = 0;
     char Val1[12], Val2[12], loc;
 
@@ -698,7 +697,7 @@ void DoPack(char plr, FILE *ffin, char mode, char *cde, char *fName,
             loc = (SHTS[1] > SHTS[3]) ? 1 : 3 ;
         }
 
-        SHTS[loc] = brandom(3);
+        SHTS[loc] = brandom(3, RNG_Cosmetic);
         kk = loc;
         return;
     }
@@ -709,11 +708,6 @@ void DoPack(char plr, FILE *ffin, char mode, char *cde, char *fName,
 
     off = 64 + loc * 16;
 
-    // TODO: Rename variable to indicate purpose.
-    display::LegacySurface boob(68, 46);
-
-    bot = (uint16_t *) boob.pixels();
-
     //:::::::::::::::::::::::::::::::
     //Specs: which holds baby frame :
     //:::::::::::::::::::::::::::::::
@@ -736,7 +730,7 @@ void DoPack(char plr, FILE *ffin, char mode, char *cde, char *fName,
         }
 
         if (attempt >= SCND_TABLE || attempt >= Mob2.size()) {
-            which = 415 + brandom(25);
+            which = 415 + brandom(25, RNG_Cosmetic);
         } else {
             if (Val1[0] != '#') {
                 switch (Mob2[attempt].idx) {
@@ -789,7 +783,7 @@ void DoPack(char plr, FILE *ffin, char mode, char *cde, char *fName,
                     break;
 
                 default:
-                    which = 415 + brandom(25);
+                    which = 415 + brandom(25, RNG_Cosmetic);
                 }
             }
 
@@ -810,9 +804,9 @@ void DoPack(char plr, FILE *ffin, char mode, char *cde, char *fName,
                 }
 
                 if (attempt >= CLIF_TABLE || attempt >= Mob.size()) {
-                    which = 415 + brandom(25);
+                    which = 415 + brandom(25, RNG_Cosmetic);
                 } else {
-                    which = brandom(Mob[attempt].Qty);
+                    which = brandom(Mob[attempt].Qty, RNG_Cosmetic);
 
                     if (which >= 10) {
                         which = Mob[attempt].List[which % 10];
@@ -839,9 +833,9 @@ void DoPack(char plr, FILE *ffin, char mode, char *cde, char *fName,
         }
 
         if (attempt >= NORM_TABLE || attempt >= Mob.size()) {
-            which = 415 + brandom(25);
+            which = 415 + brandom(25, RNG_Cosmetic);
         } else {
-            which = brandom(Mob[attempt].Qty);
+            which = brandom(Mob[attempt].Qty, RNG_Cosmetic);
 
             if (which >= 10) {
                 which = Mob[attempt].List[which % 10];
@@ -853,7 +847,11 @@ void DoPack(char plr, FILE *ffin, char mode, char *cde, char *fName,
     }
 
     //Specs: which holds baby num
-    locl = (int32_t) 1612 * which;
+    const struct BabyPic *pic = GetBabyPic(which);
+
+    if (pic == NULL) {
+        return;
+    }
 
     if (which < 580) {
         display::AutoPal p(display::graphics.legacyScreen());
@@ -864,26 +862,14 @@ void DoPack(char plr, FILE *ffin, char mode, char *cde, char *fName,
         VBlank();
     }
 
-    fseek(ffin, (int32_t)locl, SEEK_SET);
     {
         display::AutoPal p(display::graphics.legacyScreen());
-        fread(&p.pal[off * 3], 48, 1, ffin);
-    }
-    fread(boob.pixels(), 1564, 1, ffin);
-
-    for (int i = 0; i < 782; i++) {
-        bot[i + 782] = ((bot[i] & 0xF0F0) >> 4);
-        bot[i] = (bot[i] & 0x0F0F);
-    }
-
-    for (int i = 0; i < 1564; i++) {
-        boob.pixels()[i] += off;
-        boob.pixels()[1564 + i] += off;
+        memcpy(&p.pal[off * 3], pic->palette, sizeof pic->palette);
     }
 
     VBlank();
 
-    boob.copyTo(display::graphics.legacyScreen(), x, y);
+    DrawBabyPic(*pic, x, y, off);
 
     VBlank();
 }
@@ -1146,9 +1132,6 @@ char FailureMode(char plr, int prelim, char *text)
 
     // Place Image Here
     
-    // Deserialize header
-    loadHeader();
-
     //BZAnimation::Ptr modelAnim = FindHardwareAnim(plr, Mev[STEP]);
     
     std::string ID = getEquipAnimID(plr, Mev[STEP]);
@@ -1226,48 +1209,273 @@ char FailureMode(char plr, int prelim, char *text)
 }
 
 
-void FirstManOnMoon(char plr, char isAI, char misNum,
-                    const struct MisEval &step)
+MissionScreen::MissionScreen()
+    : lc(0)
+{
+}
+
+
+/* Set up the safety chart and the mission clock. */
+void MissionScreen::start(char plr)
+{
+    int i;
+
+    if (fullscreenMissionPlayback) {
+        return;
+    }
+
+    //FadeOut(1,pal,100,128,1);
+    if (plr == 1) {
+        fill_rectangle(189, 173, 249, 196, 55);
+
+        for (i = 190; i < 250; i += 2) {
+            display::graphics.legacyScreen()->setPixel(i, 178, 61);
+            display::graphics.legacyScreen()->setPixel(i, 184, 61);
+            display::graphics.legacyScreen()->setPixel(i, 190, 61);
+        }
+
+        lc = 191;
+    } else if (plr == 0) {
+        fill_rectangle(73, 173, 133, 196, 55);
+
+        for (i = 73; i < 133; i += 2) {
+            display::graphics.legacyScreen()->setPixel(i, 178, 61);
+            display::graphics.legacyScreen()->setPixel(i, 184, 61);
+            display::graphics.legacyScreen()->setPixel(i, 190, 61);
+        }
+
+        lc = 76;
+    }
+
+    Tick(2);
+}
+
+
+/* Label the launch countdown. */
+void MissionScreen::countdown(char plr, int step)
 {
-    int nautsOnMoon = 0;
-    Equipment *e = GetEquipment(step);
+    display::graphics.setForegroundColor(11);
 
-    dayOnMoon = brandom(daysAMonth[Data->P[plr].Mission[step.pad].Month]) + 1;
+    if (fullscreenMissionPlayback) {
+        return;
+    }
 
-    if (misNum == Mission_Soyuz_LL && plr == 1) {
-        nautsOnMoon = 3;
+    if (plr == 0) {
+        x = 5;
+        y = 112;
+        fill_rectangle(2, 107, 140, 115, 3);
+    } else {
+        x = 82, y = 8;
+        fill_rectangle(78, 2, 241, 10, 3);
     }
 
-    //Direct Ascent
-    if (strcmp(e->Name, Data->P[plr].Manned[MANNED_HW_FOUR_MAN_CAPSULE].Name) == 0) {
-        nautsOnMoon = 4;
+    draw_string(x, y, "COUNTDOWN");
+
+    if (plr == 0) {
+        fill_rectangle(188, 107, 294, 113, 3);
+        display::graphics.setForegroundColor(1);
+        draw_string(190, 112, (Mev[step].pad == 0) ? "PRIMARY LAUNCH" : "SECOND LAUNCH");
+    } else {
+        fill_rectangle(244, 56, 314, 62, 3);
+        display::graphics.setForegroundColor(1);
+        draw_string(246, 61, (Mev[step].pad == 0) ? "PRIMARY PAD" : "SECOND PAD");
+    }
+}
+
+
+/* Draw Mission Step Name */
+void MissionScreen::stepName(char plr, int step)
+{
+    if (fullscreenMissionPlayback || (fEarly && step != 0)) {
+        return;
+    }
+
+    if (plr == 0) {
+        x = 5;
+        y = 112;
+        fill_rectangle(2, 107, 140, 115, 3);
+    } else {
+        x = 82, y = 8;
+        fill_rectangle(78, 2, 241, 10, 3);
+    }
+
+    display::graphics.setForegroundColor(11);
+    MisStep(x, y, Mev[step].loc);
+
+    if (plr == 0) {
+        fill_rectangle(188, 107, 294, 113, 3);
+        display::graphics.setForegroundColor(1);
+        draw_string(190, 112, (Mev[step].pad == 0) ? "PRIMARY LAUNCH" : "SECOND LAUNCH");
+    } else {
+        fill_rectangle(244, 56, 314, 62, 3);
+        display::graphics.setForegroundColor(1);
+        draw_string(246, 61, (Mev[step].pad == 0) ? "PRIMARY PAD" : "SECOND PAD");
     }
+}
+
 
-    //2 men LL
-    if (strcmp(e->Name, Data->P[plr].Manned[MANNED_HW_TWO_MAN_MODULE].Name) == 0) {
-        nautsOnMoon = 2;
+/* Add the step's roll to the safety chart. */
+void MissionScreen::roll(char plr, const StepOutcome &outcome)
+{
+    if (fullscreenMissionPlayback || (fEarly && outcome.step != 0)) {
+        return;
     }
 
-    //1 man LL
-    if (strcmp(e->Name, Data->P[plr].Manned[MANNED_HW_ONE_MAN_MODULE].Name) == 0) {
-        nautsOnMoon = 1;
+    lc = MCGraph(plr, lc, MAX(0, outcome.safety), MAX(0, outcome.dice),
+                 outcome.problem);
+}
+
+
+void MissionScreen::sequence(char plr, const StepSequence &seq)
+{
+    ShowSequence(plr, seq);
+}
+
+
+char MissionScreen::failure(char plr, int note, char *text)
+{
+    while (bioskey(1)) {
+        bioskey(0);
     }
 
+    key = 0;
 
-    if (nautsOnMoon == 1) {
-        manOnMoon = 2;
+    char choice = FailureMode(plr, note, text);
+    gameJournal.recordChoice(plr, choice);
+    return choice;
+}
+
+
+char MissionScreen::moonWalker(char plr, char nauts,
+                               const struct MisEval &step)
+{
+    char choice = DrawMoonSelection(plr, nauts, step);
+    gameJournal.recordChoice(plr, choice);
+    return choice;
+}
+
+
+/* Clear the step labels ahead of the funeral. */
+void MissionScreen::crewLost(char plr)
+{
+    if (fullscreenMissionPlayback) {
         return;
     }
 
-    if (!AI[plr]) {
-        manOnMoon = DrawMoonSelection(plr, nautsOnMoon, step);
+    display::AutoPal p(display::graphics.legacyScreen());
+    memset(&p.pal[64 * 3], 0x00, 64 * 3);  //Specs: 0x08
+
+    if (plr == 0) {
+        fill_rectangle(2, 107, 140, 115, 3);
     } else {
-        manOnMoon = brandom(nautsOnMoon) + 1;
+        fill_rectangle(78, 2, 241, 10, 3);
     }
 
-    EVA[0] = EVA[1] = manOnMoon - 1;
+    if (plr == 0) {
+        fill_rectangle(188, 107, 294, 113, 3);
+    } else {
+        fill_rectangle(244, 56, 314, 62, 3);
+    }
+}
 
-    return;
+
+void MissionScreen::finish(char plr)
+{
+    delay(1000);
+}
+
+
+/** Draw mission step rectangle
+ *
+ * The rectangle represents the success or failure rate.
+ *
+ * \param plr Player data
+ * \param lc ??? maybe location of the chart
+ * \param safety Safety factor in percent
+ * \param val value of the dice checked against safety
+ * \param prob is this a problem or not?
+ *
+ * \return new value of lc
+ */
+int MCGraph(char plr, int lc, int safety, int val, char prob)
+{
+    int i;
+    TRACE5("->MCGraph(plr, lc %d, safety %d, val %d, prob %c)", lc, safety, val, prob);
+    fill_rectangle(lc - 2, 195, lc, 195 - safety * 22 / 100, 11);
+    fill_rectangle(lc - 2, 195, lc, 195 - (safety - Mev[STEP].asf) * 22 / 100, 6);
+
+    for (i = 195; i > 195 - val * 22 / 100; i--) {
+        fill_rectangle(lc - 2, 195, lc, i, 21);
+        delay(15);
+    }
+
+
+    if (plr == 1 && !AI[plr]) {
+        if (val > safety && prob == 0) {
+            fill_rectangle(lc - 2, 195, lc, 195 - val * 22 / 100, 9);
+            lc = 191;
+        } else if (val > safety) {
+            fill_rectangle(lc - 2, 195, lc, 195 - val * 22 / 100, 9);
+            lc += 5;
+        } else {
+            if (lc >= 241) {
+                display::graphics.setForegroundColor(55);
+                fill_rectangle(189, 173, 249, 196, 55);
+
+                for (i = 190; i < 250; i += 2) {
+                    display::graphics.legacyScreen()->setPixel(i, 178, 61);
+                    display::graphics.legacyScreen()->setPixel(i, 184, 61);
+                    display::graphics.legacyScreen()->setPixel(i, 190, 61);
+                }
+
+                fill_rectangle(189, 195, 191, 195 - safety * 22 / 100, 11);
+                fill_rectangle(189, 195, 191, 195 - (safety - Mev[STEP].asf) * 22 / 100, 6);
+                fill_rectangle(189, 195, 191, 195 - val * 22 / 100, 21);
+
+                if (Mev[STEP].asf > 0) {
+                    fill_rectangle(189, 195 - safety * 22 / 100, 191, 195 - safety * 22 / 100, 11);
+                }
+
+                lc = 196;
+                /* lc > 241 */
+            } else {
+                lc += 5;
+            }
+        } /* check safety and problem */
+    } else if (plr == 0 && !AI[plr]) {
+        if (val > safety && prob == 0) {
+            fill_rectangle(lc - 2, 195, lc, 195 - val * 22 / 100, 9);
+            lc = 76;
+        } else if (val > safety) {
+            fill_rectangle(lc - 2, 195, lc, 195 - val * 22 / 100, 9);
+            lc += 5;
+        } else {
+            if (lc >= 126) {
+                fill_rectangle(73, 173, 133, 196, 55);
+
+                for (i = 73; i < 133; i += 2) {
+                    display::graphics.legacyScreen()->setPixel(i, 178, 61);
+                    display::graphics.legacyScreen()->setPixel(i, 184, 61);
+                    display::graphics.legacyScreen()->setPixel(i, 190, 61);
+                }
+
+                fill_rectangle(74, 195, 76, 195 - safety * 22 / 100, 11);
+                fill_rectangle(74, 195, 76, 195 - (safety - Mev[STEP].asf) * 22 / 100, 6);
+                fill_rectangle(74, 195, 76, 195 - val * 22 / 100, 21);
+
+                if (Mev[STEP].asf > 0) {
+                    fill_rectangle(74, 195 - safety * 22 / 100, 76, 195 - safety * 22 / 100, 11);
+                }
+
+                lc = 81;
+            } else {
+                lc += 5;
+            }
+        }
+    }
+
+    TRACE1("<-MCGraph()");
+    return lc;
 }
 
 
@@ -1313,9 +1521,6 @@ char DrawMoonSelection(char plr, char nauts, const struct MisEval &step)
     // Place Image Here
     //BZAnimation::Ptr moonAnim = FindHardwareAnim(plr, step);
 
-    // Deserialize header
-    loadHeader();
-    
     std::string ID = getEquipAnimID(plr, step);
     int index = getEquipAnimIndex(ID);
     loadFrames(index);
@@ -1541,21 +1746,24 @@ std::string getEquipAnimID(char plr, const struct MisEval &step)
 
 int getEquipAnimIndex(std::string name) 
 {   
-    // Deserialize indexEntry
-    loadIndexEntry();
-      
-    for (int i = 0; i < 41; i++) {
-        /*
-        DEBUG5("comparing name %s (length: %zu) with ID %s (length: %zu)", 
-           name.c_str(), name.length(), indexEntry[i].ID.c_str(), 
-           indexEntry[i].ID.length());
-        */
-        if (name == indexEntry[i].ID) {
-            int index = i;
-            DEBUG3("EquipAnim ID %s match index %d", name.c_str(), index);
-            return index;
+    static std::unordered_map<std::string, int> byId;
+
+    if (byId.empty()) {
+        const std::vector<struct BZFileHeader> &indexEntry =
+            GetLiftoffIndex().indexEntry;
+
+        for (int i = 0; i < indexEntry.size(); i++) {
+            byId.insert(std::make_pair(indexEntry[i].ID, i));
         }
     }
+
+    std::unordered_map<std::string, int>::const_iterator it = byId.find(name);
+
+    if (it != byId.end()) {
+        DEBUG3("EquipAnim ID %s match index %d", name.c_str(), it->second);
+        return it->second;
+    }
+
     // Error, no match for name
     std::string errorMsg = "could not find match for EquipAnim ID " + name;
     throw std::runtime_error(errorMsg.c_str());
@@ -1565,12 +1773,19 @@ int getEquipAnimIndex(std::string name)
 
 // Load the animation frames to a vector that functions as a cache
 void loadFrames(int index) {
+    const struct LiftoffIndex &liftoff = GetLiftoffIndex();
+    const std::vector<struct BZFileHeader> &indexEntry = liftoff.indexEntry;
     std::string filename;
-    
+
+    if (index == animCacheIndex && !animCache.empty()) {
+        return;
+    }
+
     // Assign correct size to animCache
-    animCache.resize(header[index].fNum); 
+    animCacheIndex = -1;
+    animCache.resize(liftoff.header.at(index).fNum);
     
-    for (int i = 0; i < header[index].fNum; i++) {
+    for (int i = 0; i < liftoff.header[index].fNum; i++) {
     	filename =  "images/liftoff/liftoff." + indexEntry[index].ID + "." 
           + std::to_string(i) + ".png"; 
         
@@ -1579,6 +1794,7 @@ void loadFrames(int index) {
     }
     
     if (!animCache.empty()) {
+        animCacheIndex = index;
     	DEBUG2("frames for %s loaded", (indexEntry[index].ID).c_str());
     } else {
     	throw std::runtime_error("Error. " + indexEntry[index].ID 
@@ -1588,6 +1804,8 @@ void loadFrames(int index) {
 
 
 void playEquipAnim (int index) {
+    const std::vector<struct AnimType> &header = GetLiftoffIndex().header;
+
     if (frameCounter == header[index].fNum) {
         frameCounter = 0;
     }
@@ -1603,27 +1821,21 @@ void playEquipAnim (int index) {
 
 
 
-void loadHeader() {
-if (! header.empty()) { 
-    std::ifstream file(locate_file("liftoff.json", FT_DATA));
-    if (!file) {
-        throw std::runtime_error("liftoff.json could not be opened.");
-    }
-    cereal::JSONInputArchive ar(file);
-    ar(CEREAL_NVP(header));
-    DEBUG1("header deserialized.");
-}
-}
-
+/**
+ * Get the list of equipment animations.
+ *
+ * \return  the contents of liftoff.json.
+ * \throws IOException  if liftoff.json cannot be read.
+ */
+const struct LiftoffIndex &GetLiftoffIndex()
+{
+    static boost::shared_ptr<const LiftoffIndex> liftoff;
 
-void loadIndexEntry() {
-if (! indexEntry.empty()) {
-    std::ifstream file(locate_file("liftoff.json", FT_DATA));
-    if (!file) {
-        throw std::runtime_error("liftoff.json could not be opened.");
+    if (!liftoff) {
+        liftoff = AssetRegistry::get<LiftoffIndex,
+                  DataAsset<LiftoffIndex, JsonCache::Fields<LiftoffIndex> > >(
+                      "liftoff.json");
     }
-    cereal::JSONInputArchive ar(file);
-    ar(indexEntry);
-    DEBUG1("IndexEntry deserialized");
-}
+
+    return *liftoff;
 }
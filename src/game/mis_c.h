@@ -1,14 +1,42 @@
 #ifndef MIS_C_H
 #define MIS_C_H
 
-void FirstManOnMoon(char plr, char isAI, char misNum,
-                    const struct MisEval &step);
-void PlaySequence(char plr, int step, const char *Seq, char mode);
+#include "game_context.h"
+#include "mis_m.h"
+
+/**
+ * Shows a mission on the mission control screen, or full screen
+ * when fullscreenMissionPlayback is set, and asks the player for
+ * the mission's choices.
+ */
+class MissionScreen : public MissionView
+{
+public:
+    MissionScreen();
+
+    virtual void start(char plr);
+    virtual void countdown(char plr, int step);
+    virtual void stepName(char plr, int step);
+    virtual void roll(char plr, const StepOutcome &outcome);
+    virtual void sequence(char plr, const StepSequence &seq);
+    virtual char failure(char plr, int note, char *text);
+    virtual char moonWalker(char plr, char nauts, const struct MisEval &step);
+    virtual void crewLost(char plr);
+    virtual void finish(char plr);
+
+private:
+    int lc;  // Position of the next bar in the safety chart
+};
+
+bool PickSequence(char plr, int step, const char *Seq, char mode,
+                  struct StepSequence &pick);
+void ShowSequence(char plr, const struct StepSequence &pick);
 char FailureMode(char plr, int prelim, char *text);
+char DrawMoonSelection(char plr, char nauts, const struct MisEval &step);
 void Tick(char plr);
 
 extern char daysAMonth[12];
-extern char STEPnum;
+extern GAME_LOCAL char STEPnum;
 extern struct AnimType AHead;
 extern struct BlockHead BHead;
 
@@ -29,43 +29,43 @@
 #include <string>
 #include <vector>
 
-#include "display/graphics.h"
-#include "display/surface.h"
-
 #include "mis_m.h"
 #include "Buzz_inc.h"
-#include "draw.h"
+#include "asset_index.h"
 #include "utils.h"
 #include "options.h"
 #include "game_main.h"
 #include "hardware.h"
+#include "journal.h"
 #include "mc.h"
 #include "mis_c.h"
 #include "mission_util.h"
-#include "sdlhelper.h"
-#include "gr.h"
 #include "pace.h"
 
 LOG_DEFAULT_CATEGORY(mission)
 
-char MFlag;
-char death;
-char durx;
-char MPad;
-char Unm;
-char SCRUBS;
-char noDock;
-char InSpace;
-char Dock_Skip; /**< used for mission branching */
+GAME_LOCAL char MFlag;
+GAME_LOCAL char death;
+GAME_LOCAL char durx;
+GAME_LOCAL char MPad;
+GAME_LOCAL char Unm;
+GAME_LOCAL char SCRUBS;
+GAME_LOCAL char noDock;
+GAME_LOCAL char InSpace;
+GAME_LOCAL char Dock_Skip; /**< used for mission branching */
 
-extern char tMen;
-extern bool fullscreenMissionPlayback;
+extern GAME_LOCAL char tMen;
+extern GAME_LOCAL bool fullscreenMissionPlayback;
 
 void GetFailStat(struct XFails *Now, char *FName, int rnum);
-int MCGraph(char plr, int lc, int safety, int val, char prob);
 void F_KillCrew(char mode, struct Astros *Victim);
 void F_IRCrew(char mode, struct Astros *Guy);
-int FailEval(char plr, int type, char *text, int val, int xtra);
+int FailEval(char plr, int type, char *text, int val, int xtra,
+             MissionView &view);
+void FirstManOnMoon(char plr, char misNum, const struct MisEval &step,
+                    MissionView &view);
+std::string PlayStep(char plr, int step, const char *seq, char mode,
+                     MissionView &view);
 Equipment *FindLunarModule();
 std::vector<Astros *> LMCrew(int pad, Equipment *module);
 void InvalidatePrestige();
@@ -105,32 +105,36 @@ void GetFailStat(struct XFails *Now, char *FName, int rnum)
     DEBUG3("->GetFailStat(XFails *Now, FName %s, rnum %d)", FName, rnum);
     assert(Now != NULL);
 
-    for (int i = 0; i < Assets->fails.size(); i++) {
-        if (!xstrncasecmp(Assets->fails.at(i).MissionStep.c_str(), FName, 4)) {
-            if (rnum < 0) { // unmanned
-                if (Assets->fails.at(i).percentage == rnum) {
-                    *Now = Assets->fails.at(i);
-                    break;
-                }
-            } else { // manned
-                if (Assets->fails.at(i).percentage > rnum) {
-                    *Now = Assets->fails.at(i);
-                    break;
-                }
-            }
-        }
+    const struct XFails *fail = FindFailure(FName, rnum);
+
+    if (fail != NULL) {
+        *Now = *fail;
     }
 
     DEBUG1("<-GetFailStat()");
 }
 
 
-void MisCheck(char plr, char mpad)
+/**
+ * Resolve a mission step by step.
+ *
+ * Rolls each step against its safety, looks up and applies any
+ * failure, and follows the mission's branches to its end, leaving
+ * the results in Mev and the game data. Showing the mission and the
+ * player's choices (scrubbing, who walks on the Moon) are left to the
+ * view, so missions can be resolved without a screen.
+ *
+ * \param plr  the player flying the mission.
+ * \param mpad  the launch pad of the (first) mission.
+ * \param view  shows the mission and makes the player's choices.
+ * \return  every step attempted, in order.
+ */
+std::vector<StepOutcome> ResolveMission(char plr, char mpad,
+                                        MissionView &view)
 {
-    int save, PROBLEM, i, lc, durxx;
+    int save, PROBLEM, durxx;
     struct XFails Now;
-
-    lc = 0; /* XXX check uninitialized */
+    std::vector<StepOutcome> trace;
 
     STEPnum = STEP;
     FINAL = STEP = MFlag = 0;  // Clear Everything
@@ -140,36 +144,8 @@ void MisCheck(char plr, char mpad)
     SCRUBS = noDock = InSpace = 0;
 
     const int code = Data->P[plr].Mission[mpad].MissionCode;
-    const struct mStr plan = GetMissionPlan(code);
-
-    if (!AI[plr] && !fullscreenMissionPlayback) {
-        //FadeOut(1,pal,100,128,1);
-        if (plr == 1) {
-            fill_rectangle(189, 173, 249, 196, 55);
-
-            for (i = 190; i < 250; i += 2) {
-                display::graphics.legacyScreen()->setPixel(i, 178, 61);
-                display::graphics.legacyScreen()->setPixel(i, 184, 61);
-                display::graphics.legacyScreen()->setPixel(i, 190, 61);
-            }
 
-            lc = 191;
-        } else if (plr == 0) {
-            fill_rectangle(73, 173, 133, 196, 55);
-
-            for (i = 73; i < 133; i += 2) {
-                display::graphics.legacyScreen()->setPixel(i, 178, 61);
-                display::graphics.legacyScreen()->setPixel(i, 184, 61);
-                display::graphics.legacyScreen()->setPixel(i, 190, 61);
-            }
-
-            lc = 76;
-        }
-    } // END if (!AI[plr])
-
-    if (!AI[plr] && !fullscreenMissionPlayback) {
-        Tick(2);
-    }
+    view.start(plr);
 
     Mev[0].trace = 0;
     death = 0;
@@ -187,10 +163,6 @@ void MisCheck(char plr, char mpad)
     }
 
     do {
-        if (STEP > 30 || STEP < 0) {
-            delay(20);
-        }
-
         if (Dock_Skip == 1) {
             if (Mev[Mev[STEP].trace].loc == 8) {
                 Mev[STEP].trace++;    // skip over docking.
@@ -198,7 +170,7 @@ void MisCheck(char plr, char mpad)
         }
 
         if (Mev[STEP].loc == 16 && Mev[Mev[STEP].trace].loc == 15) {
-            FirstManOnMoon(plr, 0, code, Mev[STEP]);
+            FirstManOnMoon(plr, code, Mev[STEP], view);
         }
 
         // Duration Hack Part 1 of 3   (during the Duration stuff)
@@ -214,10 +186,10 @@ void MisCheck(char plr, char mpad)
                 if ((Data->Def.Lev1 == 0 && plr == 0) || (Data->Def.Lev2 == 0 && plr == 1)) {
                     Mev[STEP].dice = MisRandom();
                 } else {
-                    Mev[STEP].dice = brandom(100) + 1;
+                    Mev[STEP].dice = brandom(100, RNG_Mission) + 1;
                 }
 
-                Mev[STEP].rnum = brandom(10000);  // reroll failure type
+                Mev[STEP].rnum = brandom(10000, RNG_Mission);  // reroll failure type
                 Mev[STEP].trace = STEP;
             }
         }
@@ -240,31 +212,7 @@ void MisCheck(char plr, char mpad)
         }
 
         if (Mev[STEP].Name[0] == 'A') {
-            display::graphics.setForegroundColor(11);
-
-            if (!AI[plr] && !fullscreenMissionPlayback) {
-                if (plr == 0) {
-                    x = 5;
-                    y = 112;
-                    fill_rectangle(2, 107, 140, 115, 3);
-                } else {
-                    x = 82, y = 8;
-                    fill_rectangle(78, 2, 241, 10, 3);
-                }
-
-                draw_string(x, y, "COUNTDOWN");
-
-                if (plr == 0) {
-                    fill_rectangle(188, 107, 294, 113, 3);
-                    display::graphics.setForegroundColor(1);
-                    draw_string(190, 112, (Mev[STEP].pad == 0) ? "PRIMARY LAUNCH" : "SECOND LAUNCH");
-                } else {
-                    fill_rectangle(244, 56, 314, 62, 3);
-                    display::graphics.setForegroundColor(1);
-                    draw_string(246, 61, (Mev[STEP].pad == 0) ? "PRIMARY PAD" : "SECOND PAD");
-                }
-
-            }
+            view.countdown(plr, STEP);
 
             std::string name(Mev[STEP].Name);
 
@@ -275,7 +223,7 @@ void MisCheck(char plr, char mpad)
             }
 
             // Special Case #47236
-            PlaySequence(plr, STEP, name.c_str(), 0);
+            PlayStep(plr, STEP, name.c_str(), 0, view);
         }
 
         // Necessary to keep code from crashing on bogus mission step
@@ -283,52 +231,29 @@ void MisCheck(char plr, char mpad)
             STEP++;
         }
 
-        // Draw Mission Step Name
-        if (!AI[plr] && !fullscreenMissionPlayback) {
-            if (!(fEarly && STEP != 0)) {
-                if (plr == 0) {
-                    x = 5;
-                    y = 112;
-                    fill_rectangle(2, 107, 140, 115, 3);
-                } else {
-                    x = 82, y = 8;
-                    fill_rectangle(78, 2, 241, 10, 3);
-                }
-
-                display::graphics.setForegroundColor(11);
-                MisStep(x, y, Mev[STEP].loc);
-
-                if (plr == 0) {
-                    fill_rectangle(188, 107, 294, 113, 3);
-                    display::graphics.setForegroundColor(1);
-                    draw_string(190, 112, (Mev[STEP].pad == 0) ? "PRIMARY LAUNCH" : "SECOND LAUNCH");
-                } else {
-                    fill_rectangle(244, 56, 314, 62, 3);
-                    display::graphics.setForegroundColor(1);
-                    draw_string(246, 61, (Mev[STEP].pad == 0) ? "PRIMARY PAD" : "SECOND PAD");
-                }
-            }
-        }
+        view.stepName(plr, STEP);
 
         // SAFETY FACTOR STUFF
-        int val = Mev[STEP].dice;
-        int safety = StepSafety(Mev[STEP]);
+        StepOutcome outcome;
+        outcome.step = STEP;
+        outcome.dice = Mev[STEP].dice;
+        outcome.safety = StepSafety(Mev[STEP]);
+        outcome.failure = outcome.note = -1;
 
         save = (GetEquipment(Mev[STEP])->SaveCard == 1) ? 1 : 0;
-        PROBLEM = val > safety;
+        PROBLEM = outcome.dice > outcome.safety;
 
         if (!AI[plr] && options.want_cheats) {
             PROBLEM = 0;
         }
 
         DEBUG6("step %c:%s safety %d rolled %d%s", Mev[STEP].Name[0], S_Name[Mev[STEP].loc],
-               safety, val,
+               outcome.safety, outcome.dice,
                PROBLEM ? " problem" : (options.want_cheats ? " cheating" : ""));
 
-        if (!AI[plr] && !fullscreenMissionPlayback)
-            if (!(fEarly && STEP != 0)) {
-                lc = MCGraph(plr, lc, MAX(0, safety), MAX(0, val), PROBLEM);    // Graph Chart
-            }
+        outcome.problem = PROBLEM;
+        outcome.saved = PROBLEM && save == 1;
+        view.roll(plr, outcome);    // Graph Chart
 
         if (PROBLEM && save == 1) {  // Failure Saved
             GetEquipment(Mev[STEP])->SaveCard--;    // Deduct SCard
@@ -345,12 +270,12 @@ void MisCheck(char plr, char mpad)
         if (PROBLEM == 1) {  // Step Problem
             // for the unmanned mission
             if (MANNED[Mev[STEP].pad] == 0 && MANNED[other(Mev[STEP].pad)] == 0) {
-                Mev[STEP].rnum = (-1) * (brandom(5) + 1);
+                Mev[STEP].rnum = (-1) * (brandom(5, RNG_Mission) + 1);
             }
 
             // Unmanned also
             if (MANNED[Mev[STEP].pad] == 0 && noDock == 0) {
-                Mev[STEP].rnum = (-1) * (brandom(5) + 1);
+                Mev[STEP].rnum = (-1) * (brandom(5, RNG_Mission) + 1);
             }
 
             memset(&Now, 0x00, sizeof Now);
@@ -407,8 +332,9 @@ void MisCheck(char plr, char mpad)
             std::string name(Mev[STEP].Name);
             name.push_back(0x30 + (Now.fail / 10));
             name.push_back(0x30 + Now.fail % 10);
-            PlaySequence(plr, STEP, name.c_str(), 1);
-            FailEval(plr, Now.code, Now.text, Now.val, Now.xtra);
+            outcome.failure = Now.code;
+            outcome.sequence = PlayStep(plr, STEP, name.c_str(), 1, view);
+            outcome.note = FailEval(plr, Now.code, Now.text, Now.val, Now.xtra, view);
         } else {   // Step Success
 
             if (Mev[STEP].loc == 28 || Mev[STEP].loc == 27) {
@@ -459,7 +385,8 @@ void MisCheck(char plr, char mpad)
                  || (MA[1][3].A != NULL && MA[1][3].A->Sex && EVA[1] == 3));
 
             // Play Animations
-            PlaySequence(plr, STEP, Mev[STEP].Name, femaleEVA ? 2 : 0);
+            outcome.sequence =
+                PlayStep(plr, STEP, Mev[STEP].Name, femaleEVA ? 2 : 0, view);
 
             if (Mev[STEP].sgoto == 100) {
                 Mev[STEP].trace = 0x7F;
@@ -478,6 +405,8 @@ void MisCheck(char plr, char mpad)
             // Bottom of success statement
         }
 
+        trace.push_back(outcome);
+
         if (Mev[STEP].loc == 0x7f || Mev[STEP].sgoto == 100) {  // force mission end
             Mev[STEP].trace = 0x7f;
         }
@@ -487,10 +416,6 @@ void MisCheck(char plr, char mpad)
             Mev[STEP].trace = 0x7f;
         }
 
-        if (STEP > 30 || STEP < 0) {
-            delay(20);
-        }
-
         if (Mev[STEP].sgoto == Mev[STEP].fgoto && Mev[STEP].trace != 0x7f) {
             Mev[STEP].trace = Mev[STEP].sgoto;
         }
@@ -535,10 +460,6 @@ void MisCheck(char plr, char mpad)
     } while (Mev[STEP].trace != 0x7f);         // End mission
 
     //end do
-    if (!AI[plr] && death == 0) {
-        delay(1000);
-    }
-
     if ((MA[0][0].A != NULL && MA[0][0].A->Status == AST_ST_DEAD)
         || (MA[0][1].A != NULL && MA[0][1].A->Status == AST_ST_DEAD)
         || (MA[0][2].A != NULL && MA[0][2].A->Status == AST_ST_DEAD)
@@ -549,39 +470,133 @@ void MisCheck(char plr, char mpad)
         || (MA[1][3].A != NULL && MA[1][3].A->Status == AST_ST_DEAD)) {
         // Mission Death
         if (!AI[plr]) {
-            if (!fullscreenMissionPlayback) {
-                display::AutoPal p(display::graphics.legacyScreen());
-                memset(&p.pal[64 * 3], 0x00, 64 * 3);  //Specs: 0x08
+            view.crewLost(plr);
+            PlayStep(plr, STEP, (plr == 0) ? "UFUN" : "SFUN", 0, view);
+        }
 
-                if (plr == 0) {
-                    fill_rectangle(2, 107, 140, 115, 3);
-                } else {
-                    fill_rectangle(78, 2, 241, 10, 3);
-                }
+        death = 1;
+    } else {
+        death = 0;
+    }
 
-                if (plr == 0) {
-                    fill_rectangle(188, 107, 294, 113, 3);
-                } else {
-                    fill_rectangle(244, 56, 314, 62, 3);
-                }
-            }
+    view.finish(plr);
 
-            PlaySequence(plr, STEP, (plr == 0) ? "UFUN" : "SFUN", 0);
-        }
+    return trace;
+}
 
-        if (!AI[plr]) {
-            delay(1000);
-        }
 
-        death = 1;
+/**
+ * Resolve a mission, showing it on screen if it's flown by a human
+ * player.
+ *
+ * \param plr  the player flying the mission.
+ * \param mpad  the launch pad of the (first) mission.
+ */
+void MisCheck(char plr, char mpad)
+{
+    if (AI[plr]) {
+        MissionView view;
+        ResolveMission(plr, mpad, view);
+    } else if (gameJournal.replaying()) {
+        JournalView view;
+        ResolveMission(plr, mpad, view);
     } else {
-        death = 0;
+        MissionScreen view;
+        ResolveMission(plr, mpad, view);
     }
+}
+
+
+/**
+ * Choose a computer player's crew member for the first steps on the
+ * Moon.
+ *
+ * \param plr  the player flying the mission.
+ * \param nauts  the number of crew members on the Moon.
+ * \param step  the landing step.
+ * \return  the crew member's position (1-based) in the landing crew.
+ */
+char MissionView::moonWalker(char plr, char nauts, const struct MisEval &step)
+{
+    return brandom(nauts, RNG_Mission) + 1;
+}
+
+
+/**
+ * Pick the day of the landing and who takes the first step on the
+ * Moon.
+ *
+ * \param plr  the player flying the mission.
+ * \param misNum  the mission code.
+ * \param step  the landing step.
+ * \param view  asks a human player to choose the crew member.
+ */
+void FirstManOnMoon(char plr, char misNum, const struct MisEval &step,
+                    MissionView &view)
+{
+    int nautsOnMoon = 0;
+    Equipment *e = GetEquipment(step);
+
+    dayOnMoon = brandom(daysAMonth[Data->P[plr].Mission[step.pad].Month], RNG_Mission) + 1;
+
+    if (misNum == Mission_Soyuz_LL && plr == 1) {
+        nautsOnMoon = 3;
+    }
+
+    //Direct Ascent
+    if (strcmp(e->Name, Data->P[plr].Manned[MANNED_HW_FOUR_MAN_CAPSULE].Name) == 0) {
+        nautsOnMoon = 4;
+    }
+
+    //2 men LL
+    if (strcmp(e->Name, Data->P[plr].Manned[MANNED_HW_TWO_MAN_MODULE].Name) == 0) {
+        nautsOnMoon = 2;
+    }
+
+    //1 man LL
+    if (strcmp(e->Name, Data->P[plr].Manned[MANNED_HW_ONE_MAN_MODULE].Name) == 0) {
+        nautsOnMoon = 1;
+    }
+
+
+    if (nautsOnMoon == 1) {
+        manOnMoon = 2;
+        return;
+    }
+
+    manOnMoon = view.moonWalker(plr, nautsOnMoon, step);
+
+    EVA[0] = EVA[1] = manOnMoon - 1;
 
     return;
 }
 
 
+/**
+ * Choose the sequence for a mission step, and have the view show it.
+ *
+ * \param plr  the player flying the mission.
+ * \param step  the mission step.
+ * \param seq  the sequence code, as for PickSequence().
+ * \param mode  0 for success, 1 for failure, 2 for success with a
+ *              female crew member on EVA.
+ * \param view  shows the sequence.
+ * \return  the ID of the sequence, or "" if there is none to show.
+ */
+std::string PlayStep(char plr, int step, const char *seq, char mode,
+                     MissionView &view)
+{
+    struct StepSequence pick;
+
+    if (!PickSequence(plr, step, seq, mode, pick)) {
+        return std::string();
+    }
+
+    view.sequence(plr, pick);
+    return pick.id;
+}
+
+
 /**
  * Calculate the safety factor to test against for a mission step.
  *
@@ -589,18 +604,28 @@ void MisCheck(char plr, char mpad)
  * function IS NOT guaranteed to give the correct value for any steps
  * but the current one.
  *
- * TODO: Eliminate the use of global variables.
- *
  * \param step  the current mission step.
  */
 int StepSafety(const struct MisEval &step)
+{
+    return StepSafety(step, InSpace);
+}
+
+
+/**
+ * Calculate the safety factor to test against for a mission step.
+ *
+ * \param step  the mission step.
+ * \param inSpace  the number of crewed craft in space at the step.
+ */
+int StepSafety(const struct MisEval &step, int inSpace)
 {
     int safety = GetEquipment(step)->MisSaf;
 
     if ((step.Name[0] == 'A') && MH[step.pad][Mission_SecondaryBooster]) {
         // Account for Boosters - if used - on launch steps
         safety = RocketBoosterSafety( safety, MH[step.pad][Mission_SecondaryBooster]->Safety);
-    } else if ((step.loc == 28 || step.loc == 27) && InSpace == 2) {
+    } else if ((step.loc == 28 || step.loc == 27) && inSpace == 2) {
         // For joint duration tests, use the average capsule safety
         safety = (MH[0][Mission_Capsule]->MisSaf +
                   MH[1][Mission_Capsule]->MisSaf) / 2;
@@ -616,99 +641,6 @@ int StepSafety(const struct MisEval &step)
 }
 
 
-/** Draw mission step rectangle
- *
- * The rectangle represents the success or failure rate.
- *
- * \param plr Player data
- * \param lc ??? maybe location of the chart
- * \param safety Safety factor in percent
- * \param val value of the dice checked against safety
- * \param prob is this a problem or not?
- *
- * \return new value of lc
- */
-int MCGraph(char plr, int lc, int safety, int val, char prob)
-{
-    int i;
-    TRACE5("->MCGraph(plr, lc %d, safety %d, val %d, prob %c)", lc, safety, val, prob);
-    fill_rectangle(lc - 2, 195, lc, 195 - safety * 22 / 100, 11);
-    fill_rectangle(lc - 2, 195, lc, 195 - (safety - Mev[STEP].asf) * 22 / 100, 6);
-
-    for (i = 195; i > 195 - val * 22 / 100; i--) {
-        fill_rectangle(lc - 2, 195, lc, i, 21);
-        delay(15);
-    }
-
-
-    if (plr == 1 && !AI[plr]) {
-        if (val > safety && prob == 0) {
-            fill_rectangle(lc - 2, 195, lc, 195 - val * 22 / 100, 9);
-            lc = 191;
-        } else if (val > safety) {
-            fill_rectangle(lc - 2, 195, lc, 195 - val * 22 / 100, 9);
-            lc += 5;
-        } else {
-            if (lc >= 241) {
-                display::graphics.setForegroundColor(55);
-                fill_rectangle(189, 173, 249, 196, 55);
-
-                for (i = 190; i < 250; i += 2) {
-                    display::graphics.legacyScreen()->setPixel(i, 178, 61);
-                    display::graphics.legacyScreen()->setPixel(i, 184, 61);
-                    display::graphics.legacyScreen()->setPixel(i, 190, 61);
-                }
-
-                fill_rectangle(189, 195, 191, 195 - safety * 22 / 100, 11);
-                fill_rectangle(189, 195, 191, 195 - (safety - Mev[STEP].asf) * 22 / 100, 6);
-                fill_rectangle(189, 195, 191, 195 - val * 22 / 100, 21);
-
-                if (Mev[STEP].asf > 0) {
-                    fill_rectangle(189, 195 - safety * 22 / 100, 191, 195 - safety * 22 / 100, 11);
-                }
-
-                lc = 196;
-                /* lc > 241 */
-            } else {
-                lc += 5;
-            }
-        } /* check safety and problem */
-    } else if (plr == 0 && !AI[plr]) {
-        if (val > safety && prob == 0) {
-            fill_rectangle(lc - 2, 195, lc, 195 - val * 22 / 100, 9);
-            lc = 76;
-        } else if (val > safety) {
-            fill_rectangle(lc - 2, 195, lc, 195 - val * 22 / 100, 9);
-            lc += 5;
-        } else {
-            if (lc >= 126) {
-                fill_rectangle(73, 173, 133, 196, 55);
-
-                for (i = 73; i < 133; i += 2) {
-                    display::graphics.legacyScreen()->setPixel(i, 178, 61);
-                    display::graphics.legacyScreen()->setPixel(i, 184, 61);
-                    display::graphics.legacyScreen()->setPixel(i, 190, 61);
-                }
-
-                fill_rectangle(74, 195, 76, 195 - safety * 22 / 100, 11);
-                fill_rectangle(74, 195, 76, 195 - (safety - Mev[STEP].asf) * 22 / 100, 6);
-                fill_rectangle(74, 195, 76, 195 - val * 22 / 100, 21);
-
-                if (Mev[STEP].asf > 0) {
-                    fill_rectangle(74, 195 - safety * 22 / 100, 76, 195 - safety * 22 / 100, 11);
-                }
-
-                lc = 81;
-            } else {
-                lc += 5;
-            }
-        }
-    }
-
-    TRACE1("<-MCGraph()");
-    return lc;
-}
-
 #define F_ALL 0
 #define F_ONE 1
 
@@ -804,7 +736,8 @@ void F_IRCrew(char mode, struct Astros *Guy)
     }
 }
 
-int FailEval(char plr, int type, char *text, int val, int xtra)
+int FailEval(char plr, int type, char *text, int val, int xtra,
+             MissionView &view)
 {
     int FNote = 0, temp, k, ctr = 0;
     char PROBLEM = 0;
@@ -826,9 +759,7 @@ int FailEval(char plr, int type, char *text, int val, int xtra)
             DestroyPad(plr, MPad + Mev[STEP].pad, 20, 0);
         }
 
-        if (!AI[plr]) {
-            FailureMode(plr, FNote, text);
-        }
+        view.failure(plr, FNote, text);
 
         // Special Case for PhotoRecon with Lunar Probe
         if (Mev[STEP].loc == 20 && mcc == Mission_Lunar_Probe) {
@@ -965,7 +896,7 @@ int FailEval(char plr, int type, char *text, int val, int xtra)
 
     case 15:  // Give option to Scrub  1%->20% negative of part
         FNote = 3;
-        GetEquipment(Mev[STEP])->MisSaf -= brandom(20) + 1;
+        GetEquipment(Mev[STEP])->MisSaf -= brandom(20, RNG_Mission) + 1;
 
         if (GetEquipment(Mev[STEP])->MisSaf <= 0) {
             GetEquipment(Mev[STEP])->MisSaf = 1;
@@ -979,8 +910,8 @@ int FailEval(char plr, int type, char *text, int val, int xtra)
         Mev[STEP].StepInfo = 1100 + Mev[STEP].loc;
 
         for (k = 0; k < MANNED[Mev[STEP].pad]; k++) {
-            if (brandom(100) < val) {
-                if (brandom(100) >= xtra) {
+            if (brandom(100, RNG_Mission) < val) {
+                if (brandom(100, RNG_Mission) >= xtra) {
                     F_IRCrew(F_INJ, MA[Mev[STEP].pad][k].A);
                     Mev[STEP].StepInfo =
                         MAX(2100 + Mev[STEP].loc, Mev[STEP].StepInfo);
@@ -1004,7 +935,7 @@ int FailEval(char plr, int type, char *text, int val, int xtra)
         Mev[STEP].StepInfo = 1300 + Mev[STEP].loc;
 
         for (k = 0; k < MANNED[Mev[STEP].pad]; k++) {
-            if (brandom(100) < xtra) {
+            if (brandom(100, RNG_Mission) < xtra) {
                 F_IRCrew(F_RET, MA[Mev[STEP].pad][k].A);
                 Mev[STEP].StepInfo = 2300 + Mev[STEP].loc;
                 FNote = 9;
@@ -1012,7 +943,7 @@ int FailEval(char plr, int type, char *text, int val, int xtra)
         }
 
         for (k = 0; k < MANNED[Mev[STEP].pad]; k++) {
-            if (brandom(100) >= val) {
+            if (brandom(100, RNG_Mission) >= val) {
                 F_KillCrew(F_ONE, MA[Mev[STEP].pad][k].A);
                 Mev[STEP].StepInfo = 3300 + Mev[STEP].loc;
                 FNote = 8;
@@ -1078,7 +1009,7 @@ int FailEval(char plr, int type, char *text, int val, int xtra)
     case 22:  // one man % survival :: EVA
         Mev[STEP].StepInfo = 19;
 
-        if (brandom(100) > val) {
+        if (brandom(100, RNG_Mission) > val) {
             FNote = 8;
             crw = (EVA[Mev[STEP].pad] != -1) ? MA[Mev[STEP].pad][EVA[Mev[STEP].pad]].A : MA[other(Mev[STEP].pad)][EVA[other(Mev[STEP].pad)]].A;
             F_KillCrew(F_ONE, crw);
@@ -1103,7 +1034,7 @@ int FailEval(char plr, int type, char *text, int val, int xtra)
         Mev[STEP].StepInfo = 23 + Mev[STEP].loc;
 
         for (k = 0; k < MANNED[Mev[STEP].pad]; k++) {
-            if (brandom(100) < val) {
+            if (brandom(100, RNG_Mission) < val) {
                 FNote = 9;
                 F_IRCrew(F_RET, MA[Mev[STEP].pad][k].A);
                 Mev[STEP].StepInfo = 2400 + Mev[STEP].loc;
@@ -1126,7 +1057,7 @@ int FailEval(char plr, int type, char *text, int val, int xtra)
 
     case 24:   // Reduce Safety by VAL% perm :: hardware recovered
         FNote = 5;
-        GetEquipment(Mev[STEP])->Safety -= brandom(10);
+        GetEquipment(Mev[STEP])->Safety -= brandom(10, RNG_Mission);
 
         if (GetEquipment(Mev[STEP])->Safety <= 0) {
             GetEquipment(Mev[STEP])->Safety = 1;
@@ -1146,7 +1077,7 @@ int FailEval(char plr, int type, char *text, int val, int xtra)
     case 26:  // Subtract VAL% from Equip perm and branch to alternate
         FNote = 1;
         Mev[STEP].StepInfo = 1926;
-        GetEquipment(Mev[STEP])->Safety -= brandom(10);
+        GetEquipment(Mev[STEP])->Safety -= brandom(10, RNG_Mission);
 
         if (GetEquipment(Mev[STEP])->Safety <= 0) {
             GetEquipment(Mev[STEP])->Safety = 1;
@@ -1294,15 +1225,7 @@ int FailEval(char plr, int type, char *text, int val, int xtra)
 
     VerifySafety(plr);  // Keep all safeties within the proper ranges
 
-    while (bioskey(1)) {
-        bioskey(0);
-    }
-
-    key = 0;
-
-    if (!AI[plr]) {
-        temp = FailureMode(plr, FNote, text);
-    }
+    temp = view.failure(plr, FNote, text);
 
     if (temp == 0 && FNote == 3) {
         Mev[STEP].trace = STEP + 1;
@@ -1345,8 +1268,8 @@ int FailEval(char plr, int type, char *text, int val, int xtra)
 
     if (type == 9 || type == 19) {
         Mev[STEP].trace = STEP;
-        Mev[STEP].rnum = brandom(10000) + 1;  // new failure roll
-        Mev[STEP].dice = brandom(100) + 1;  // new die roll
+        Mev[STEP].rnum = brandom(10000, RNG_Mission) + 1;  // new failure roll
+        Mev[STEP].dice = brandom(100, RNG_Mission) + 1;  // new die roll
     }
 
     death = 0;
@@ -1,10 +1,65 @@
 #ifndef MIS_M_H
 #define MIS_M_H
 
+#include <string>
+#include <vector>
 
+#include "game_context.h"
+
+struct MisEval;
+
+/* A mission sequence chosen to show for a step. */
+struct StepSequence {
+    char seq[128];   // Sequence code, after the step kludges
+    std::string id;  // MissionIdSequence of the chosen entry
+    int entry;       // Index into Assets->sSeq, or fSeq for failures
+    char mode;       // 0 for success, 1 for failure
+};
+
+/* One attempt at a mission step, as resolved by ResolveMission(). */
+struct StepOutcome {
+    int step;              // Index into Mev
+    int safety;            // Safety factor the roll was tested against
+    int dice;              // The roll
+    bool problem;          // The roll failed the step
+    bool saved;            // The problem was cancelled by a save card
+    int failure;           // Failure type (XFails code), or -1
+    int note;              // Failure report shown (FNote), or -1
+    std::string sequence;  // ID of the sequence chosen, if any
+};
+
+/**
+ * Shows a mission while ResolveMission() works through it, and makes
+ * the choices it leaves to the player.
+ *
+ * The default shows nothing and chooses as a computer player would,
+ * which is enough to resolve a mission without a screen.
+ */
+class MissionView
+{
+public:
+    virtual ~MissionView() {}
+
+    virtual void start(char plr) {}
+    virtual void countdown(char plr, int step) {}
+    virtual void stepName(char plr, int step) {}
+    virtual void roll(char plr, const StepOutcome &outcome) {}
+    virtual void sequence(char plr, const StepSequence &seq) {}
+    virtual char failure(char plr, int note, char *text)
+    {
+        return 0;
+    }
+    virtual char moonWalker(char plr, char nauts, const struct MisEval &step);
+    virtual void crewLost(char plr) {}
+    virtual void finish(char plr) {}
+};
+
+std::vector<StepOutcome> ResolveMission(char plr, char mpad,
+                                        MissionView &view);
 void MisCheck(char plr, char mpad);
 int StepSafety(const struct MisEval &step);
+int StepSafety(const struct MisEval &step, int inSpace);
 
-extern char death;
+extern GAME_LOCAL char death;
 
 #endif // MIS_M_H
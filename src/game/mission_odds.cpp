@@ -0,0 +1,686 @@
+// This file handles the odds of a mission's outcome.
+//
+// The odds are worked out from the staged mission steps (Mev) without
+// rolling any dice. They follow ResolveMission() and FailEval() step
+// by step, with each step's safety as StepSafety() gives it and its
+// failures weighted as GetFailStat() would choose them.
+//
+// A few things are left out: save cards, the temporary safety loss
+// from earlier failures, and repeated mission flags (failure type 18
+// and 19) are all treated as on the first failure.
+
+#include "mission_odds.h"
+
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Buzz_inc.h"
+#include "asset_index.h"
+#include "game_main.h"
+#include "mc.h"
+#include "mis_m.h"
+#include "options.h"
+
+LOG_DEFAULT_CATEGORY(mission)
+
+
+namespace
+{
+const int END_OF_MISSION = 0x7f;
+
+enum Outcome {
+    OUT_Success,
+    OUT_Partial,
+    OUT_Failure,
+    OUT_CrewLoss,
+    OUT_COUNT
+};
+
+/* What a step failure does to the rest of the mission. */
+enum Effect {
+    FX_None,       // Carry on as if the step passed
+    FX_Partial,    // Carry on, but the mission is no longer a success
+    FX_Failure,    // The mission ends
+    FX_CrewLoss,   // A crew member is killed
+    FX_Recheck     // The step is rolled again
+};
+
+/* One way a step failure can turn out. */
+struct Branch {
+    double chance;
+    Effect effect;
+    int next;    // The step to go to, or END_OF_MISSION
+    bool scrub;  // A scrub is recommended
+};
+
+/* A failure type and the chance of it, given that a step failed. */
+struct FailShare {
+    double chance;
+    int code, val, xtra;
+};
+
+typedef std::vector<FailShare> FailShares;
+
+/* The chances of each outcome from some point of a mission on. */
+struct Ends {
+    double p[OUT_COUNT];
+    double scrub;
+
+    Ends() : scrub(0)
+    {
+        for (int i = 0; i < OUT_COUNT; i++) {
+            p[i] = 0;
+        }
+    }
+
+    explicit Ends(Outcome outcome) : scrub(0)
+    {
+        for (int i = 0; i < OUT_COUNT; i++) {
+            p[i] = (i == outcome) ? 1 : 0;
+        }
+    }
+
+    void add(const Ends &other, double chance)
+    {
+        for (int i = 0; i < OUT_COUNT; i++) {
+            p[i] += other.p[i] * chance;
+        }
+
+        scrub += other.scrub * chance;
+    }
+
+    Ends partial() const
+    {
+        Ends ends = *this;
+        ends.p[OUT_Partial] += ends.p[OUT_Success];
+        ends.p[OUT_Success] = 0;
+        return ends;
+    }
+};
+
+/* The state of one calculation. */
+struct Walk {
+    char plr;
+    int code;       // Mission code
+    int attempts;   // Times the first duration step is flown
+    int inSpace;    // Crewed craft in space during joint steps
+    bool started[MAX_STEPS];
+    bool done[MAX_STEPS];
+    Ends ends[MAX_STEPS];
+};
+
+// The caches are keyed by everything the results depend on, so they
+// are shared by every game and by the AI planner's threads. A long
+// run can stage any number of different missions, so each is emptied
+// when it fills up.
+const size_t MAX_CACHED = 4096;
+
+std::mutex cacheLock;
+std::unordered_map<std::string, FailShares> failCache;
+std::unordered_map<std::string, MissionOdds> oddsCache;
+
+Ends StepEnds(Walk &walk, int step);
+
+
+/* The cumulative standard normal distribution. */
+double Phi(double z)
+{
+    return 0.5 * erfc(-z / sqrt(2.0));
+}
+
+
+/**
+ * The chance a roll passes a step.
+ *
+ * \param plr  the player flying the mission.
+ * \param safety  the step's safety factor.
+ * \param first  true for the roll made when the mission was staged,
+ *               false for rerolls during the mission.
+ */
+double PassChance(char plr, int safety, bool first)
+{
+    if (!AI[plr] && options.want_cheats) {
+        return 1;
+    }
+
+    if ((Data->Def.Lev1 == 0 && plr == 0) || (Data->Def.Lev2 == 0 && plr == 1)) {
+        // MisRandom(): uniform below 66, a truncated normal above.
+        const double mu = 57 + 0.5;
+        const double sigma = sqrt(1000);
+
+        if (safety < 66) {
+            return MAX(safety, 0) / 100.0;
+        }
+
+        double lo = Phi((66 - mu) / sigma);
+        double hi = Phi((101 - mu) / sigma);
+        double upTo = Phi((MIN(safety, 100) + 1 - mu) / sigma);
+        return 0.65 + 0.35 * (upTo - lo) / (hi - lo);
+    }
+
+    int sides = (first && AI[plr]) ? 98 : 100;
+    return MIN(MAX(safety, 0), sides) / (double)sides;
+}
+
+
+void AddShare(FailShares &shares, const struct XFails *fail, double chance)
+{
+    FailShare share;
+    share.chance = chance;
+    share.code = fail ? fail->code : 0;
+    share.val = fail ? fail->val : 0;
+    share.xtra = fail ? fail->xtra : 0;
+
+    for (size_t i = 0; i < shares.size(); i++) {
+        if (shares[i].code == share.code && shares[i].val == share.val &&
+            shares[i].xtra == share.xtra) {
+            shares[i].chance += chance;
+            return;
+        }
+    }
+
+    shares.push_back(share);
+}
+
+
+/**
+ * The failure types of a step, weighted as GetFailStat() picks them.
+ *
+ * \param step  the mission step.
+ * \param manned  false to use the unmanned failure entries.
+ */
+FailShares FailureShares(const struct MisEval &step, bool manned)
+{
+    // The HMOON EVA failure always uses the same entry.
+    bool fixed = (step.Name[0] == 'H' && step.Name[1] == 'M');
+    std::string key(step.FName, strnlen(step.FName, 4));
+    key.push_back(fixed ? 'H' : manned ? 'M' : 'U');
+
+    {
+        std::lock_guard<std::mutex> guard(cacheLock);
+        std::unordered_map<std::string, FailShares>::const_iterator it =
+            failCache.find(key);
+
+        if (it != failCache.end()) {
+            return it->second;
+        }
+    }
+
+    FailShares shares;
+
+    if (fixed) {
+        AddShare(shares, FindFailure(step.FName, 7595), 1);
+    } else if (manned) {
+        for (int rnum = 1; rnum <= 10000; rnum++) {
+            AddShare(shares, FindFailure(step.FName, rnum), 1 / 10000.0);
+        }
+    } else {
+        for (int rnum = -5; rnum <= -1; rnum++) {
+            AddShare(shares, FindFailure(step.FName, rnum), 1 / 5.0);
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(cacheLock);
+
+    if (failCache.size() >= MAX_CACHED) {
+        failCache.clear();
+    }
+
+    failCache[key] = shares;
+    return shares;
+}
+
+
+/* Where a failure branching to the step's alternate goes. */
+Branch Alternate(const struct MisEval &step, int index, double chance)
+{
+    Branch branch = {chance, FX_Partial, index + 1, false};
+
+    if (step.fgoto == -1) {
+        branch.effect = FX_Failure;
+        branch.next = END_OF_MISSION;
+    } else if (step.fgoto != -2) {
+        branch.next = step.fgoto;
+    }
+
+    return branch;
+}
+
+
+/* Where a failure that carries on goes, unless it ends the mission. */
+Branch Onward(const struct MisEval &step, int index, double chance,
+              Effect effect)
+{
+    Branch branch = {chance, effect, index + 1, false};
+
+    if (step.fgoto == -1) {
+        branch.effect = FX_Failure;
+        branch.next = END_OF_MISSION;
+    }
+
+    return branch;
+}
+
+
+/* Split a branch by the chance of losing crew on the way. */
+void AddDeaths(std::vector<Branch> &branches, Branch survived,
+               double death)
+{
+    Branch lost = {survived.chance * death, FX_CrewLoss, END_OF_MISSION, false};
+    survived.chance *= 1 - death;
+    branches.push_back(lost);
+    branches.push_back(survived);
+}
+
+
+/* As BranchIfAlive(), for crew who all survived. */
+Branch IfAlive(const struct MisEval &step, int index, double chance)
+{
+    Branch branch = Alternate(step, index, chance);
+
+    if (MANNED[step.pad] == 0 ||
+        (step.FName[2] == '0' && step.FName[3] == '0')) {
+        branch.effect = FX_Failure;
+        branch.next = END_OF_MISSION;
+    }
+
+    return branch;
+}
+
+
+/**
+ * The ways a failure of the given type can turn out, as FailEval()
+ * handles it.
+ */
+void FailureBranches(int index, const FailShare &share,
+                     std::vector<Branch> &branches)
+{
+    const struct MisEval &step = Mev[index];
+    const int crew = MANNED[step.pad];
+    const double chance = share.chance;
+    double each;
+
+    if (MANNED[0] + MANNED[1] == 0) {
+        Branch end = {chance, FX_Failure, END_OF_MISSION, false};
+        branches.push_back(end);
+        return;
+    }
+
+    switch (share.code) {
+    case 2:   // End of Mission Failure
+    case 12:  // Pad destroyed
+    case 24:  // Hardware recovered
+    case 25:  // Minishuttle recovered
+    {
+        Branch end = {chance, FX_Failure, END_OF_MISSION, false};
+        branches.push_back(end);
+        break;
+    }
+
+    case 3:   // Kill all crew
+    case 5:   // Stranded
+    case 13:  // Kill crew, destroy pad
+    case 33:  // Kill crew on all capsules
+    {
+        bool killed = crew > 0 ||
+                      (share.code == 33 && MANNED[other(step.pad)] > 0) ||
+                      (share.code != 13 &&
+                       strncmp(GetEquipment(step)->ID, "M2", 2) == 0);
+        Branch end = {chance, killed ? FX_CrewLoss : FX_Failure,
+                      END_OF_MISSION, false
+                     };
+        branches.push_back(end);
+        break;
+    }
+
+    case 31:  // Kill LM crew
+    {
+        Branch end = {chance, FX_CrewLoss, END_OF_MISSION, false};
+        branches.push_back(end);
+        break;
+    }
+
+    case 4:   // Branch to alternate step
+    case 23:  // Retirements, branch to alternate
+    case 26:  // Safety loss, branch to alternate
+        branches.push_back(Alternate(step, index, chance));
+        break;
+
+    case 6:   // Temporary safety loss
+    {
+        Branch next = {chance, FX_Partial, index + 1, false};
+        branches.push_back(next);
+        break;
+    }
+
+    case 7:   // Permanent safety loss
+        branches.push_back(Onward(step, index, chance, FX_Partial));
+        break;
+
+    case 9:   // Recheck step
+    case 19:  // Set mission flag and recheck
+    {
+        Branch again = {chance, FX_Recheck, index, false};
+        branches.push_back(again);
+        break;
+    }
+
+    case 15:  // Scrub recommended; the computer player carries on
+    {
+        Branch scrub = {chance, FX_Partial, index + 1, true};
+        branches.push_back(scrub);
+        break;
+    }
+
+    case 16:  // VAL% injury, XTRA% of those killed
+        each = MIN(MAX(share.val, 0), 100) * MIN(MAX(share.xtra, 0), 100) / 10000.0;
+        AddDeaths(branches, IfAlive(step, index, chance),
+                  1 - pow(1 - each, crew));
+        break;
+
+    case 17:  // VAL% survival, XTRA% retirement
+        each = (100 - MIN(MAX(share.val, 0), 100)) / 100.0;
+        AddDeaths(branches, IfAlive(step, index, chance),
+                  1 - pow(1 - each, crew));
+        break;
+
+    case 18:  // Set mission flag
+        branches.push_back(Onward(step, index, chance, FX_None));
+        break;
+
+    case 22:  // EVA survival
+    {
+        Branch survived = {chance, FX_Partial, index + 1, false};
+
+        if (step.fgoto != -2) {
+            survived.next = step.fgoto;
+        }
+
+        AddDeaths(branches, survived,
+                  (99 - MIN(MAX(share.val, -1), 99)) / 100.0);
+        break;
+    }
+
+    case 30:  // Duration failure
+    {
+        Branch next = {chance, FX_Partial, index + 1, false};
+        branches.push_back(next);
+        break;
+    }
+
+    case 40:  // Minor docking failure
+    {
+        bool needed = false;
+
+        for (int k = 0; k < MAX_STEPS; k++) {
+            if (Mev[k].loc == 9 || Mev[k].loc == 26 || Mev[k].loc == 28) {
+                needed = true;
+            }
+        }
+
+        branches.push_back(needed ? Alternate(step, index, chance)
+                           : Onward(step, index, chance, FX_Partial));
+        break;
+    }
+
+    case 0:   // No effect
+    case 20:
+    default:
+        branches.push_back(Onward(step, index, chance, FX_None));
+        break;
+    }
+}
+
+
+/* The special cases ResolveMission() applies once a step is done. */
+int AfterStep(const Walk &walk, int index, int next)
+{
+    const struct MisEval &step = Mev[index];
+
+    if (step.loc == END_OF_MISSION || step.sgoto == 100) {
+        next = END_OF_MISSION;
+    }
+
+    if ((walk.code == Mission_MarsFlyby || walk.code == Mission_JupiterFlyby ||
+         walk.code == Mission_SaturnFlyby) && index == 2) {
+        next = END_OF_MISSION;
+    }
+
+    if (step.sgoto == step.fgoto && next != END_OF_MISSION) {
+        next = step.sgoto;
+    }
+
+    // Lab missions carry on after a launch failure.
+    if (next == END_OF_MISSION && index == 3) {
+        switch (walk.code) {
+        case 19:
+        case 22:
+        case 23:
+        case 30:
+        case 32:
+        case 35:
+        case 36:
+        case 37:
+            next = step.dgoto;
+
+        default:
+            break;
+        }
+    }
+
+    return next;
+}
+
+
+/* The odds from taking a branch out of a step. */
+Ends Follow(Walk &walk, int index, int next, Effect effect)
+{
+    if (effect == FX_CrewLoss) {
+        return Ends(OUT_CrewLoss);
+    }
+
+    next = AfterStep(walk, index, next);
+
+    if (next == END_OF_MISSION) {
+        return Ends(effect == FX_Failure ? OUT_Failure :
+                    effect == FX_Partial ? OUT_Partial : OUT_Success);
+    }
+
+    Ends ends = StepEnds(walk, next);
+    return (effect == FX_None) ? ends : ends.partial();
+}
+
+
+/**
+ * The odds of each outcome from a mission step on.
+ *
+ * Steps are worked out once each, since they don't depend on how the
+ * mission got to them. A step that can lead back to itself other than
+ * by a recheck is taken as a failure there.
+ */
+Ends StepEnds(Walk &walk, int index)
+{
+    while (index >= 0 && index < MAX_STEPS &&
+           GetEquipment(Mev[index]) == NULL) {
+        index++;
+    }
+
+    if (index < 0 || index >= MAX_STEPS) {
+        WARNING2("mission odds: no step %d", index);
+        return Ends(OUT_Failure);
+    }
+
+    if (Mev[index].loc == END_OF_MISSION) {
+        return Ends(OUT_Success);
+    }
+
+    if (walk.done[index]) {
+        return walk.ends[index];
+    }
+
+    if (walk.started[index]) {
+        WARNING2("mission odds: step %d loops", index);
+        return Ends(OUT_Failure);
+    }
+
+    walk.started[index] = true;
+
+    const struct MisEval &step = Mev[index];
+    const int safety = StepSafety(step, walk.inSpace);
+    const double first = PassChance(walk.plr, safety, true);
+    const double reroll = PassChance(walk.plr, safety, false);
+
+    // The step passing
+    int next = (step.sgoto == 100) ? END_OF_MISSION :
+               (step.sgoto != 0) ? step.sgoto : index + 1;
+    Ends passed = Follow(walk, index, next, FX_None);
+
+    // The step failing, apart from rechecks
+    const FailShares shares = FailureShares(step, MANNED[step.pad] > 0);
+    std::vector<Branch> branches;
+    Ends failed;
+    double recheck = 0;
+
+    for (size_t i = 0; i < shares.size(); i++) {
+        FailureBranches(index, shares[i], branches);
+    }
+
+    for (size_t i = 0; i < branches.size(); i++) {
+        if (branches[i].effect == FX_Recheck) {
+            recheck += branches[i].chance;
+            continue;
+        }
+
+        Ends ends = Follow(walk, index, branches[i].next, branches[i].effect);
+
+        if (branches[i].scrub) {
+            ends.scrub = 1;
+        }
+
+        failed.add(ends, branches[i].chance);
+    }
+
+    // A duration step is flown again for each further duration level
+    // it passes. A recheck rolls the step again, so for the rerolls
+    //   again = reroll * after + (1 - reroll) * (failed + recheck * again)
+    // and the first roll of each attempt comes out the same way.
+    bool duration = (step.loc == 27 || step.loc == 28);
+    int attempts = duration ? walk.attempts : 1;
+    Ends ends = passed;
+
+    for (int i = 0; i < attempts; i++) {
+        double pass = (i == attempts - 1) ? first : reroll;
+        Ends again;
+        again.add(ends, reroll / (1 - (1 - reroll) * recheck));
+        again.add(failed, (1 - reroll) / (1 - (1 - reroll) * recheck));
+
+        Ends attempt;
+        attempt.add(ends, pass);
+        attempt.add(failed, 1 - pass);
+        attempt.add(again, (1 - pass) * recheck);
+        ends = attempt;
+    }
+
+    if (duration) {
+        walk.attempts = 1;  // Only the first duration step repeats
+    }
+
+    walk.done[index] = true;
+    walk.ends[index] = ends;
+    return ends;
+}
+
+
+/* The inputs the odds depend on, for caching them. */
+std::string OddsKey(const Walk &walk)
+{
+    std::string key;
+    int values[] = {
+        walk.plr, walk.code, walk.attempts, walk.inSpace,
+        AI[walk.plr], MANNED[0], MANNED[1], options.want_cheats,
+        (walk.plr == 0) ? Data->Def.Lev1 : Data->Def.Lev2
+    };
+
+    key.append((const char *)values, sizeof(values));
+
+    for (int i = 0; i < MAX_STEPS && Mev[i].loc != END_OF_MISSION; i++) {
+        const struct MisEval &step = Mev[i];
+        const Equipment *e = step.Ep;
+        int fields[] = {
+            step.loc, step.pad, step.sgoto, step.fgoto, step.dgoto,
+            e ? StepSafety(step, walk.inSpace) : -1
+        };
+
+        key.append((const char *)fields, sizeof(fields));
+        key.append(step.FName, sizeof(step.FName));
+        key.append(step.Name, 2);
+        key.append(e ? e->ID : "--", 2);
+    }
+
+    return key;
+}
+};
+
+
+/**
+ * Work out the odds of each outcome of the mission staged in Mev.
+ *
+ * Call this where MisCheck() would be called: after the mission's
+ * hardware, crew and steps are set up and its penalties applied.
+ * Results are cached by the mission's steps, with the safety of the
+ * hardware and crew for each, so asking again costs little.
+ *
+ * \param plr  the player flying the mission.
+ * \param mpad  the launch pad of the (first) mission.
+ * \return  the odds of each outcome.
+ */
+struct MissionOdds StagedMissionOdds(char plr, char mpad)
+{
+    Walk walk;
+    memset(walk.started, 0, sizeof(walk.started));
+    memset(walk.done, 0, sizeof(walk.done));
+    walk.plr = plr;
+    walk.code = Data->P[plr].Mission[mpad].MissionCode;
+    walk.inSpace = (MANNED[0] > 0) + (MANNED[1] > 0);
+
+    int levels = Data->P[plr].Mission[mpad].Duration - 1;
+
+    if (JOINT == 1) {
+        levels = MAX(levels, Data->P[plr].Mission[mpad + 1].Duration - 1);
+    }
+
+    walk.attempts = MAX(1, levels);
+
+    std::string key = OddsKey(walk);
+
+    {
+        std::lock_guard<std::mutex> guard(cacheLock);
+        std::unordered_map<std::string, MissionOdds>::const_iterator it =
+            oddsCache.find(key);
+
+        if (it != oddsCache.end()) {
+            return it->second;
+        }
+    }
+
+    Ends ends = StepEnds(walk, 0);
+    struct MissionOdds odds;
+    odds.success = ends.p[OUT_Success];
+    odds.partial = ends.p[OUT_Partial];
+    odds.failure = ends.p[OUT_Failure];
+    odds.crewLoss = ends.p[OUT_CrewLoss];
+    odds.scrub = ends.scrub;
+
+    std::lock_guard<std::mutex> guard(cacheLock);
+
+    if (oddsCache.size() >= MAX_CACHED) {
+        oddsCache.clear();
+    }
+
+    oddsCache[key] = odds;
+    return odds;
+}
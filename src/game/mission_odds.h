@@ -0,0 +1,22 @@
+#ifndef MISSION_ODDS_H
+#define MISSION_ODDS_H
+
+/**
+ * The chances of each way a staged mission can end.
+ *
+ * success, partial, failure and crewLoss add up to 1. scrub overlaps
+ * them: it is the chance a scrub is recommended at some step, after
+ * which the odds assume the mission carries on, as the computer
+ * player's always does.
+ */
+struct MissionOdds {
+    double success;   // Reached the end with every step passed
+    double partial;   // Reached the end after a step failure
+    double failure;   // Ended early, with the crew unharmed
+    double crewLoss;  // A crew member was killed
+    double scrub;     // A scrub was recommended along the way
+};
+
+struct MissionOdds StagedMissionOdds(char plr, char mpad);
+
+#endif // MISSION_ODDS_H
@@ -8,6 +8,7 @@
 
 #include "Buzz_inc.h"
 #include "ioexception.h"
+#include "json_cache.h"
 #include "logging.h"
 #include "draw.h"
 #include "gr.h"
@@ -20,9 +21,10 @@ namespace
     bool MarsInRange(unsigned int year, unsigned int season);
     bool JupiterInRange(unsigned int year, unsigned int season);
     bool SaturnInRange(unsigned int year, unsigned int season);
-};
 
-std::vector<struct mStr> missionData;
+    std::vector<struct mStr> missionData;
+    std::vector<uint16_t> missionFlags;  // MissionFlag bits, by mission
+};
 
 //----------------------------------------------------------------------
 // Header function definitions
@@ -63,7 +65,7 @@ bool Equals(const struct MissionType &m1, const struct MissionType &m2)
  */
 bool IsDocking(const int mission)
 {
-    return ((GetMissionPlan(mission).Doc >= 1) ? true : false);
+    return GetMissionFlags(mission) & MISSION_DOCKING;
 }
 
 
@@ -72,9 +74,8 @@ bool IsDocking(const int mission)
  *
  * This implementation depends upon strict mission numbering, so any
  * changes to the mission data file could result in errors.
- * A more durable implementation would load the corresponding mission
- * from the data file and check its duration field. However, this
- * approach is fast and doesn't rely on file I/O.
+ * It is not the same as MISSION_DURATION (mStr.Dur), which is also
+ * set for the joint orbiting labs (32 and 36).
  *
  * \param mission  The type per mStr.Index or MissionType.MissionCode.
  * \return  true if a duration-adjustable mission, false otherwise.
@@ -95,7 +96,7 @@ bool IsDuration(int mission)
  */
 bool IsEVA(int mission)
 {
-    return GetMissionPlan(mission).EVA >= 1;
+    return GetMissionFlags(mission) & MISSION_EVA;
 }
 
 
@@ -107,7 +108,7 @@ bool IsEVA(int mission)
  */
 bool IsJoint(int mission)
 {
-    return GetMissionPlan(mission).Jt >= 1;
+    return GetMissionFlags(mission) & MISSION_JOINT;
 }
 
 
@@ -143,7 +144,7 @@ bool IsLEORegion(int mission)
  */
 bool IsLM(int mission)
 {
-    return GetMissionPlan(mission).LM >= 1;
+    return GetMissionFlags(mission) & MISSION_LM;
 }
 
 
@@ -193,8 +194,21 @@ bool IsLunarLanding(int mission)
  */
 bool IsManned(int mission)
 {
-    char mCrew = GetMissionPlan(mission).mCrew;
-    return (mCrew == 2 || mCrew == 3 || mCrew == 4);
+    return GetMissionFlags(mission) & MISSION_MANNED;
+}
+
+
+/**
+ * Gets the kind of crew the mission takes.
+ *
+ * \param mission  The type per mStr.Index or MissionType.MissionCode.
+ * \return  the mission's mStr.mCrew: 0 and 1 for unmanned missions,
+ *          2 to 4 for the manned crew types, 5 for unmanned joint.
+ * \throws IOException  if unable to load the mission template.
+ */
+int MissionCrewType(int mission)
+{
+    return (GetMissionFlags(mission) & MISSION_CREW) >> MISSION_CREW_SHIFT;
 }
 
 
@@ -239,44 +253,70 @@ const char *GetDurationParens(int duration)
 
 
 /**
- * Cache a subset of mission data in a local array.
+ * Get the table of mission templates.
  *
- * Populates the global vector missionData with stored mission data.
+ * The table is read from "mission.json" on first use and is not
+ * modified afterwards, so references into it remain valid.
+ *
+ * \return  the mission templates, indexed by mStr.Index.
+ * \throws IOException  if unable to read mission.json.
  */
-std::vector<struct mStr> GetMissionData()
-{       
-    // Deserialize Mission Data
-    std::ifstream file(locate_file("mission.json", FT_DATA));
-    if (!file) {
-      throw IOException("Error. Could not open mission.json");
+const std::vector<struct mStr> &GetMissionData()
+{
+    if (missionData.empty()) {
+        std::vector<struct mStr> missions;
+        DeserializeCachedJSON(&missions, "mission.json");
+
+        std::vector<uint16_t> flags(missions.size(), 0);
+
+        for (size_t i = 0; i < missions.size(); i++) {
+            const struct mStr &plan = missions[i];
+            char mCrew = plan.mCrew;
+
+            flags[i] = (plan.Doc >= 1 ? MISSION_DOCKING : 0) |
+                       (plan.EVA >= 1 ? MISSION_EVA : 0) |
+                       (plan.Jt >= 1 ? MISSION_JOINT : 0) |
+                       (plan.LM >= 1 ? MISSION_LM : 0) |
+                       (plan.Dur >= 1 ? MISSION_DURATION : 0) |
+                       (mCrew == 2 || mCrew == 3 || mCrew == 4
+                        ? MISSION_MANNED : 0) |
+                       ((mCrew << MISSION_CREW_SHIFT) & MISSION_CREW);
+        }
+
+        missionFlags.swap(flags);
+        missionData.swap(missions);
+        DEBUG1("missionData successfully uploaded.");
     }
 
-    cereal::JSONInputArchive ar(file);
-    ar(CEREAL_NVP(missionData));
-    DEBUG1("missionData successfully uploaded.");
     return missionData;
 }
 
 
 /* Gets the mission template for the specified mission code.
- *
- * Opens "mission.json" and loads the mission data from the file.
- *
  *
  * \param code  A unique index for the mission.
  * \return  the mStr with the given mStr.Index value.
- * \throws IOException  if unable to read MISSION.DAT.
+ * \throws IOException  if unable to read mission.json.
  */
-struct mStr GetMissionPlan(const int code)
+const struct mStr &GetMissionPlan(const int code)
 {
-    if (missionData.empty()) {
+    return GetMissionData()[code];
+}
+
+
+/* Gets the precomputed properties of a mission type.
+ *
+ * \param mission  The type per mStr.Index or MissionType.MissionCode.
+ * \return  a combination of MissionFlag bits.
+ * \throws IOException  if unable to read mission.json.
+ */
+unsigned int GetMissionFlags(int mission)
+{
+    if (missionFlags.empty()) {
         GetMissionData();
     }
-    
-    mStr mission = missionData[code];
-    TRACE2("mission plan `%d' loaded.", code);
-    
-    return mission;
+
+    return missionFlags[mission];
 }
 
 
@@ -297,7 +337,7 @@ void DrawMissionName(int val, int posX, int posY, int len)
 
     grMoveTo(posX, posY);
     
-    mStr mission = GetMissionPlan(val);    
+    const struct mStr &mission = GetMissionPlan(val);
     
     for (i = 0; i < 50; i++) {
         if (j > len && mission.Name[i] == ' ') {
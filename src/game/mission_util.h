@@ -3,11 +3,24 @@
 
 #include <vector>
 
+/* Properties of a mission type, as returned by GetMissionFlags(). */
+enum MissionFlag {
+    MISSION_DOCKING = 0x01,   /**< mStr.Doc */
+    MISSION_EVA = 0x02,       /**< mStr.EVA */
+    MISSION_JOINT = 0x04,     /**< mStr.Jt */
+    MISSION_LM = 0x08,        /**< mStr.LM */
+    MISSION_DURATION = 0x10,  /**< mStr.Dur */
+    MISSION_MANNED = 0x20,    /**< mStr.mCrew is a manned type */
+    MISSION_CREW = 0x700      /**< mStr.mCrew, see MissionCrewType() */
+};
+
+const int MISSION_CREW_SHIFT = 8;
 
 bool Equals(const struct MissionType &m1, const struct MissionType &m2);
 const char *GetDurationParens(int duration);
-std::vector<struct mStr> GetMissionData();
-struct mStr GetMissionPlan(int code);
+const std::vector<struct mStr> &GetMissionData();
+const struct mStr &GetMissionPlan(int code);
+unsigned int GetMissionFlags(int mission);
 void DrawMissionName(int val, int posX, int posY, int len);
 bool IsDocking(int mission);
 bool IsDuration(int mission);
@@ -17,6 +30,7 @@ bool IsLEORegion(int mission);
 bool IsLunarLanding(int mission);
 bool IsLM(int mission);
 bool IsManned(int mission);
+int MissionCrewType(int mission);
 bool MissionTimingOk(int mission, unsigned int year, unsigned int season);
 
 
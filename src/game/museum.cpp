@@ -1495,7 +1495,7 @@ void DisplAstData(char plr, char *where, char *where2, display::LegacySurface *v
     display::graphics.setForegroundColor(9);
     draw_string(43, 45, &Data->P[plr].History[num].MissionName[0][0]);
 
-    const struct mStr type =
+    const struct mStr &type =
         GetMissionPlan(Data->P[plr].History[num].MissionCode);
     draw_string(10, 93, (type.Abbr).c_str());
 
@@ -1525,7 +1525,7 @@ void DisplAstData(char plr, char *where, char *where2, display::LegacySurface *v
     display::graphics.setForegroundColor(9);
     draw_string(43, 120, &Data->P[plr].History[num2].MissionName[0][0]);
 
-    const struct mStr type2 =
+    const struct mStr &type2 =
         GetMissionPlan(Data->P[plr].History[num2].MissionCode);
     draw_string(10, 168, (type2.Abbr).c_str());
 
@@ -42,7 +42,7 @@
 #include "filesystem.h"
 #include "pbm.h"
 
-struct order Order[7] ;
+GAME_LOCAL struct order Order[7] ;
 
 char Month[12][11] = {
     "JANUARY ", "FEBRUARY ", "MARCH ", "APRIL ", "MAY ", "JUNE ",
@@ -92,7 +92,7 @@ cmp_order(const void *p1, const void *p2)
                 }
             }
 
-            return (brandom(2) == 1) ? 1 : -1;
+            return (brandom(2, RNG_Mission) == 1) ? 1 : -1;
         } else {
             return 1;
         }
@@ -221,8 +221,7 @@ void MisAnn(char plr, char pad)
     // without including a docking module.
     if ((plan.mVab[0] & 0x10) == 0x10 &&
         Data->P[plr].DockingModuleInOrbit <= 0) {
-        Downgrader::Options options = LoadJsonDowngrades("DOWNGRADES.JSON");
-        Downgrader replace(Data->P[plr].Mission[pad], options);
+        Downgrader replace(Data->P[plr].Mission[pad], *GetDowngrades());
         MissionType downgrade;
 
         //  Assumes Mission_None is not a docking mission...
@@ -602,6 +601,13 @@ void MisAnn(char plr, char pad)
 
 void AI_Begin(char plr)
 {
+    present_computer_turn(true);
+
+    // An instant turn shows nothing while the computer thinks
+    if (presentation_speed() == PRESENT_INSTANT) {
+        return;
+    }
+
     boost::shared_ptr<display::PalettizedSurface> countrySeals(Filesystem::readImage("images/turn.but.0.png"));
     countrySeals->exportPalette();
 
@@ -634,7 +640,11 @@ void AI_Begin(char plr)
 
 void AI_Done(void)
 {
-    music_stop();
-    FadeOut(2, 10, 0, 0);
-    display::graphics.screen()->clear();
+    if (presentation_speed() != PRESENT_INSTANT) {
+        music_stop();
+        FadeOut(2, 10, 0, 0);
+        display::graphics.screen()->clear();
+    }
+
+    present_computer_turn(false);
 }
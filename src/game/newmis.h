@@ -1,12 +1,14 @@
 #ifndef NEWMIS_H
 #define NEWMIS_H
 
+#include "game_context.h"
+
 void MisAnn(char plr, char pad);
 void AI_Begin(char plr);
 void AI_Done(void);
 char OrderMissions(void);
 
 extern char Month[12][11];
-extern struct order Order[7];
+extern GAME_LOCAL struct order Order[7];
 
 #endif // NEWMIS_H
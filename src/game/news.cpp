@@ -35,6 +35,7 @@
 #include "display/palettized_surface.h"
 
 #include "news.h"
+#include "asset_registry.h"
 #include "gamedata.h"
 #include "draw.h"
 #include "Buzz_inc.h"
@@ -59,7 +60,7 @@ double load_news_anim_start;
 #define FIRST_FRAME 0
 #define TOMS_BUGFIX 69
 
-int evflag;
+GAME_LOCAL int evflag;
 static int bufsize, LOAD_US = 0, LOAD_SV = 0;
 static int Frame, MaxFrame, AnimIndex = 255;
 
@@ -81,10 +82,40 @@ static int news_index[2][2][3] = {
     },
 };
 
-static std::vector<std::string> event;
-static std::vector<std::string> naut_news;
-static std::vector<std::string> reasons;
-static std::vector<std::string> news;
+static GAME_LOCAL std::vector<std::string> event;
+static GAME_LOCAL std::vector<std::string> naut_news;
+static GAME_LOCAL std::vector<std::string> reasons;
+static GAME_LOCAL std::vector<std::string> news;
+
+/* The texts of event.json, for both sides. */
+struct EventText {
+    std::vector<std::string> us_event;
+    std::vector<std::string> sov_event;
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(CEREAL_NVP(us_event), CEREAL_NVP(sov_event));
+    }
+};
+
+/* The texts of news.json, for both sides. */
+struct NewsText {
+    std::vector<std::string> astro_news;
+    std::vector<std::string> us_reasons;
+    std::vector<std::string> us_news;
+    std::vector<std::string> cosmo_news;
+    std::vector<std::string> sov_reasons;
+    std::vector<std::string> sov_news;
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(CEREAL_NVP(astro_news), CEREAL_NVP(us_reasons),
+           CEREAL_NVP(us_news), CEREAL_NVP(cosmo_news),
+           CEREAL_NVP(sov_reasons), CEREAL_NVP(sov_news));
+    }
+};
 
 struct rNews {
     int16_t offset;
@@ -292,10 +323,10 @@ void OpenNews(char plr, char *buf, int bud)
 
     if (plr == 0) {
         // Pool of 6 us news per year
-        i = (Data->Year - 57) * 6 + Data->Season * 3 + brandom(3) + 1;
+        i = (Data->Year - 57) * 6 + Data->Season * 3 + brandom(3, RNG_Cosmetic) + 1;
     } else {
         // Pool of 4 soviet news per year
-        i = (Data->Year - 57) * 4 + Data->Season * 2 + brandom(2) + 1;
+        i = (Data->Year - 57) * 4 + Data->Season * 2 + brandom(2, RNG_Cosmetic) + 1;
     }
 
     strncpy(&buf[bufsize], news[i].c_str(), news[i].size());
@@ -883,7 +914,8 @@ PlayNewsAnim(mm_file *fp)
     double fps = 15;            /* TODO hardcoded fps here! */
     int skip_frame = 0;
 
-    if (Frame == MaxFrame) {
+    // An instant presentation stays on the first frame
+    if (Frame == MaxFrame || presentation_speed() == PRESENT_INSTANT) {
         return 1;
     }
 
@@ -1086,35 +1118,27 @@ ShowEvt(char plr, char crd)
 
 void LoadEventData(char plr) {
     // Deserialize Events
-    std::ifstream file(locate_file("event.json", FT_DATA));
-    if (!file) {
-        throw std::runtime_error("event.json could not be opened.");
-    }
-    cereal::JSONInputArchive ar(file);
-    
-    if (plr == 0) {
-        ar(cereal::make_nvp("us_event", event));
-    } else {
-        ar(cereal::make_nvp("sov_event", event));
-    }
+    boost::shared_ptr<const EventText> text =
+        AssetRegistry::get<EventText,
+        DataAsset<EventText, JsonCache::Fields<EventText> > >("event.json");
+
+    event = (plr == 0) ? text->us_event : text->sov_event;
 }
 
 void LoadNewsData(char plr) {
     // Deserialize Nauts and Historic News
-    std::ifstream file(locate_file("news.json", FT_DATA));
-    if (!file) {
-        throw std::runtime_error("news.json could not be opened.");
-    }
-    cereal::JSONInputArchive ar(file);
-    
+    boost::shared_ptr<const NewsText> text =
+        AssetRegistry::get<NewsText,
+        DataAsset<NewsText, JsonCache::Fields<NewsText> > >("news.json");
+
     if (plr == 0) {
-        ar(cereal::make_nvp("astro_news", naut_news));
-        ar(cereal::make_nvp("us_reasons", reasons));
-        ar(cereal::make_nvp("us_news", news));
+        naut_news = text->astro_news;
+        reasons = text->us_reasons;
+        news = text->us_news;
     } else {
-        ar(cereal::make_nvp("cosmo_news", naut_news));
-        ar(cereal::make_nvp("sov_reasons", reasons));
-        ar(cereal::make_nvp("sov_news", news));
+        naut_news = text->cosmo_news;
+        reasons = text->sov_reasons;
+        news = text->sov_news;
     }
 }
 
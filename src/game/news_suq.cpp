@@ -23,6 +23,7 @@
 #include <algorithm>
 
 #include "Buzz_inc.h"
+#include "asset_registry.h"
 #include "astros.h"
 #include "game_main.h"
 #include "mission_util.h"
@@ -104,8 +105,10 @@ char REvent(char plr)
              }            
         }
 
-        std::vector<int> nTable; // vector for NTABLE
-        DESERIALIZE_JSON_FILE(&nTable, locate_file("ntable.json", FT_DATA));
+        // vector for NTABLE
+        boost::shared_ptr<const std::vector<int> > table =
+            AssetRegistry::get<std::vector<int> >("ntable.json");
+        const std::vector<int> &nTable = *table;
         //int index =  (plr * 60) + (j * 10) + brandom(10);
         int index =  (j * 10) + brandom(10); // The first table is used for both players
         // TODO; Change the budget table (+60 / +120) according to difficulty
@@ -710,7 +713,7 @@ char REvent(char plr)
 
     case 64:  /* launch facility repair 10MB's */
         for (j = 0; j < 20; j++) {
-            i = rand() % 3;
+            i = brandom(3);
 
             if (Data->P[plr].LaunchFacility[i] == 1 
             && Data->P[plr].Mission[i].MissionCode == Mission_None) {
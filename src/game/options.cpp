@@ -116,10 +116,37 @@ static const struct {
 	"By default now the game is displayed at 4x scale."
 	"\n# Set to 0 if you want to display the game at the classic 2x scale."
     },
+    {
+        "presentation_speed", &options.presentation_speed, "%u", 0,
+        "Set how much of the game's presentation is played out:"
+        "\n#   0  Normal - every fade, pause and animation"
+        "\n#   1  Fast - no fades or pauses"
+        "\n#   2  Instant - no videos or animations either, only the screens they lead to"
+    },
+    {
+        "ai_turn_speed", &options.ai_turn_speed, "%u", 0,
+        "Set the presentation speed, as above, for the computer player's turn."
+        "\n# Set to 2 to have the computer play its turn with nothing shown."
+    },
     {
         "debuglevel", &options.want_debug, "%u", 0,
         "Set to positive values to increase debugging verbosity."
     },
+    {
+        "json_saves", &options.want_json_saves, "%u", 0,
+        "Set to 1 to write save games as JSON instead of the compact binary format."
+        "\n# JSON saves are larger and slower, but readable once decompressed."
+    },
+    {
+        "save_history", &options.want_save_history, "%u", 0,
+        "Set to 1 to keep the start of every turn of the game in binary save games,"
+        "\n# so an earlier turn can be returned to after loading."
+    },
+    {
+        "pbem_full_saves", &options.want_pbem_full_saves, "%u", 0,
+        "Set to 1 to always send the whole game in play-by-mail saves."
+        "\n# Otherwise only the changes since the opponent's last turn are sent."
+    },
     {
         "game_style", &options.classic, "%u", 0,
         "Set to 1 to play the game in the classic style."
@@ -209,6 +236,12 @@ static const struct {
         "\n#   1: Minimum Safety - Boosted rocket = rocket or booster, whichever is lower"
         "\n#   2: Average Safety (Classic setting) - Boosted rocket = average of rocket & booster"
     },
+    {
+        "ai_planner", &options.ai_planner, "%u", 0,
+        "Set to a number of milliseconds to let the computer player weigh its choice of"
+        "\n# mission against the others it could fly, by their odds, for up to that long"
+        "\n# each turn. Set to 0 to use the fixed rules alone (Classic setting)."
+    },
 };
 
 
@@ -227,14 +260,57 @@ static void
 usage(int fail)
 {
     fprintf(stderr, "usage:   raceintospace [options...]\n"
-            "options: -a -i -f -s -v -n\n"
+            "options: -a -i -f -s -v -n --seed=N --simulate [--games=N --jobs=N --csv=FILE]\n"
+            "         --journal=FILE --replay=FILE [--replay-to=N] --bench-ai[=N]\n"
             "\t-v verbose mode\n\t\tadd this several times to get to DEBUG level\n"
             "\t-f fullscreen mode\n"
 	    "\t-s 4x scale mode\n"
+            "\t--seed=N start the random number generators from N\n"
+            "\t--simulate play a computer-vs-computer game without display,\n"
+            "\t\tand print the result as JSON\n"
+            "\t--games=N simulate N games and print statistics over them\n"
+            "\t--jobs=N play simulated games in N processes (default: one per CPU)\n"
+            "\t--csv=FILE write a line per simulated game to FILE\n"
+            "\t--journal=FILE record the games played to FILE, to replay\n"
+            "\t--replay=FILE replay the last game in a journal without display,\n"
+            "\t\tcheck it plays the same, and print the result as JSON\n"
+            "\t--replay-to=N stop the replay at turn N and save it as JOURNAL.SAV\n"
+            "\t--bench-ai[=N] time the computer player's turn over N runs\n"
+            "\t\t(default 10) of a simulated game, and print the result as JSON;\n"
+            "\t\tmemory allocations are only counted in builds configured\n"
+            "\t\twith -DBENCH_ALLOCATIONS=ON\n"
            );
     exit((fail) ? EXIT_FAILURE : EXIT_SUCCESS);
 }
 
+/** reads a count given to an option
+ *
+ * \param text the digits given
+ * \param max the largest count allowed
+ * \param value receives the count
+ * \return 0 unless text is a whole number from 1 to max
+ */
+static int
+parse_count(const char *text, unsigned long max, unsigned *value)
+{
+    char *end = NULL;
+    unsigned long count;
+
+    if (!isdigit((unsigned char)text[0])) {
+        return 0;
+    }
+
+    errno = 0;
+    count = strtoul(text, &end, 10);
+
+    if (errno || *end != '\0' || count < 1 || count > max) {
+        return 0;
+    }
+
+    *value = count;
+    return 1;
+}
+
 static void
 shift_argv(char **argv, int len, int shift)
 {
@@ -478,6 +554,21 @@ void ResetToDefaultOptions()
     options.want_fullscreen = 0;
     options.want_4xscale = 1;
     options.want_debug = 0;
+    options.presentation_speed = 0;
+    options.ai_turn_speed = 0;
+    options.want_simulate = 0;
+    options.sim_games = 0;
+    options.sim_jobs = 0;
+    options.sim_csv = NULL;
+    options.journal_file = NULL;
+    options.replay_file = NULL;
+    options.replay_to = 0;
+    options.bench_ai = 0;
+    options.want_rng_seed = 0;
+    options.rng_seed = 0;
+    options.want_json_saves = 0;
+    options.want_save_history = 0;
+    options.want_pbem_full_saves = 0;
 
     // Gameplay aspects
     options.classic = 0;
@@ -497,6 +588,7 @@ void ResetToDefaultOptions()
     options.feat_random_eq = 0;
     options.feat_eq_new_name = 0;
     options.boosterSafety = 0;
+    options.ai_planner = 0;
 
     // Cheats
     //Damaged Equipment Cheat, Nikakd, 10/8/10
@@ -516,6 +608,7 @@ void ResetToDefaultOptions()
 void ResetToClassicOptions()
 {
     options.boosterSafety = 2;
+    options.ai_planner = 0;
     options.feat_shorter_advanced_training = 0;
     options.feat_female_nauts = 0;
     options.feat_compat_nauts = 10;
@@ -606,6 +699,61 @@ setup_options(int argc, char *argv[])
             options.want_4xscale = 0;
         } else if (strcmp(str, "-v") == 0) {
             options.want_debug++;
+        } else if (strncmp(str, "--seed=", 7) == 0) {
+            char *end = NULL;
+
+            options.rng_seed = strtoull(str + 7, &end, 0);
+
+            if (end == str + 7 || *end != '\0') {
+                ERROR2("bad random seed %s", str + 7);
+                usage(1);
+            }
+
+            options.want_rng_seed = 1;
+        } else if (strcmp(str, "--simulate") == 0) {
+            options.want_simulate = 1;
+            options.want_intro = 0;
+            options.want_audio = 0;
+        } else if (strncmp(str, "--games=", 8) == 0) {
+            if (!parse_count(str + 8, 1000000, &options.sim_games)) {
+                ERROR2("bad number of games %s", str + 8);
+                usage(1);
+            }
+        } else if (strncmp(str, "--jobs=", 7) == 0) {
+            if (!parse_count(str + 7, 256, &options.sim_jobs)) {
+                ERROR2("bad number of jobs %s", str + 7);
+                usage(1);
+            }
+        } else if (strncmp(str, "--csv=", 6) == 0) {
+            free(options.sim_csv);
+            options.sim_csv = xstrdup(str + 6);
+        } else if (strncmp(str, "--journal=", 10) == 0) {
+            free(options.journal_file);
+            options.journal_file = xstrdup(str + 10);
+        } else if (strncmp(str, "--replay=", 9) == 0) {
+            free(options.replay_file);
+            options.replay_file = xstrdup(str + 9);
+            options.want_simulate = 1;
+            options.want_intro = 0;
+            options.want_audio = 0;
+        } else if (strncmp(str, "--replay-to=", 12) == 0) {
+            if (!parse_count(str + 12, 1000, &options.replay_to)) {
+                ERROR2("bad turn to replay to %s", str + 12);
+                usage(1);
+            }
+        } else if (strcmp(str, "--bench-ai") == 0 ||
+                   strncmp(str, "--bench-ai=", 11) == 0) {
+            options.bench_ai = 10;
+
+            if (str[10] == '=' &&
+                !parse_count(str + 11, 1000000, &options.bench_ai)) {
+                ERROR2("bad number of benchmark runs %s", str + 11);
+                usage(1);
+            }
+
+            options.want_simulate = 1;
+            options.want_intro = 0;
+            options.want_audio = 0;
         } else {
             ERROR2("unknown option %s", str);
             usage(1);
@@ -10,6 +10,21 @@ typedef struct {
     unsigned want_intro;
     unsigned want_cheats;
     unsigned want_debug;
+    unsigned presentation_speed;
+    unsigned ai_turn_speed;
+    unsigned want_simulate;
+    unsigned sim_games;
+    unsigned sim_jobs;
+    char *sim_csv;
+    char *journal_file;
+    char *replay_file;
+    unsigned replay_to;
+    unsigned bench_ai;
+    unsigned want_rng_seed;
+    unsigned long long rng_seed;
+    unsigned want_json_saves;
+    unsigned want_save_history;
+    unsigned want_pbem_full_saves;
     unsigned classic;
     unsigned feat_shorter_advanced_training;
     unsigned feat_female_nauts;
@@ -26,6 +41,7 @@ typedef struct {
     unsigned cheat_atlasOnMoon;
     unsigned cheat_addMaxS;
     unsigned boosterSafety;
+    unsigned ai_planner;
 } game_options;
 
 extern game_options options;
@@ -10,13 +10,14 @@
 
 #include "Buzz_inc.h"
 #include "utils.h"
+#include "options.h"
 #include "game_main.h"
 #include "sdlhelper.h"
 #include "gr.h"
 #include "mmfile.h"
+#include "records.h"
 
 
-void randomize(void);
 double get_time(void);
 
 
@@ -184,6 +185,10 @@ void FadeIn(char wh, int steps, int val, char mode)
     int from = 0;
     int to = 256;
 
+    if (options.want_simulate) {
+        return;
+    }
+
     if (wh == 0) {
         to = val;
     } else if (wh == 1) {
@@ -200,6 +205,10 @@ void FadeOut(char wh, int steps, int val, char mode)
     int from = 0;
     int to = 256;
 
+    if (options.want_simulate) {
+        return;
+    }
+
     if (wh == 0) {
         to = val;
     } else if (wh == 1) {
@@ -211,6 +220,41 @@ void FadeOut(char wh, int steps, int val, char mode)
     av_set_fading(AV_FADE_OUT, from, to, steps, !!mode);
 }
 
+static GAME_LOCAL bool computerTurn = false;
+
+/**
+ * How quickly the game is presented right now.
+ *
+ * The presentation_speed option sets it, or ai_turn_speed during the
+ * computer's half of a turn if that is faster. Simulations show
+ * nothing, so are always instant.
+ */
+PresentationSpeed presentation_speed(void)
+{
+    unsigned speed = options.presentation_speed;
+
+    if (options.want_simulate) {
+        return PRESENT_INSTANT;
+    }
+
+    if (computerTurn) {
+        speed = MAX(speed, options.ai_turn_speed);
+    }
+
+    return (PresentationSpeed)MIN(speed, (unsigned)PRESENT_INSTANT);
+}
+
+/**
+ * Mark the start or end of the computer's half of a turn.
+ *
+ * \param computer  true as the computer starts to play, false once
+ *                  it is done.
+ */
+void present_computer_turn(bool computer)
+{
+    computerTurn = computer;
+}
+
 void delay(int millisecs)
 {
     idle_loop_secs(millisecs / 1000.0);
@@ -221,13 +265,16 @@ void bzdelay(int ticks)
     idle_loop_secs(ticks / 100.0);
 }
 
-int brandom(int limit)
+/**
+ * \return  a random number from 0 to limit - 1.
+ */
+int brandom(int limit, RngStream stream)
 {
     if (limit == 0) {
         return (0);
     }
 
-    return (int)(limit * (rand() / (RAND_MAX + 1.0)));
+    return (int)(limit * gameRng.stream(stream).uniform());
 }
 
 void StopAudio(char mode)
@@ -238,17 +285,22 @@ void StopAudio(char mode)
 void CloseEmUp(unsigned char error, unsigned int value)
 {
     /* DEBUG */ /* fprintf (stderr, "CloseEmUp()\n"); */
+    FlushRecords();
     exit(EXIT_SUCCESS);
 }
 
+/* Seed the game's generators, from the command line if a seed was
+ * given there. */
 void randomize(void)
 {
-    srand(get_time() * 1000);
+    gameRng.seed(options.want_rng_seed ? options.rng_seed : ClockSeed());
+    INFO2("random seed %llu", (unsigned long long)gameRng.seedValue());
 }
 
 /** do nothing for a few seconds.
  *
  * The function will wait a number of seconds but will call av_block() in the meantime.
+ * Simulations don't wait at all, nor does a fast or instant presentation.
  *
  * \param secs Number of seconds to wait.
  */
@@ -256,8 +308,18 @@ void idle_loop_secs(double secs)
 {
     double start;
 
+    if (options.want_simulate) {
+        return;
+    }
+
     gr_sync();
 
+    // Keep up with events, but don't wait
+    if (presentation_speed() >= PRESENT_FAST) {
+        av_step();
+        return;
+    }
+
     start = get_time();
 
     while (1) {
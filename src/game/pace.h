@@ -6,6 +6,7 @@
 #include <SDL.h>
 
 #include "raceintospace_config.h"
+#include "rng.h"
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -13,11 +14,22 @@
 #include "fake_unistd.h"
 #endif
 
+/* How much of the game's presentation is played out. */
+enum PresentationSpeed {
+    PRESENT_NORMAL,   // Every fade, delay and animation
+    PRESENT_FAST,     // No fades or delays
+    PRESENT_INSTANT   // Nor videos or animations; only final screens
+};
+
+PresentationSpeed presentation_speed(void);
+void present_computer_turn(bool computer);
 void delay(int millisecs);
+void CloseEmUp(unsigned char error, unsigned int value);
 void FadeIn(char wh, int steps, int val, char mode);
 void FadeOut(char wh, int steps, int val, char mode);
 int PCX_D(const char *src, char *dest, unsigned src_size);
-int brandom(int limit);
+int brandom(int limit, RngStream stream = RNG_Events);
+void randomize(void);
 int RLED_img(const char *src, char *dest, unsigned int src_size,
              int w, int h);
 char *seq_filename(int seq, int mode);
@@ -25,12 +25,120 @@
 
 // This file handles play by e-mail.
 
+#include <algorithm>
+#include <sstream>
+
+#include <cereal/archives/portable_binary.hpp>
+#include <zlib.h>
+
 #include "admin.h"
+#include "Buzz_inc.h"
+#include "byte_delta.h"
 #include "data.h"
 #include "game_main.h"
 #include "pace.h"
 #include "pbm.h"
 #include "review.h"
+#include "zlib_stream.h"
+
+LOG_DEFAULT_CATEGORY(LOG_ROOT_CAT)
+
+
+namespace
+{
+// The serialized state last received from the opponent
+std::string pbemBase;
+
+// The hash of the last state sent that the opponent replied to
+uint32_t ackedHash = 0;
+
+uint32_t StateHash(const std::string &state)
+{
+    return crc32(0L, (const Bytef *)state.data(), state.size());
+}
+
+/* Sent states are kept in the save directory, named by their hash. */
+std::string StateFileName(uint32_t hash)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "PBEM_%08X.BAS", hash);
+    return name;
+}
+
+/*
+ * A sent state's file starts with the hash of the state sent before it
+ * in the game, four bytes little-endian, so that it can be removed when
+ * the opponent replies to this one.
+ */
+bool ReadPreviousHash(FILE *fin, uint32_t &previous)
+{
+    uint8_t header[4];
+
+    previous = 0;
+
+    if (fread(header, 1, sizeof(header), fin) != sizeof(header)) {
+        return false;
+    }
+
+    for (int i = 3; i >= 0; i--) {
+        previous = (previous << 8) | header[i];
+    }
+
+    return true;
+}
+
+/* The hash of the state sent before a sent state, or 0 if unknown. */
+uint32_t PreviousHash(uint32_t hash)
+{
+    uint32_t previous = 0;
+    FILE *fin = sOpen(StateFileName(hash).c_str(), "rb", FT_SAVE_CHECK);
+
+    if (fin != NULL) {
+        ReadPreviousHash(fin, previous);
+        fclose(fin);
+    }
+
+    return previous;
+}
+
+/* Read a sent state, or the one last received. */
+bool LoadPbemState(uint32_t hash, std::string &state)
+{
+    if (!pbemBase.empty() && StateHash(pbemBase) == hash) {
+        state = pbemBase;
+        return true;
+    }
+
+    FILE *fin = sOpen(StateFileName(hash).c_str(), "rb", FT_SAVE_CHECK);
+
+    if (fin == NULL) {
+        return false;
+    }
+
+    uint32_t previous;
+
+    if (!ReadPreviousHash(fin, previous)) {
+        fclose(fin);
+        return false;
+    }
+
+    InflateStreamBuf inflater(fin);
+    std::istream is(&inflater);
+    state.assign(std::istreambuf_iterator<char>(is),
+                 std::istreambuf_iterator<char>());
+    fclose(fin);
+
+    return inflater.good() && StateHash(state) == hash;
+}
+
+/* Pad a state with zeros to the given size, for delta encoding. */
+std::string Padded(const std::string &state, size_t size)
+{
+    std::string padded(state);
+    padded.resize(size, '\0');
+    return padded;
+}
+};
 
 /* Show the prestige results of all the missions perfomed in the
  * previous turn.
@@ -96,3 +204,179 @@ void MailSwitchEndgame(void)
 
     MailSwitchPlayer();
 }
+
+
+/**
+ * Serialize the game state in the portable form that play-by-mail
+ * deltas and hashes are computed on.
+ */
+std::string SerializePbemState(const struct Players &data)
+{
+    std::ostringstream os;
+    {
+        cereal::PortableBinaryOutputArchive archive(os);
+        archive(data);
+    }
+    return os.str();
+}
+
+
+/**
+ * Read back a state serialized by SerializePbemState().
+ *
+ * \throws cereal::Exception  if the state is malformed.
+ */
+void DeserializePbemState(const std::string &state, struct Players &data)
+{
+    std::istringstream is(state);
+    cereal::PortableBinaryInputArchive archive(is);
+    archive(data);
+}
+
+
+/**
+ * Forget the play-by-mail game, as another game starts or is loaded.
+ */
+void ClearPbemBase()
+{
+    pbemBase.clear();
+    ackedHash = 0;
+}
+
+
+/**
+ * Remember the state received from the opponent, as loaded from their
+ * turn file, as the base for the next delta sent to them.
+ */
+void SetPbemBase(const std::string &state)
+{
+    pbemBase = state;
+}
+
+
+bool HavePbemBase()
+{
+    return !pbemBase.empty();
+}
+
+
+/**
+ * Keep a copy of a state sent to the opponent, so that the delta they
+ * reply with can be applied to it.
+ *
+ * The copy is removed once the opponent replies to the state sent
+ * after it, so at most two are kept for a game.
+ */
+void StorePbemState(const std::string &state)
+{
+    std::string name = StateFileName(StateHash(state));
+    FILE *fout = sOpen(name.c_str(), "wb", FT_SAVE);
+
+    if (fout == NULL) {
+        return;
+    }
+
+    uint8_t header[4];
+
+    for (int i = 0; i < 4; i++) {
+        header[i] = (ackedHash >> (8 * i)) & 0xFF;
+    }
+
+    bool ok = (fwrite(header, 1, sizeof(header), fout) == sizeof(header));
+    DeflateStreamBuf deflater(fout, Z_BEST_SPEED);
+    {
+        std::ostream os(&deflater);
+        os.write(state.data(), state.size());
+        ok = ok && os.good() && deflater.finish();
+    }
+
+    if (fclose(fout) != 0 || !ok) {
+        WARNING2("can't write play-by-mail base `%s'", name.c_str());
+    }
+}
+
+
+/**
+ * Encode a state as changes to the state last received from the
+ * opponent.
+ *
+ * \param state  the serialized new state.
+ */
+PbemDelta MakePbemDelta(const std::string &state)
+{
+    size_t size = std::max(pbemBase.size(), state.size());
+    std::string from = Padded(pbemBase, size);
+    std::string to = Padded(state, size);
+    PbemDelta delta;
+
+    delta.baseHash = StateHash(pbemBase);
+    delta.stateHash = StateHash(state);
+    delta.stateSize = state.size();
+    delta.delta = EncodeDelta((const uint8_t *)from.data(),
+                              (const uint8_t *)to.data(), size);
+    return delta;
+}
+
+
+/**
+ * Rebuild the state sent in a delta.
+ *
+ * The base must be a state this side sent, or the one it last
+ * received. Nothing is changed; once the state is loaded,
+ * AcceptPbemDelta() records that the opponent has it.
+ *
+ * \param delta  the delta from the turn file.
+ * \param state  receives the serialized state.
+ * \return  false if the base is unknown or the result doesn't match
+ *     the sender's state; a full save is needed then.
+ */
+bool ApplyPbemDelta(const PbemDelta &delta, std::string &state)
+{
+    std::string base;
+
+    if (!LoadPbemState(delta.baseHash, base)) {
+        WARNING2("missing play-by-mail base %08X; a full save is needed",
+                 delta.baseHash);
+        return false;
+    }
+
+    size_t size = std::max<size_t>(base.size(), delta.stateSize);
+    std::string result = Padded(base, size);
+
+    if (!ApplyDelta(delta.delta, (uint8_t *)&result[0], size)) {
+        return false;
+    }
+
+    result.resize(delta.stateSize);
+
+    if (StateHash(result) != delta.stateHash) {
+        return false;
+    }
+
+    state.swap(result);
+    return true;
+}
+
+
+/**
+ * Note that the opponent has the base of a delta just loaded.
+ *
+ * When the base is a state this side sent, the one sent before it is
+ * no longer needed and is removed.
+ *
+ * \param baseHash  the hash of the delta's base.
+ */
+void AcceptPbemDelta(uint32_t baseHash)
+{
+    if (!pbemBase.empty() && StateHash(pbemBase) == baseHash) {
+        return;
+    }
+
+    uint32_t previous = PreviousHash(baseHash);
+
+    if (previous != 0 && previous != baseHash) {
+        remove_savedat(StateFileName(previous).c_str());
+    }
+
+    ackedHash = baseHash;
+}
@@ -1,6 +1,15 @@
 #ifndef PBM_H
 #define PBM_H
 
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <cereal/types/vector.hpp>
+
+struct Players;
+
 #define MAIL (Data->Mail)
 
 // First bit of MAIL: player (0: U.S., 1; Soviet)
@@ -17,4 +26,34 @@ void ShowPrestigeResults(char plr);
 void MailSwitchPlayer();
 void MailSwitchEndgame(void);
 
+/**
+ * The changes to the game state since a turn both players have.
+ *
+ * A play-by-mail turn file may carry this instead of the full game
+ * state. The base is the state last received from the opponent, who
+ * keeps a copy of every state they send.
+ */
+struct PbemDelta {
+    uint32_t baseHash;      /**< CRC-32 of the serialized base state */
+    uint32_t stateHash;     /**< CRC-32 of the serialized new state */
+    uint32_t stateSize;     /**< Size of the serialized new state */
+    std::vector<uint8_t> delta;
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(baseHash, stateHash, stateSize, delta);
+    }
+};
+
+std::string SerializePbemState(const struct Players &data);
+void DeserializePbemState(const std::string &state, struct Players &data);
+void ClearPbemBase();
+void SetPbemBase(const std::string &state);
+bool HavePbemBase();
+void StorePbemState(const std::string &state);
+PbemDelta MakePbemDelta(const std::string &state);
+bool ApplyPbemDelta(const PbemDelta &delta, std::string &state);
+void AcceptPbemDelta(uint32_t baseHash);
+
 #endif //PBM_H
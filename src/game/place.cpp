@@ -26,7 +26,6 @@
 
 #include <boost/format.hpp>
 #include <boost/shared_ptr.hpp>
-#include <boost/algorithm/string/join.hpp>
 
 #include "display/image.h"
 #include "display/graphics.h"
@@ -35,6 +34,7 @@
 
 #include "gamedata.h"
 #include "Buzz_inc.h"
+#include "asset_index.h"
 #include "draw.h"
 #include "utils.h"
 #include "game_main.h"
@@ -465,20 +465,15 @@ int Help(const char *FName)
         return 0;
     }
    
-    for (i = 0; i < Assets->help.size(); i++) {
-        if(!xstrncasecmp(Assets->help.at(i).Code.c_str(), FName, 4)) {
-            break;
-        }
-    }
+    i = FindHelp(FName);
 
-    if (i == Assets->help.size()) {
+    if (i < 0) {
         CERROR3(baris, "Could not find help entry %s", FName);
         return 0;
     }
 
     AL_CALL = 1;
-    std::string str = boost::algorithm::join(Assets->help.at(i).description, "\r\n") + "\r\n";
-    const char *Help = str.c_str();
+    const char *Help = HelpText(i).c_str();
 
     // Process entry
     i = 0;
@@ -857,7 +852,7 @@ void Draw_Mis_Stats(int plr, int index, int mode)
     }
 
     int mcode = Data->P[plr].History[index].MissionCode;
-    const struct mStr plan = GetMissionPlan(mcode);
+    const struct mStr &plan = GetMissionPlan(mcode);
 
     display::graphics.setForegroundColor(1);
     draw_string(12, 56, "MISSION NAME: ");
@@ -38,6 +38,7 @@
 #include "display/image.h"
 
 #include "Buzz_inc.h"
+#include "asset_registry.h"
 #include "draw.h"
 #include "utils.h"
 #include "admin.h"
@@ -165,13 +166,27 @@ struct PORTOUTLINE {
     char val;
 };
 
+// Spaceport layout & palette, as stored in usa_port.json/sov_port.json
+struct PORTDATA {
+    std::vector<MOBJ> MObj;
+    std::vector<IMG> Img;
+    std::vector<uint8_t> palette;
+    std::vector<OUTLINE> pOutline;
+
+    template<class Archive>
+    void serialize(Archive & ar) {
+        ar(CEREAL_NVP(MObj));
+        ar(CEREAL_NVP(Img));
+        ar(CEREAL_NVP(palette));
+        ar(CEREAL_NVP(pOutline));
+    }
+};
+
 int Vab_Spot; // Global variable
 
 namespace // Local global variables
 {	
-	std::vector<MOBJ> MObj(S_MOBJ);
-	std::vector<IMG> Img(S_QTY);
-	std::vector<OUTLINE> pOutline(55);
+	boost::shared_ptr<const PORTDATA> portData;
 	
 	PORTOUTLINE *pPortOutlineRestore;
 	
@@ -207,6 +222,7 @@ char PortSel(char plr, char loc);
 char Request(char plr, const char *s, char md);
 int SpaceportAnimationEntry(int plr);
 int SpaceportAnimationOngoing(int plr);
+boost::shared_ptr<const PORTDATA> GetPortData(int plr);
 void LoadPOutline(int plr); 
 
 
@@ -258,7 +274,7 @@ void LoadImg(int plr, int indx)
     //image->exportPalette(Img[indx].Width, Img[indx].Height);
     image->exportPalette();
     
-    display::graphics.screen()->draw(image, Img[indx].PlaceX, Img[indx].PlaceY);
+    display::graphics.screen()->draw(image, portData->Img[indx].PlaceX, portData->Img[indx].PlaceY);
 }
 
 
@@ -273,18 +289,8 @@ void LoadImg(int plr, int indx)
  */
 void PortPal(char plr)
 {   
-    std::string filename;
-	filename = (plr == 0) ? "usa_port.json" : "sov_port.json";
-    
-    // Deserialize palette
-    std::vector<uint8_t> palette;
-    std::ifstream file(locate_file(filename.c_str(), FT_DATA));
-    if (!file) {
-		throw std::runtime_error(filename + " could not be opened.");
-	}
-    cereal::JSONInputArchive ar(file);
-    ar(CEREAL_NVP(palette));
-        
+    const std::vector<uint8_t> &palette = GetPortData(plr)->palette;
+
     // Display p and copy data to p.pal
     display::AutoPal p(display::graphics.legacyScreen());
     for (size_t i= 0; i < sizeof(p.pal); i++) {  // the limit is Autopal p.pal size
@@ -295,21 +301,8 @@ void PortPal(char plr)
 
 void DrawSpaceport(char plr)
 {
-	std::string filename;
-	filename = (plr == 0) ? "usa_port.json" : "sov_port.json";
-	
-	// Deserialize Img and MObj
-	{
-		std::ifstream file(locate_file(filename.c_str(), FT_DATA));
-		if (!file) {
-			throw std::runtime_error(filename + " could not be opened.");
-		}
-		
-		cereal::JSONInputArchive ar(file);
-		ar(CEREAL_NVP(MObj));
-		ar(CEREAL_NVP(Img));
-    }
-    
+    portData = GetPortData(plr);
+
     // Draw the main port image
 	LoadImg(plr, 0);
 
@@ -364,12 +357,12 @@ void DrawSpaceport(char plr)
     for (int fm = 0; fm < S_MOBJ; fm++) {
         int idx = Data->P[plr].Port[fm];  // Current Port Level for MObj
 
-        if (MObj[fm].Reg[idx].PreDraw > 0) {  // PreDrawn Shape
-            LoadImg(plr, MObj[fm].Reg[idx].PreDraw);
+        if (portData->MObj[fm].Reg[idx].PreDraw > 0) {  // PreDrawn Shape
+            LoadImg(plr, portData->MObj[fm].Reg[idx].PreDraw);
         }
 
-        if (MObj[fm].Reg[idx].iNum > 0) {  // Actual Shape
-            LoadImg(plr, MObj[fm].Reg[idx].iNum);
+        if (portData->MObj[fm].Reg[idx].iNum > 0) {  // Actual Shape
+            LoadImg(plr, portData->MObj[fm].Reg[idx].iNum);
         }
     }
 
@@ -775,7 +768,7 @@ int MapKey(char plr, int key, int old)
     char high = -1, low = -1;
 
     for (int j = 0; j < S_MOBJ; j++) {
-        if (MObj[j].Reg[Data->P[plr].Port[j]].sNum > 0) {
+        if (portData->MObj[j].Reg[Data->P[plr].Port[j]].sNum > 0) {
             if (low == -1) {
                 low = j;
             }
@@ -788,7 +781,7 @@ int MapKey(char plr, int key, int old)
 
     switch (key) {
     case 'A':
-        if (MObj[6].Reg[Data->P[plr].Port[PORT_Admin]].sNum > 0) {
+        if (portData->MObj[6].Reg[Data->P[plr].Port[PORT_Admin]].sNum > 0) {
             val = PORT_Admin;
         }
 
@@ -796,7 +789,7 @@ int MapKey(char plr, int key, int old)
         break;
 
     case 'H':
-        if (MObj[8].Reg[Data->P[plr].Port[PORT_MedicalCtr]].sNum > 0) {
+        if (portData->MObj[8].Reg[Data->P[plr].Port[PORT_MedicalCtr]].sNum > 0) {
             val = PORT_MedicalCtr;
         }
 
@@ -804,7 +797,7 @@ int MapKey(char plr, int key, int old)
         break;
 
     case 'I':
-        if (MObj[1].Reg[Data->P[plr].Port[PORT_Pentagon]].sNum > 0) {
+        if (portData->MObj[1].Reg[Data->P[plr].Port[PORT_Pentagon]].sNum > 0) {
             val = PORT_Pentagon;
         }
 
@@ -818,7 +811,7 @@ int MapKey(char plr, int key, int old)
         break;
 
     case 'M':
-        if (MObj[5].Reg[Data->P[plr].Port[PORT_Museum]].sNum > 0) {
+        if (portData->MObj[5].Reg[Data->P[plr].Port[PORT_Museum]].sNum > 0) {
             val = PORT_Museum;
         }
 
@@ -826,7 +819,7 @@ int MapKey(char plr, int key, int old)
         break;
 
     case 'R':
-        if (MObj[22].Reg[Data->P[plr].Port[PORT_Research]].sNum > 0) {
+        if (portData->MObj[22].Reg[Data->P[plr].Port[PORT_Research]].sNum > 0) {
             val = PORT_Research;
         }
 
@@ -840,7 +833,7 @@ int MapKey(char plr, int key, int old)
         break;
 
     case 'P':
-        if (MObj[2].Reg[Data->P[plr].Port[PORT_Capitol]].sNum > 0) {
+        if (portData->MObj[2].Reg[Data->P[plr].Port[PORT_Capitol]].sNum > 0) {
             val = PORT_Capitol;
         }
 
@@ -848,7 +841,7 @@ int MapKey(char plr, int key, int old)
         break;
 
     case 'V':
-        if (MObj[4].Reg[Data->P[plr].Port[PORT_VAB]].sNum > 0) {
+        if (portData->MObj[4].Reg[Data->P[plr].Port[PORT_VAB]].sNum > 0) {
             val = PORT_VAB;
         }
 
@@ -856,7 +849,7 @@ int MapKey(char plr, int key, int old)
         break;
 
     case 'C':
-        if (MObj[26].Reg[Data->P[plr].Port[PORT_MissionControl]].sNum > 0) {
+        if (portData->MObj[26].Reg[Data->P[plr].Port[PORT_MissionControl]].sNum > 0) {
             val = PORT_MissionControl;
         }
 
@@ -864,7 +857,7 @@ int MapKey(char plr, int key, int old)
         break;
 
     case 'Q':
-        if (MObj[29].Reg[Data->P[plr].Port[PORT_Gate]].sNum > 0) {
+        if (portData->MObj[29].Reg[Data->P[plr].Port[PORT_Gate]].sNum > 0) {
             val = PORT_Gate;
         }
 
@@ -872,7 +865,7 @@ int MapKey(char plr, int key, int old)
         break;
 
     case 'E':
-        if (MObj[28].Reg[Data->P[plr].Port[PORT_FlagPole]].sNum > 0) {
+        if (portData->MObj[28].Reg[Data->P[plr].Port[PORT_FlagPole]].sNum > 0) {
             val = PORT_FlagPole;
         }
 
@@ -880,7 +873,7 @@ int MapKey(char plr, int key, int old)
         break;
 
     case 'T':
-        if (MObj[7].Reg[Data->P[plr].Port[PORT_AstroComplex]].sNum > 0) {
+        if (portData->MObj[7].Reg[Data->P[plr].Port[PORT_AstroComplex]].sNum > 0) {
             val = PORT_AstroComplex;
         }
 
@@ -888,7 +881,7 @@ int MapKey(char plr, int key, int old)
         break;
 
     case 'B':
-        if (MObj[9].Reg[Data->P[plr].Port[PORT_BasicTraining]].sNum > 0) {
+        if (portData->MObj[9].Reg[Data->P[plr].Port[PORT_BasicTraining]].sNum > 0) {
             val = PORT_BasicTraining;
         }
 
@@ -905,7 +898,7 @@ int MapKey(char plr, int key, int old)
         found = 0;
 
         for (int j = old; j < high + 1; j++) {
-            if (MObj[j].Reg[Data->P[plr].Port[j]].sNum > 0) {
+            if (portData->MObj[j].Reg[Data->P[plr].Port[j]].sNum > 0) {
                 if (found == 0) {
                     val = j;
                     found = 1;
@@ -925,7 +918,7 @@ int MapKey(char plr, int key, int old)
         found = 0;
 
         for (int j = old; j > low - 1; j--) {
-            if (MObj[j].Reg[Data->P[plr].Port[j]].sNum > 0) {
+            if (portData->MObj[j].Reg[Data->P[plr].Port[j]].sNum > 0) {
                 if (found == 0) {
                     val = j;
                     found = 1;
@@ -972,6 +965,7 @@ void Port(char plr)
 
     while (1) {
         av_block();
+        CheckAutosave();
 
         if (kMode == 0) {
             i = 0;
@@ -1009,37 +1003,37 @@ void Port(char plr)
                     kMode = 1;
                 }
 
-                if (MObj[i].Reg[Data->P[plr].Port[i]].sNum > 0) {
-                    x = MObj[i].Reg[Data->P[plr].Port[i]].CD[0].x1;
-                    y = MObj[i].Reg[Data->P[plr].Port[i]].CD[0].y1;
+                if (portData->MObj[i].Reg[Data->P[plr].Port[i]].sNum > 0) {
+                    x = portData->MObj[i].Reg[Data->P[plr].Port[i]].CD[0].x1;
+                    y = portData->MObj[i].Reg[Data->P[plr].Port[i]].CD[0].y1;
                     kEnt = i;
                 }
             }
 
             if (kMode == 1 && kEnt == i) {
-                x = MObj[i].Reg[Data->P[plr].Port[i]].CD[0].x1;
-                y = MObj[i].Reg[Data->P[plr].Port[i]].CD[0].y1;
+                x = portData->MObj[i].Reg[Data->P[plr].Port[i]].CD[0].x1;
+                y = portData->MObj[i].Reg[Data->P[plr].Port[i]].CD[0].y1;
             } else if (kMode == 1 && kEnt != i) {
                 x = -1;
                 y = -1;
             }
 
-            for (j = 0; j < MObj[(kMode == 0) ? i : kEnt].Reg[Data->P[plr].Port[(kMode == 0) ? i : kEnt]].qty; j++) {
-                if (x >= MObj[(kMode == 0) ? i : kEnt].Reg[Data->P[plr].Port[(kMode == 0) ? i : kEnt]].CD[j].x1 &&
-                    y >= MObj[(kMode == 0) ? i : kEnt].Reg[Data->P[plr].Port[(kMode == 0) ? i : kEnt]].CD[j].y1 &&
-                    x <= MObj[(kMode == 0) ? i : kEnt].Reg[Data->P[plr].Port[(kMode == 0) ? i : kEnt]].CD[j].x2 &&
-                    y <= MObj[(kMode == 0) ? i : kEnt].Reg[Data->P[plr].Port[(kMode == 0) ? i : kEnt]].CD[j].y2) {
-                    PortText(5, 196, MObj[i].Name, 11);
-
-                    if (MObj[i].Reg[Data->P[plr].Port[i]].sNum > 0) {
-                        index = MObj[i].Reg[Data->P[plr].Port[i]].sNum;
-                        Count = pOutline[index].Count;
-                        bone = new uint16_t[pOutline[index].bone.size()];
-                        std::copy(pOutline[index].bone.begin(), pOutline[index].bone.end(), bone);
+            for (j = 0; j < portData->MObj[(kMode == 0) ? i : kEnt].Reg[Data->P[plr].Port[(kMode == 0) ? i : kEnt]].qty; j++) {
+                if (x >= portData->MObj[(kMode == 0) ? i : kEnt].Reg[Data->P[plr].Port[(kMode == 0) ? i : kEnt]].CD[j].x1 &&
+                    y >= portData->MObj[(kMode == 0) ? i : kEnt].Reg[Data->P[plr].Port[(kMode == 0) ? i : kEnt]].CD[j].y1 &&
+                    x <= portData->MObj[(kMode == 0) ? i : kEnt].Reg[Data->P[plr].Port[(kMode == 0) ? i : kEnt]].CD[j].x2 &&
+                    y <= portData->MObj[(kMode == 0) ? i : kEnt].Reg[Data->P[plr].Port[(kMode == 0) ? i : kEnt]].CD[j].y2) {
+                    PortText(5, 196, portData->MObj[i].Name, 11);
+
+                    if (portData->MObj[i].Reg[Data->P[plr].Port[i]].sNum > 0) {
+                        index = portData->MObj[i].Reg[Data->P[plr].Port[i]].sNum;
+                        Count = portData->pOutline[index].Count;
+                        bone = new uint16_t[portData->pOutline[index].bone.size()];
+                        std::copy(portData->pOutline[index].bone.begin(), portData->pOutline[index].bone.end(), bone);
       
                         PortOutLine(Count, bone, 1);
                         delete [] bone;
-                        strncpy(&helpText[1], (MObj[i].Help).c_str(), 3);
+                        strncpy(&helpText[1], (portData->MObj[i].Help).c_str(), 3);
                     }
 
                     good = 0;
@@ -1051,10 +1045,10 @@ void Port(char plr)
                         }
                     }
 
-                    while (x >= MObj[i].Reg[Data->P[plr].Port[i]].CD[j].x1 &&
-                           y >= MObj[i].Reg[Data->P[plr].Port[i]].CD[j].y1 &&
-                           x <= MObj[i].Reg[Data->P[plr].Port[i]].CD[j].x2 &&
-                           y <= MObj[i].Reg[Data->P[plr].Port[i]].CD[j].y2) {
+                    while (x >= portData->MObj[i].Reg[Data->P[plr].Port[i]].CD[j].x1 &&
+                           y >= portData->MObj[i].Reg[Data->P[plr].Port[i]].CD[j].y1 &&
+                           x <= portData->MObj[i].Reg[Data->P[plr].Port[i]].CD[j].x2 &&
+                           y <= portData->MObj[i].Reg[Data->P[plr].Port[i]].CD[j].y2) {
                         av_block();
 #if BABYSND
                         UpdateAudio();
@@ -1073,8 +1067,8 @@ void Port(char plr)
                         }
 
                         if (kMode == 1) {
-                            x = MObj[i].Reg[Data->P[plr].Port[i]].CD[0].x1;
-                            y = MObj[i].Reg[Data->P[plr].Port[i]].CD[0].y1;
+                            x = portData->MObj[i].Reg[Data->P[plr].Port[i]].CD[0].x1;
+                            y = portData->MObj[i].Reg[Data->P[plr].Port[i]].CD[0].y1;
                         }
 
                         if (key > 0 && kMode == 1)  // got a keypress
@@ -1106,7 +1100,7 @@ void Port(char plr)
 
                             switch (res) {
                             case pNOREDRAW:
-                                PortText(5, 196, MObj[i].Name, 11);
+                                PortText(5, 196, portData->MObj[i].Name, 11);
                                 break;
 
                             case pREDRAW:
@@ -1142,7 +1136,7 @@ void Port(char plr)
                                 //   if (pPortOutlineRestore)
                                 //      PortOutLine(Count,bone,0);
 #endif
-                                PortText(5, 196, MObj[i].Name, 11);
+                                PortText(5, 196, portData->MObj[i].Name, 11);
                                 break;
 
                             case pEXIT:
@@ -1177,12 +1171,12 @@ void Port(char plr)
                             kMode = good = 0;
                             SpotResume();
 
-                            if (MObj[i].Reg[Data->P[plr].Port[i]].sNum > 0) {
+                            if (portData->MObj[i].Reg[Data->P[plr].Port[i]].sNum > 0) {
                                 
-                        		index = MObj[i].Reg[Data->P[plr].Port[i]].sNum;
-				                Count = pOutline[index].Count;
-				                bone = new uint16_t[pOutline[index].bone.size()];
-                    			std::copy(pOutline[index].bone.begin(), pOutline[index].bone.end(), bone);                                
+                        		index = portData->MObj[i].Reg[Data->P[plr].Port[i]].sNum;
+				                Count = portData->pOutline[index].Count;
+				                bone = new uint16_t[portData->pOutline[index].bone.size()];
+                    			std::copy(portData->pOutline[index].bone.begin(), portData->pOutline[index].bone.end(), bone);                                
 
                                 PortOutLine(Count, bone, 1);
                                 delete [] bone;
@@ -1712,7 +1706,7 @@ int SpaceportAnimationEntry(int plr)
         }
     }
 
-    int roll = brandom(1000);
+    int roll = brandom(1000, RNG_Cosmetic);
 
     if (xMODE & xMODE_CLOUDS) {
         if (plr == 0 && Data->P[plr].Port[PORT_VAB] == 0) {
@@ -1741,7 +1735,7 @@ int SpaceportAnimationEntry(int plr)
 
 int SpaceportAnimationOngoing(int plr)
 {
-    int roll = brandom(100);
+    int roll = brandom(100, RNG_Cosmetic);
 
     if (Vab_Spot == 1 && Data->P[plr].Port[PORT_VAB] == 2) {
         Data->P[plr].Port[PORT_LaunchPad_A] = 1;
@@ -1781,19 +1775,24 @@ int SpaceportAnimationOngoing(int plr)
 }
 
 
-// Deserialize Count and bone data in pOutline vector
-void LoadPOutline(int plr) {
-	
-	std::string filename;
-	filename = (plr == 0) ? "usa_port.json" : "sov_port.json";
-	std::ifstream file(locate_file(filename.c_str(), FT_DATA));
-	  if (!file) {
-	  throw std::runtime_error(filename + " could not be opened.");  
-	}
+/* Fetch the spaceport layout and palette for the given player.
+ *
+ * The data is parsed from usa_port.json/sov_port.json on first use
+ * and shared through the asset registry afterwards.
+ *
+ * \param plr  The player whose spaceport to get (0 for USA, 1 for USSR).
+ * \throws IOException  if the port file cannot be read.
+ */
+boost::shared_ptr<const PORTDATA> GetPortData(int plr)
+{
+    std::string filename = (plr == 0) ? "usa_port.json" : "sov_port.json";
+    return AssetRegistry::get<PORTDATA, DataAsset<PORTDATA, JsonCache::Fields<PORTDATA> > >(filename);
+}
+
 
-	cereal::JSONInputArchive ar(file);
-	ar(CEREAL_NVP(pOutline));
-	INFO1("pOutline succesfully uploaded.");
+// Select the spaceport data holding the Count and bone outline data
+void LoadPOutline(int plr) {
+    portData = GetPortData(plr);
 }
 
 
@@ -543,42 +543,10 @@ int Preferences(int player, int where)
 
                     key = 0;
 
-                    if ((where == 0 || where == 3) && (Data->Def.Input == 2 || Data->Def.Input == 3)) {
-                        std::string fname =
-                            locate_file("hist.json", FT_DATA);
-
-                        ifstream os(fname);
-                        cereal::JSONInputArchive ar(os);
-
-                        // Don't make a loop over the players as this
-                        // will break the preprocessor macro.
-
-                        ARCHIVE_VECTOR(Data->P[0].Probe, struct Equipment, 7);
-                        ARCHIVE_VECTOR(Data->P[0].Rocket, struct Equipment, 7);
-                        ARCHIVE_VECTOR(Data->P[0].Manned, struct Equipment, 7);
-                        ARCHIVE_VECTOR(Data->P[0].Misc, struct Equipment, 7);
-
-                        ARCHIVE_VECTOR(Data->P[1].Probe, struct Equipment, 7);
-                        ARCHIVE_VECTOR(Data->P[1].Rocket, struct Equipment, 7);
-                        ARCHIVE_VECTOR(Data->P[1].Manned, struct Equipment, 7);
-                        ARCHIVE_VECTOR(Data->P[1].Misc, struct Equipment, 7);
-
-                    }
-
-                    // Random Equipment
-                    if ((where == 0 || where == 3) && (Data->Def.Input == 4 || Data->Def.Input == 5)) {
-                        RandomizeEq();
-                    }
-
-                    int i, k;
-
-                    for (i = 0; i < NUM_PLAYERS; i++) {
-                        for (k = 0; k < 7; k++) {
-                            Data->P[i].Probe[k].MSF = Data->P[i].Probe[k].MaxRD;
-                            Data->P[i].Rocket[k].MSF = Data->P[i].Rocket[k].MaxRD;
-                            Data->P[i].Manned[k].MSF = Data->P[i].Manned[k].MaxRD;
-                            Data->P[i].Misc[k].MSF = Data->P[i].Misc[k].MaxRD;
-                        }
+                    if (where == 0 || where == 3) {
+                        ApplyHardwareModel();
+                    } else {
+                        ResetSafetyFactors();
                     }
 
                     CacheCrewFile();
@@ -782,6 +750,59 @@ int Preferences(int player, int where)
 }
 
 
+/**
+ * Set up the starting hardware of a new game for the chosen
+ * hardware model (Data->Def.Input).
+ */
+void ApplyHardwareModel()
+{
+    if (Data->Def.Input == 2 || Data->Def.Input == 3) {
+        std::string fname =
+            locate_file("hist.json", FT_DATA);
+
+        ifstream os(fname);
+        cereal::JSONInputArchive ar(os);
+
+        // Don't make a loop over the players as this
+        // will break the preprocessor macro.
+
+        ARCHIVE_VECTOR(Data->P[0].Probe, struct Equipment, 7);
+        ARCHIVE_VECTOR(Data->P[0].Rocket, struct Equipment, 7);
+        ARCHIVE_VECTOR(Data->P[0].Manned, struct Equipment, 7);
+        ARCHIVE_VECTOR(Data->P[0].Misc, struct Equipment, 7);
+
+        ARCHIVE_VECTOR(Data->P[1].Probe, struct Equipment, 7);
+        ARCHIVE_VECTOR(Data->P[1].Rocket, struct Equipment, 7);
+        ARCHIVE_VECTOR(Data->P[1].Manned, struct Equipment, 7);
+        ARCHIVE_VECTOR(Data->P[1].Misc, struct Equipment, 7);
+
+    }
+
+    // Random Equipment
+    if (Data->Def.Input == 4 || Data->Def.Input == 5) {
+        RandomizeEq();
+    }
+
+    ResetSafetyFactors();
+}
+
+
+/**
+ * Start every program's maximum safety factor at its R&D maximum.
+ */
+void ResetSafetyFactors()
+{
+    for (int i = 0; i < NUM_PLAYERS; i++) {
+        for (int k = 0; k < 7; k++) {
+            Data->P[i].Probe[k].MSF = Data->P[i].Probe[k].MaxRD;
+            Data->P[i].Rocket[k].MSF = Data->P[i].Rocket[k].MaxRD;
+            Data->P[i].Manned[k].MSF = Data->P[i].Manned[k].MaxRD;
+            Data->P[i].Misc[k].MSF = Data->P[i].Misc[k].MaxRD;
+        }
+    }
+}
+
+
 void SavePreferences(const AudioConfig &audio)
 {
     try {
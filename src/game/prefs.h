@@ -10,6 +10,8 @@ enum {
 void IngamePreferences(int player);
 int NewGamePreferences();
 int NewPBEMGamePreferences();
+void ApplyHardwareModel();
+void ResetSafetyFactors();
 
 
 #endif // PREFS_H
@@ -32,7 +32,7 @@
 #include "mission_util.h"
 #include "pbm.h"
 
-char tYr, tMo;
+GAME_LOCAL char tYr, tMo;
 
 void Set_Dock(char plr, char total);
 void Set_LM(char plr, char total);
@@ -293,8 +293,8 @@ PrestMap(int val)
 
 /** Returns the amount of prestige added
  *
- * TODO: This function no longer appears to be used. Find out why
- * it's useful or mark for deletion. -- rnyoakum
+ * This is the prestige a successful mission of the given type would
+ * earn, as the AI mission planner estimates it.
  *
  * \note Assumes that the Mis Structure is Loaded
  */
@@ -303,7 +303,7 @@ int PrestCheck(char plr, int code)
     int i, total = 0;
     char prg, tm;
 
-    const struct mStr misType = GetMissionPlan(code);
+    const struct mStr &misType = GetMissionPlan(code);
 
     prg = misType.mEq;
 
@@ -778,7 +778,7 @@ int AllotPrest(char plr, char mis)
 
     // SETUP INFO
     mcode = Data->P[plr].Mission[mis].MissionCode;
-    const struct mStr misType = GetMissionPlan(mcode);
+    const struct mStr &misType = GetMissionPlan(mcode);
 
     other = MaxFail();
 
@@ -1217,7 +1217,7 @@ int Update_Prestige_Data(char plr, char mis, int code)
 
     assert(0 <= plr && plr < NUM_PLAYERS);
 
-    const struct mStr misType = GetMissionPlan(code);
+    const struct mStr &misType = GetMissionPlan(code);
 
     if (misType.Days == 0) {
         total = U_AllotPrest(plr, mis);    // Unmanned Prestige
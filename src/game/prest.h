@@ -6,6 +6,7 @@ int DurationPenalty(char plr, const struct mStr &mission);
 int MilestonePenalty(char plr, const struct mStr &mission);
 int NewMissionPenalty(char plr, const struct mStr &mission);
 
+int PrestCheck(char plr, int code);
 int PrestNeg(char plr, int i);
 char Set_Goal(char plr, char which, char control);
 int Find_MaxGoal(void);
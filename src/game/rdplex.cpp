@@ -922,7 +922,7 @@ RDUnit(char hardwareTypeIndex, char hardwareIndex, char nRolls,
     int diceType = 6 + Data->P[playerIndex].RD_Mods_For_Turn;
 
     for (int i = 0; i < nRolls; i++) {
-        diceRoll += rand() % diceType + 1;
+        diceRoll += brandom(diceType) + 1;
     }
 
     eq.Safety += diceRoll;
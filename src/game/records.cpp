@@ -18,6 +18,14 @@
 
 // This file handles the Mission Records screen
 
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <SDL.h>
+
 #include "display/graphics.h"
 
 #include "Buzz_inc.h"
@@ -25,8 +33,8 @@
 #include "hardef.h"
 #include "draw.h"
 #include "game_main.h"
-#include "endianness.h"
 #include "mission_util.h"
+#include "options.h"
 #include "place.h"
 #include "port.h"
 #include "replay.h"
@@ -53,8 +61,8 @@ void Drec(char *pos, char *pos2, char mde);
 void WriteRecord(int i, int j, int k, int temp);
 void SwapRec(int Rc, int pl1, int pl2);
 char CheckSucess(int i, int j);
-size_t ImportRecordEntry(FILE *fin, Record_Entry &dst);
-size_t ExportRecordEntry(FILE *fout, const Record_Entry &src);
+void UnpackRecordEntry(const char *src, Record_Entry &dst);
+void PackRecordEntry(const Record_Entry &src, char *dst);
 
 int Pict[56] = {
     411, 2, 1, 177, 272, 275, 409, 501, 504, 507, 414,
@@ -130,48 +138,261 @@ const char *Months[12] = {
     "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"
 };
 
+namespace
+{
+const char RECORDS_FILE[] = "RECORDS.DAT";
+const size_t RECORD_COUNT = 56 * 3;
+const size_t RECORD_ENTRY_SIZE = 42;    // Packed size of a Record_Entry
+
+/* A snapshot of the records table on its way to disk. */
+struct RecordsWrite {
+    std::string path;
+    std::vector<char> data;
+    int result;
+};
+
+// The records table belongs to the player, not to a game, so there is
+// one for the process. Only the interactive game uses it; headless
+// games, which may run on several threads, leave it alone.
+bool recordsLoaded = false;
+bool recordsDirty = false;
+int batchDepth = 0;
+SDL_Thread *writer = NULL;
+RecordsWrite pending;
+
+std::string SavePath(const std::string &name)
+{
+    return std::string(options.dir_savegame) + "/" + name;
+}
+
+void ResetRecords()
+{
+    for (int i = 0; i < 56; i++) {
+        for (int j = 0; j < 3; j++) {
+            memset(&rec[i][j], 0, sizeof(rec[i][j]));
+            rec[i][j].country = -1;
+        }
+    }
+}
+
+void PackRecords(std::vector<char> &data)
+{
+    data.resize(RECORD_COUNT * RECORD_ENTRY_SIZE);
+
+    for (size_t n = 0; n < RECORD_COUNT; n++) {
+        PackRecordEntry(rec[n / 3][n % 3], &data[n * RECORD_ENTRY_SIZE]);
+    }
+}
+
+/**
+ * Write a snapshot of the table to a temporary file and move it over
+ * RECORDS.DAT, so an interrupted write leaves the old table.
+ *
+ * Runs on the writer thread, so it only touches the job it is given
+ * and doesn't log.
+ *
+ * \return  0 on success, errno otherwise.
+ */
+int WriteRecordsFile(void *arg)
+{
+    RecordsWrite *job = static_cast<RecordsWrite *>(arg);
+    std::string tempPath = temp_path(job->path);
+
+    errno = 0;
+    FILE *fout = fopen(tempPath.c_str(), "wb");
+
+    if (fout == NULL) {
+        return job->result = errno ? errno : EIO;
+    }
+
+    errno = 0;
+    job->result = 0;
+
+    if (fwrite(&job->data[0], 1, job->data.size(), fout) !=
+        job->data.size()) {
+        job->result = errno ? errno : EIO;
+    }
+
+    errno = 0;
+
+    if (fclose(fout) != 0 && job->result == 0) {
+        job->result = errno ? errno : EIO;
+    }
+
+    if (job->result != 0) {
+        remove(tempPath.c_str());
+        return job->result;
+    }
+
+    job->result = replace_file(tempPath, job->path);
 
+    if (job->result != 0) {
+        remove(tempPath.c_str());
+    }
+
+    return job->result;
+}
+
+/* Report a failed write, and keep the table marked for writing. */
+void WriteFailed()
+{
+    WARNING3("can't write `%s': %s", pending.path.c_str(),
+             strerror(pending.result));
+    recordsDirty = true;
+}
+
+/* Wait for the write in progress, if any, and report its outcome. */
+void FinishWrite()
+{
+    if (writer == NULL) {
+        return;
+    }
+
+    SDL_WaitThread(writer, NULL);
+    writer = NULL;
+
+    if (pending.result != 0) {
+        WriteFailed();
+    }
+}
+
+/**
+ * Snapshot the records table and write it out in the background.
+ *
+ * Only one write is in flight at a time; the snapshot is taken after
+ * the previous write has finished, so the newest table always lands
+ * last. The table is marked as written here, and marked again if the
+ * write fails, so it is tried again with the next change or flush.
+ */
+void StartWrite()
+{
+    FinishWrite();
+
+    pending.path = SavePath(RECORDS_FILE);
+    PackRecords(pending.data);
+    recordsDirty = false;
+
+    writer = SDL_CreateThread(WriteRecordsFile, &pending);
+
+    if (writer == NULL && WriteRecordsFile(&pending) != 0) {
+        WriteFailed();
+    }
+}
+};
+
+
+
+/**
+ * Load the records table, creating RECORDS.DAT if there is none.
+ *
+ * The table is read once and kept in rec[] from then on; later calls
+ * do nothing. Changes are written back with StoreRecords(), and the
+ * last of them by FlushRecords() as the game closes.
+ */
 void MakeRecords(void)
 {
-    FILE *file;
-    int i, j;
+    if (recordsLoaded) {
+        return;
+    }
 
-    if ((file = sOpen("RECORDS.DAT", "rb", FT_SAVE_CHECK)) == NULL) {
-        file = sOpen("RECORDS.DAT", "wb", FT_SAVE);
+    ResetRecords();
 
-        if (file == NULL) {
+    FILE *file = sOpen(RECORDS_FILE, "rb", FT_SAVE_CHECK);
+
+    if (file == NULL) {
+        RecordsWrite job;
+        job.path = SavePath(RECORDS_FILE);
+        PackRecords(job.data);
+
+        if (WriteRecordsFile(&job) != 0) {
             /* XXX: very drastic */
             CRITICAL1("can't create required file RECORDS.DAT");
             exit(EXIT_FAILURE);
         }
+    } else {
+        std::vector<char> data(RECORD_COUNT * RECORD_ENTRY_SIZE);
+        size_t entries = fread(&data[0], RECORD_ENTRY_SIZE, RECORD_COUNT, file);
+        fclose(file);
 
-        for (i = 0; i < 56; i++) {
-            for (j = 0; j < 3; j++) {
-                rec[i][j].country = -1;
-                rec[i][j].tag = rec[i][j].month = rec[i][j].yr = rec[i][j].program = rec[i][j].type = 0;
-                rec[i][j].place = 0;
+        if (entries < RECORD_COUNT) {
+            WARNING3("RECORDS.DAT is short, read %u of %u entries",
+                     (unsigned)entries, (unsigned)RECORD_COUNT);
+        }
 
-                ExportRecordEntry(file, rec[i][j]);
-            }
+        for (size_t n = 0; n < entries; n++) {
+            UnpackRecordEntry(&data[n * RECORD_ENTRY_SIZE], rec[n / 3][n % 3]);
         }
     }
 
-    fclose(file);
+    recordsLoaded = true;
 }
 
-void Records(char plr)
+
+/**
+ * Mark the records table as changed and schedule it to be written.
+ *
+ * Outside of a batch the table is written at once, in the background.
+ * Inside a batch the write waits for EndRecordsBatch().
+ */
+void StoreRecords(void)
 {
-    FILE *file;
-    char pos = 0, pos2 = 0;
-    file = sOpen("RECORDS.DAT", "rb", FT_SAVE);
+    recordsDirty = true;
 
-    for (int i = 0; i < 56; i++) {
-        for (int j = 0; j < 3; j++) {
-            ImportRecordEntry(file, rec[i][j]);
-        }
+    if (batchDepth == 0) {
+        StartWrite();
+    }
+}
+
+
+/**
+ * Hold back writes of the records table until EndRecordsBatch().
+ *
+ * Batches may be nested; the table is written when the outermost
+ * batch ends.
+ */
+void BeginRecordsBatch(void)
+{
+    if (options.want_simulate) {
+        return;
     }
 
-    fclose(file);
+    batchDepth++;
+}
+
+
+void EndRecordsBatch(void)
+{
+    if (options.want_simulate) {
+        return;
+    }
+
+    assert(batchDepth > 0);
+
+    if (--batchDepth == 0 && recordsDirty) {
+        StartWrite();
+    }
+}
+
+
+/**
+ * Write any pending changes to the records table and wait for the
+ * write to finish.
+ *
+ * Called by CloseEmUp(), while the filesystem is still up.
+ */
+void FlushRecords(void)
+{
+    if (recordsDirty) {
+        StartWrite();
+    }
+
+    FinishWrite();
+}
+
+void Records(char plr)
+{
+    char pos = 0, pos2 = 0;
+    MakeRecords();
 
     FadeOut(2, 5, 0, 0);
     PortPal(plr);
@@ -289,22 +510,12 @@ void Move2rec(char *pos, char *pos2, char val)
 
 void ClearRecord(char *pos2)
 {
-    FILE *file;
     int choice = Help("i125");
 
     if (choice == -1) {
         return;
     }
 
-    file = sOpen("RECORDS.DAT", "rb", FT_SAVE);
-
-    for (int i = 0; i < 56; i++) {
-        for (int j = 0; j < 3; j++) {
-            ImportRecordEntry(file, rec[i][j]);
-        }
-    }
-
-    fclose(file);
 
 //clear record
     for (int j = 0; j < 3; j++) {
@@ -325,15 +536,7 @@ void ClearRecord(char *pos2)
     draw_number(12, 66, 2);
     draw_number(12, 90, 3);
 
-    file = sOpen("RECORDS.DAT", "wb", FT_SAVE);
-
-    for (int i = 0; i < 56; i++) {
-        for (int j = 0; j < 3; j++) {
-            ExportRecordEntry(file, rec[i][j]);
-        }
-    }
-
-    fclose(file);
+    StoreRecords();
     return;
 }
 
@@ -764,16 +967,14 @@ char CheckSucess(int i, int j)
 void SafetyRecords(char plr, int temp)
 {
     int j, k;
-    FILE *fin, *bo;
-    fin = sOpen("RECORDS.DAT", "rb", FT_SAVE);
 
-    for (int i = 0; i < 56; i++) {
-        for (j = 0; j < 3; j++) {
-            ImportRecordEntry(fin, rec[i][j]);
-        }
+    // Headless games don't set records
+    if (options.want_simulate) {
+        return;
     }
 
-    fclose(fin);
+    MakeRecords();
+
 // deal with case highest safety and lowest safety average
     rec[24][0].type = 3;
     rec[24][1].type = 3;
@@ -841,15 +1042,7 @@ void SafetyRecords(char plr, int temp)
         }
     }  //end while
 
-    bo = sOpen("RECORDS.DAT", "wb", FT_SAVE);
-
-    for (int i = 0; i < 56; i++) {
-        for (j = 0; j < 3; j++) {
-            ExportRecordEntry(bo, rec[i][j]);
-        }
-    }
-
-    fclose(bo);
+    StoreRecords();
 
     return;
 }
@@ -859,25 +1052,21 @@ void UpdateRecords(char Ty)
     int i, j, k, m, loop, temp, max;
 
     char Rec_Change, hold, craft;
-    FILE *file;
 
     hold = 0; /* XXX check uninitialized */
 
+    // Headless games don't set records
+    if (options.want_simulate) {
+        return;
+    }
+
     for (j = 0; j < 56; j++) {
         for (i = 0; i < 3; i++) {
             NREC[j][i] = 0x00;
         }
     }
 
-    file = sOpen("RECORDS.DAT", "rb", FT_SAVE);
-
-    for (i = 0; i < 56; i++) {
-        for (j = 0; j < 3; j++) {
-            ImportRecordEntry(file, rec[i][j]);
-        }
-    }
-
-    fclose(file);
+    MakeRecords();
 
     for (i = 0; i < NUM_PLAYERS; i++) {
         if (!AI[i])
@@ -2069,15 +2258,7 @@ void UpdateRecords(char Ty)
     }
 
     //Change and Update Records
-    file = sOpen("RECORDS.DAT", "wb", FT_SAVE);
-
-    for (i = 0; i < 56; i++) {
-        for (j = 0; j < 3; j++) {
-            ExportRecordEntry(file, rec[i][j]);
-        }
-    }
-
-    fclose(file);
+    StoreRecords();
     return;
 }
 
@@ -2407,58 +2588,45 @@ void RecChange(int i, int j, int k, int temp, int max, char Rec_Change, char hol
 
 
 /**
- * Read packed Record_Entry data from a file into an instance.
- *
- * If the entry is not read successfully, reading is stopped.
- * The entry may be partially read, and the file may be checked
- * for errors.
+ * Read a packed Record_Entry from a buffer into an instance.
  *
- * \param fin  an open file handle.
- * \param dst  where to store the byte data.
- * \return  1 on success, 0 otherwise.
+ * \param src  RECORD_ENTRY_SIZE bytes of little-endian data.
+ * \param dst  where to store the entry.
  */
-size_t ImportRecordEntry(FILE *fin, Record_Entry &dst)
+void UnpackRecordEntry(const char *src, Record_Entry &dst)
 {
-    bool success = true &&
-                   fread(&dst.country, sizeof(dst.country), 1, fin) &&
-                   fread(&dst.month, sizeof(dst.month), 1, fin) &&
-                   fread(&dst.yr, sizeof(dst.yr), 1, fin) &&
-                   fread(&dst.program, sizeof(dst.program), 1, fin) &&
-                   fread(&dst.tag, sizeof(dst.tag), 1, fin) &&
-                   fread(&dst.type, sizeof(dst.type), 1, fin) &&
-                   fread(&dst.place, sizeof(dst.place), 1, fin) &&
-                   fread(&dst.name[0], sizeof(dst.name), 1, fin) &&
-                   fread(&dst.astro[0], sizeof(dst.astro), 1, fin);
-
-    Swap16bit(dst.tag);
-    return (success ? 1 : 0);
+    dst.country = src[0];
+    dst.month = src[1];
+    dst.yr = src[2];
+    dst.program = src[3];
+    dst.tag = (int16_t)((uint8_t)src[4] | ((uint8_t)src[5] << 8));
+    dst.type = src[6];
+    dst.place = src[7];
+    memcpy(&dst.name[0], &src[8], sizeof(dst.name));
+    memcpy(&dst.astro[0], &src[28], sizeof(dst.astro));
 }
 
 
 /**
- * Write a Record_Entry instance as a packed byte stream to a file.
+ * Write a Record_Entry instance as a packed byte stream to a buffer.
  *
  * Outputs using little-endian ordering.
  *
- * \param fout  an open file handle.
  * \param src
- * \return  1 on success, 0 otherwise.
+ * \param dst  where to store RECORD_ENTRY_SIZE bytes.
  */
-size_t ExportRecordEntry(FILE *fout, const Record_Entry &src)
+void PackRecordEntry(const Record_Entry &src, char *dst)
 {
-    uint16_t tempTag = src.tag;
-    Swap16bit(tempTag);
-
-    bool success = true &&
-                   fwrite(&src.country, sizeof(src.country), 1, fout) &&
-                   fwrite(&src.month, sizeof(src.month), 1, fout) &&
-                   fwrite(&src.yr, sizeof(src.yr), 1, fout) &&
-                   fwrite(&src.program, sizeof(src.program), 1, fout) &&
-                   fwrite(&tempTag, sizeof(tempTag), 1, fout) &&
-                   fwrite(&src.type, sizeof(src.type), 1, fout) &&
-                   fwrite(&src.place, sizeof(src.place), 1, fout) &&
-                   fwrite(&src.name[0], sizeof(src.name), 1, fout) &&
-                   fwrite(&src.astro[0], sizeof(src.astro), 1, fout);
-
-    return (success ? 1 : 0);
+    uint16_t tag = (uint16_t)src.tag;
+
+    dst[0] = src.country;
+    dst[1] = src.month;
+    dst[2] = src.yr;
+    dst[3] = src.program;
+    dst[4] = (char)(tag & 0xFF);
+    dst[5] = (char)(tag >> 8);
+    dst[6] = src.type;
+    dst[7] = src.place;
+    memcpy(&dst[8], &src.name[0], sizeof(src.name));
+    memcpy(&dst[28], &src.astro[0], sizeof(src.astro));
 }
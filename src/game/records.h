@@ -23,6 +23,31 @@ void Records(char plr);
 void UpdateRecords(char Ty);
 void SafetyRecords(char plr, int temp);
 void MakeRecords(void);
+void StoreRecords(void);
+void BeginRecordsBatch(void);
+void EndRecordsBatch(void);
+void FlushRecords(void);
+
+/**
+ * Defers writes of the records table for the lifetime of the object,
+ * so a run of updates is written out once.
+ */
+class RecordsBatch
+{
+public:
+    RecordsBatch()
+    {
+        BeginRecordsBatch();
+    }
+    ~RecordsBatch()
+    {
+        EndRecordsBatch();
+    }
+
+private:
+    RecordsBatch(const RecordsBatch &);
+    RecordsBatch &operator=(const RecordsBatch &);
+};
 
 typedef struct pEtype {
     char country;
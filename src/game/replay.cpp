@@ -33,6 +33,8 @@
 
 #include "gamedata.h"
 #include "Buzz_inc.h"
+#include "asset_index.h"
+#include "babypics.h"
 #include "mmfile.h"
 #include "game_main.h"
 #include "sdlhelper.h"
@@ -47,7 +49,8 @@ Replay(char plr, int num, int dx, int dy, int width, int height,
 {
     int j;
     std::vector<REPLAY> Rep;
-    std::vector<struct MissionSequenceKey> sSeq, fSeq;
+    const std::vector<struct MissionSequenceKey> &sSeq = Assets->sSeq;
+    const std::vector<struct MissionSequenceKey> &fSeq = Assets->fSeq;
 
     if (Type == "OOOO") {
         Rep = interimData.tempReplay.at((plr * 100) + num);
@@ -58,9 +61,6 @@ Replay(char plr, int num, int dx, int dy, int width, int height,
     mm_file vidfile;
     float fps;
 
-    DESERIALIZE_JSON_FILE(&sSeq, locate_file("seq.json", FT_DATA));
-    DESERIALIZE_JSON_FILE(&fSeq, locate_file("fseq.json", FT_DATA));
-
     WaitForMouseUp();
 
     DEBUG2("video sequence: %d segments", Rep.size());
@@ -68,26 +68,10 @@ Replay(char plr, int num, int dx, int dy, int width, int height,
     for (int kk = 0; kk < Rep.size(); kk++) {
         DEBUG3("playing segment %d: %s", kk, Rep.at(kk).seq.c_str());
 
-        if (Rep.at(kk).Failure) {
-            for (j = 0; j < fSeq.size(); j++) {
-                if (fSeq.at(j).MissionIdSequence == Rep.at(kk).seq) {
-                    break;
-                }
-            }
+        j = FindSequence(Rep.at(kk).Failure, Rep.at(kk).seq);
 
-            if (j == fSeq.size()) {
-                return;
-            }
-        } else {
-            for (j = 0; j < sSeq.size(); j++) {
-                if (sSeq.at(j).MissionIdSequence == Rep.at(kk).seq) {
-                    break;
-                }
-            }
-
-            if (j == sSeq.size()) {
-                return;
-            }
+        if (j < 0) {
+            return;
         }
 
         int max = Rep.at(kk).seq.at(1) - '0';
@@ -168,41 +152,19 @@ done:
 void
 DispBaby(int x, int y, int loc, char neww)
 {
-    int i;
-    FILE *fin;
-    uint16_t *bot, off = 0;
-    int32_t locl;
-    display::AutoPal p(display::graphics.legacyScreen());
-
-    off = 224;
+    const int off = 224;
+    const struct BabyPic *pic = GetBabyPic(loc);
 
-    display::LegacySurface boob(68, 46);
-    bot = (uint16_t *) boob.pixels();
-
-    fin = sOpen("BABYPICX.CDR", "rb", FT_DATA);
-    locl = (int32_t) 1612 * loc;  // First Image
-
-    fseek(fin, locl, SEEK_SET);
-
-    for (i = 0; i < 48; i++) {
-        p.pal[off * 3 + i] = 0;
-    }
-
-    fread(&p.pal[off * 3], 48, 1, fin);
-    fread(boob.pixels(), 1564, 1, fin);
-    fclose(fin);
-
-    for (i = 0; i < 782; i++) {
-        bot[i + 782] = ((bot[i] & 0xF0F0) >> 4);
-        bot[i] = (bot[i] & 0x0F0F);
+    if (pic == NULL) {
+        return;
     }
 
-    for (i = 0; i < 1564; i++) {
-        boob.pixels()[i] += off;
-        boob.pixels()[1564 + i] += off;
+    {
+        display::AutoPal p(display::graphics.legacyScreen());
+        memcpy(&p.pal[off * 3], pic->palette, sizeof pic->palette);
     }
 
-    boob.copyTo(display::graphics.legacyScreen(), x, y);
+    DrawBabyPic(*pic, x, y, off);
 }
 
 
@@ -227,17 +189,11 @@ void AbzFrame(int plr, int dx, int dy, int width, int height,
 {
     int j = 0;
     mm_file vidfile;
-    std::vector<struct MissionSequenceKey> sSeq;
-
-    DESERIALIZE_JSON_FILE(&sSeq, locate_file("seq.json", FT_DATA));
+    const std::vector<struct MissionSequenceKey> &sSeq = Assets->sSeq;
 
-    for (j = 0; j < sSeq.size(); j++) {
-        if (sSeq.at(j).MissionIdSequence == sequence) {
-            break;
-        }
-    }
+    j = FindSequence(false, sequence);
 
-    if (j == sSeq.size()) {
+    if (j < 0) {
         return;
     }
 
@@ -30,6 +30,7 @@
 #include "display/palettized_surface.h"
 
 #include "review.h"
+#include "asset_registry.h"
 #include "gamedata.h"
 #include "Buzz_inc.h"
 #include "draw.h"
@@ -41,6 +42,17 @@
 #include "pace.h"
 #include "filesystem.h"
 
+/* The president's comments of p_rev.json, 18 for each side. */
+struct PresidentialReview {
+    std::vector<std::string> review;
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(CEREAL_NVP(review));
+    }
+};
+
 void DrawReview(char plr);
 void PresPict(char image);
 void DrawReviewText(char plr, int val);
@@ -379,16 +391,12 @@ void DrawReviewText(char plr, int val)
     char text[205];
     memset(text, 0, sizeof(*text));
     
-    std::vector<std::string> review;
-    
-    std::ifstream file(locate_file("p_rev.json", FT_DATA));
-    if (!file) {
-        throw std::runtime_error("p_rev.json could not be opened.");
-    }
-    cereal::JSONInputArchive ar(file);
-    ar(CEREAL_NVP(review));
+    boost::shared_ptr<const PresidentialReview> review =
+        AssetRegistry::get<PresidentialReview,
+        DataAsset<PresidentialReview, JsonCache::Fields<PresidentialReview> > >(
+            "p_rev.json");
     
-    std::string pres_review = review[(18 * plr) + val];
+    std::string pres_review = review->review.at((18 * plr) + val);
     strncpy(text, pres_review.c_str(), 205 - 1);
     text[205-1] = '\0';
     
@@ -0,0 +1,114 @@
+// This file handles the game's random number generators.
+
+#include "rng.h"
+
+#include <ctime>
+
+#include "utils.h"
+
+GAME_LOCAL GameRng gameRng;
+
+
+namespace
+{
+/* SplitMix64, to spread a seed over the generator state. */
+uint64_t SplitMix(uint64_t &x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+inline uint64_t Rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+};
+
+
+Rng::Rng(uint64_t seed)
+{
+    this->seed(seed);
+}
+
+
+void Rng::seed(uint64_t seed)
+{
+    for (int i = 0; i < 4; i++) {
+        s[i] = SplitMix(seed);
+    }
+}
+
+
+uint64_t Rng::next()
+{
+    uint64_t result = Rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = Rotl(s[3], 45);
+
+    return result;
+}
+
+
+/**
+ * \return  a number in [0, 1), with 53 random bits.
+ */
+double Rng::uniform()
+{
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+GameRng::GameRng(uint64_t seed)
+{
+    this->seed(seed);
+}
+
+
+/**
+ * Restart every stream from a seed.
+ *
+ * Each stream is seeded from its own SplitMix64 output, so the streams
+ * don't overlap in practice.
+ */
+void GameRng::seed(uint64_t seed)
+{
+    uint64_t x = seed;
+
+    initialSeed = seed;
+
+    for (int i = 0; i < RNG_STREAMS; i++) {
+        streams[i].seed(SplitMix(x));
+    }
+}
+
+
+/**
+ * \return  the seed the generators were last started from.
+ */
+uint64_t GameRng::seedValue() const
+{
+    return initialSeed;
+}
+
+
+Rng &GameRng::stream(RngStream stream)
+{
+    return streams[stream];
+}
+
+
+/**
+ * A seed that differs from run to run, for games not given one.
+ */
+uint64_t ClockSeed()
+{
+    return (uint64_t)(get_time() * 1000) ^ ((uint64_t)time(NULL) << 32);
+}
@@ -0,0 +1,77 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+#include "game_context.h"
+
+/* Independent sequences of random numbers, so that drawing more or
+ * fewer numbers for one purpose doesn't change the others. */
+enum RngStream {
+    RNG_Events,     // Game mechanics outside missions: news, R&D, recruits
+    RNG_Mission,    // Mission step rolls
+    RNG_AI,         // Computer player decisions
+    RNG_Cosmetic,   // Animations and display only
+    RNG_STREAMS
+};
+
+
+/**
+ * A xoshiro256** pseudo-random number generator.
+ *
+ * The state is plain data, so a generator can be copied, saved and
+ * restored to replay the same numbers.
+ */
+class Rng
+{
+public:
+    explicit Rng(uint64_t seed = 0);
+
+    void seed(uint64_t seed);
+    uint64_t next();
+    double uniform();
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(s[0], s[1], s[2], s[3]);
+    }
+
+private:
+    uint64_t s[4];
+};
+
+
+/**
+ * The random number generators of a game, one for each RngStream,
+ * all derived from a single seed.
+ */
+class GameRng
+{
+public:
+    explicit GameRng(uint64_t seed = 0);
+
+    void seed(uint64_t seed);
+    uint64_t seedValue() const;
+    Rng &stream(RngStream stream);
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(initialSeed);
+
+        for (int i = 0; i < RNG_STREAMS; i++) {
+            ar(streams[i]);
+        }
+    }
+
+private:
+    uint64_t initialSeed;
+    Rng streams[RNG_STREAMS];
+};
+
+extern GAME_LOCAL GameRng gameRng;
+
+uint64_t ClockSeed();
+
+#endif // RNG_H
@@ -66,6 +66,8 @@ void SetLaunchDates(char plr);
 void SetRush(int mode, int pad);
 void DrawPenaltyPopup(char plr, const struct MissionType &mission);
 void DrawPenaltyPopup(char plr, const struct mStr &mission);
+const struct mStr &PlanAtDuration(const struct MissionType &mission,
+                                  struct mStr &copy);
 
 }; // End of Unnamed namespace part 1
 
@@ -150,9 +152,8 @@ void Downgrade(const char plr, const int pad,
         bool manned = true;
 
         try {
-            struct mStr type = GetMissionPlan(mission.MissionCode);
             // mCrew == 5 means Unmanned Joint mission
-            manned = (type.mCrew == 5) ? false : true;
+            manned = (MissionCrewType(mission.MissionCode) == 5) ? false : true;
         } catch (IOException &err) {
             CCRITICAL4(baris,
                        "Unable to read mission information from file,"
@@ -192,6 +193,31 @@ void Downgrade(const char plr, const int pad,
 namespace   // Unnamed namespace part 2
 {
 
+/* Get the template of a planned mission, with the mission's chosen
+ * duration if it has one.
+ *
+ * The shared template is returned unless the duration has to be
+ * set, in which case it is copied for that.
+ *
+ * \param mission  The planned mission.
+ * \param copy  Receives the template when its duration is set.
+ * \return  the template.
+ */
+const struct mStr &PlanAtDuration(const struct MissionType &mission,
+                                  struct mStr &copy)
+{
+    const struct mStr &plan = GetMissionPlan(mission.MissionCode);
+
+    if (plan.Dur < 1) {
+        return plan;
+    }
+
+    copy = plan;
+    copy.Days = mission.Duration;
+    return copy;
+}
+
+
 /* Summarize the given mission and its relation to the original mission
  * in the specified pad slot.
  *
@@ -205,13 +231,12 @@ void DrawMissionEntry(const char plr, const int pad,
     fill_rectangle(144, 29 + pad * 58, 270, 37 + pad * 58, 3);
     fill_rectangle(93, 43 + pad * 58, 262, 57 + pad * 58, 3);
     display::graphics.setForegroundColor(5);
-    struct mStr plan = GetMissionPlan(mission.MissionCode);
+    struct mStr copy;
+    const struct mStr &plan = PlanAtDuration(mission, copy);
     draw_string(96, 48 + 58 * pad, (plan.Abbr).c_str());
 
     if (plan.Dur >= 1) {
-        int duration = mission.Duration;
-        plan.Days = duration;
-        draw_string(0, 0, GetDurationParens(duration));
+        draw_string(0, 0, GetDurationParens(mission.Duration));
     }
 
     display::graphics.setForegroundColor(9);
@@ -400,7 +425,7 @@ void Rush(char plr)
     Downgrader::Options downgrades;
 
     try {
-        downgrades = LoadJsonDowngrades("DOWNGRADES.JSON");
+        downgrades = *GetDowngrades();
     } catch (IOException &err) {
         CCRITICAL2(baris, err.what());
     }
@@ -736,13 +761,8 @@ void SetRush(int mode, int pad)
 
 void DrawPenaltyPopup(char plr, const struct MissionType &mission)
 {
-    struct mStr plan = GetMissionPlan(mission.MissionCode);
-
-    if (plan.Dur) {
-        plan.Days = mission.Duration;
-    }
-
-    DrawPenaltyPopup(plr, plan);
+    struct mStr copy;
+    DrawPenaltyPopup(plr, PlanAtDuration(mission, copy));
 }
 
 
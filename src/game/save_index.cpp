@@ -0,0 +1,313 @@
+// This file handles the index of save game headers.
+
+#include "save_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <sstream>
+
+#include <sys/stat.h>
+
+#include <cereal/archives/portable_binary.hpp>
+
+#include "Buzz_inc.h"
+#include "options.h"
+#include "utils.h"
+
+LOG_DEFAULT_CATEGORY(LOG_ROOT_CAT)
+
+
+/**
+ * Version of the save index layout.
+ *
+ * Bump this whenever SaveIndexEntry or SaveFileHdr changes; an index
+ * of another version is discarded and rebuilt.
+ */
+#define SAVE_INDEX_VERSION 1
+
+namespace
+{
+const char INDEX_FILE[] = "SAVES.IDX";
+
+bool indexLoaded = false;
+int64_t indexDirModified = -1;
+std::vector<SaveIndexEntry> saveIndex;
+
+/* Lists the save files visible to the game. */
+struct SaveFileEnumerator : public PhysFsEnumerator {
+    std::vector<std::string> names;
+
+    SaveFileEnumerator() : PhysFsEnumerator("/") {}
+    virtual PHYSFS_EnumerateCallbackResult onItem(const std::string &origdir,
+            const std::string &fname);
+};
+
+PHYSFS_EnumerateCallbackResult SaveFileEnumerator::onItem(
+    const std::string &origdir, const std::string &fname)
+{
+    size_t len = fname.size();
+
+    if (len >= 4 && xstrncasecmp(fname.c_str() + len - 4, ".SAV", 4) == 0) {
+        names.push_back(fname);
+    }
+
+    return PHYSFS_ENUM_OK;
+}
+
+std::string SavePath(const std::string &name)
+{
+    return std::string(options.dir_savegame) + "/" + name;
+}
+
+/**
+ * Get the size and modification time of a file or directory.
+ *
+ * \return  false if it can't be found.
+ */
+bool StatPath(const std::string &path, uint64_t &size, int64_t &modified)
+{
+    struct stat info;
+
+    if (stat(path.c_str(), &info) != 0) {
+        return false;
+    }
+
+    size = info.st_size;
+    modified = info.st_mtime;
+    return true;
+}
+
+int64_t DirModified()
+{
+    uint64_t size;
+    int64_t modified;
+    return StatPath(options.dir_savegame, size, modified) ? modified : -1;
+}
+
+/**
+ * Fill in an index entry from the save file itself.
+ *
+ * \return  false if the file can't be read.
+ */
+bool ReadEntry(const std::string &name, SaveIndexEntry &entry)
+{
+    FILE *fin = sOpen(name.c_str(), "rb", FT_SAVE_CHECK);
+
+    if (fin == NULL) {
+        NOTICE2("Unable to open save file %s, skipping", name.c_str());
+        return false;
+    }
+
+    size_t bytes = fread(&entry.header, 1, sizeof(entry.header), fin);
+    fclose(fin);
+
+    if (bytes != sizeof(entry.header)) {
+        NOTICE2("Unable to read save file %s, skipping", name.c_str());
+        return false;
+    }
+
+    entry.name = name;
+
+    if (!StatPath(SavePath(name), entry.size, entry.modified)) {
+        // Not in the save directory, so it can't be checked for changes.
+        entry.size = 0;
+        entry.modified = -1;
+    }
+
+    return true;
+}
+
+void LoadIndex()
+{
+    indexLoaded = true;
+    indexDirModified = -1;
+    saveIndex.clear();
+
+    FILE *fin = sOpen(INDEX_FILE, "rb", FT_SAVE_CHECK);
+
+    if (fin == NULL) {
+        return;
+    }
+
+    std::string blob;
+    char buffer[4096];
+    size_t bytes;
+
+    while ((bytes = fread(buffer, 1, sizeof(buffer), fin)) > 0) {
+        blob.append(buffer, bytes);
+    }
+
+    fclose(fin);
+
+    try {
+        std::istringstream is(blob);
+        cereal::PortableBinaryInputArchive archive(is);
+        uint32_t version;
+
+        archive(version);
+
+        if (version != SAVE_INDEX_VERSION) {
+            INFO2("discarding save index version %u", version);
+            return;
+        }
+
+        archive(indexDirModified, saveIndex);
+    } catch (const std::exception &e) {
+        WARNING2("discarding unreadable save index: %s", e.what());
+        indexDirModified = -1;
+        saveIndex.clear();
+    }
+}
+
+/**
+ * Write the index to the save directory.
+ *
+ * The file is rewritten in place rather than renamed into place, so
+ * that, once it exists, writing it leaves the directory's modification
+ * time alone. A damaged index is simply rebuilt.
+ */
+void StoreIndex()
+{
+    FILE *fout = sOpen(INDEX_FILE, "wb", FT_SAVE);
+
+    if (fout == NULL) {
+        return;
+    }
+
+    // Taken after opening, which may have created the file.
+    indexDirModified = DirModified();
+
+    std::ostringstream os;
+    {
+        cereal::PortableBinaryOutputArchive archive(os);
+        uint32_t version = SAVE_INDEX_VERSION;
+        archive(version, indexDirModified, saveIndex);
+    }
+
+    const std::string blob = os.str();
+    bool ok = fwrite(blob.data(), 1, blob.size(), fout) == blob.size();
+
+    if (fclose(fout) != 0 || !ok) {
+        WARNING1("can't write save index");
+        indexDirModified = -1;
+    }
+}
+
+/**
+ * Bring the index in line with the save directory.
+ *
+ * Files whose size and modification time match their entry are
+ * trusted; the rest have their headers read again.
+ */
+void RebuildIndex()
+{
+    SaveFileEnumerator files;
+    files.enumerate();
+
+    std::map<std::string, size_t> known;
+
+    for (size_t i = 0; i < saveIndex.size(); i++) {
+        known[saveIndex[i].name] = i;
+    }
+
+    std::vector<SaveIndexEntry> entries;
+    entries.reserve(files.names.size());
+
+    for (size_t i = 0; i < files.names.size(); i++) {
+        const std::string &name = files.names[i];
+        std::map<std::string, size_t>::const_iterator it = known.find(name);
+        uint64_t size;
+        int64_t modified;
+
+        if (it != known.end() && saveIndex[it->second].modified >= 0 &&
+            StatPath(SavePath(name), size, modified) &&
+            size == saveIndex[it->second].size &&
+            modified == saveIndex[it->second].modified) {
+            entries.push_back(saveIndex[it->second]);
+            continue;
+        }
+
+        SaveIndexEntry entry;
+
+        if (ReadEntry(name, entry)) {
+            entries.push_back(entry);
+        }
+    }
+
+    saveIndex.swap(entries);
+    StoreIndex();
+}
+
+std::vector<SaveIndexEntry>::iterator FindEntry(const std::string &name)
+{
+    std::vector<SaveIndexEntry>::iterator it = saveIndex.begin();
+
+    for (; it != saveIndex.end() && it->name != name; ++it);
+
+    return it;
+}
+};
+
+
+/**
+ * The index of save files, revalidated against the save directory.
+ *
+ * \return  one entry per readable save file, in no particular order.
+ */
+const std::vector<SaveIndexEntry> &GetSaveIndex()
+{
+    if (!indexLoaded) {
+        LoadIndex();
+    }
+
+    if (indexDirModified < 0 || indexDirModified != DirModified()) {
+        RebuildIndex();
+    }
+
+    return saveIndex;
+}
+
+
+/**
+ * Refresh the entry for a save file that has just been written.
+ *
+ * \param name  the file name, relative to the save directory.
+ */
+void UpdateSaveIndex(const char *name)
+{
+    GetSaveIndex();
+
+    SaveIndexEntry entry;
+    std::vector<SaveIndexEntry>::iterator it = FindEntry(name);
+
+    if (!ReadEntry(name, entry)) {
+        if (it != saveIndex.end()) {
+            saveIndex.erase(it);
+        }
+    } else if (it != saveIndex.end()) {
+        *it = entry;
+    } else {
+        saveIndex.push_back(entry);
+    }
+
+    StoreIndex();
+}
+
+
+/**
+ * Drop the entry for a save file that has been deleted.
+ *
+ * \param name  the file name, relative to the save directory.
+ */
+void RemoveFromSaveIndex(const char *name)
+{
+    GetSaveIndex();
+
+    std::vector<SaveIndexEntry>::iterator it = FindEntry(name);
+
+    if (it != saveIndex.end()) {
+        saveIndex.erase(it);
+        StoreIndex();
+    }
+}
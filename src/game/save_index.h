@@ -0,0 +1,40 @@
+#ifndef SAVE_INDEX_H
+#define SAVE_INDEX_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "data.h"
+
+
+/* What the save browser needs to know about a save file. */
+struct SaveIndexEntry {
+    std::string name;       /**< File name in the save directory */
+    SaveFileHdr header;
+    uint64_t size;          /**< File size in bytes */
+    int64_t modified;       /**< Modification time, seconds since the epoch */
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(name);
+        ar(cereal::binary_data(&header, sizeof(header)));
+        ar(size, modified);
+    }
+};
+
+/**
+ * An index of the save game headers in the save directory.
+ *
+ * The index is kept in the save directory, so listing the saves does
+ * not need to open each file. It is checked against the directory's
+ * modification time, and only files whose size or modification time
+ * changed are read again.
+ */
+const std::vector<SaveIndexEntry> &GetSaveIndex();
+void UpdateSaveIndex(const char *name);
+void RemoveFromSaveIndex(const char *name);
+
+#endif // SAVE_INDEX_H
@@ -37,6 +37,7 @@
 
 #include "Buzz_inc.h"
 #include "options.h"
+#include "pace.h"
 #include "utils.h"
 
 #define MAX_X   320
@@ -234,6 +235,11 @@ av_setup(void)
 
 #endif
 
+    // Simulations show nothing, so open no window or sound device.
+    if (options.want_simulate) {
+        SDL_putenv((char *)"SDL_VIDEODRIVER=dummy");
+        SDL_putenv((char *)"SDL_AUDIODRIVER=dummy");
+    }
 
     display::graphics.create(title, (options.want_fullscreen == 1));
 
@@ -302,7 +308,7 @@ av_process_event(SDL_Event *evp)
     switch (evp->type) {
     case SDL_QUIT:
         TRACE2("event %04x", evp->type);
-        exit(0);
+        CloseEmUp(0, 0);
         break;
 
     case SDL_USEREVENT:
@@ -943,6 +949,11 @@ av_set_fading(int type, int from, int to, int steps, int preserve)
     fade_info.inc = dir;
     fade_info.end = st_end;
 
+    // A fast presentation goes straight to the end of the fade
+    if (presentation_speed() >= PRESENT_FAST) {
+        fade_info.step = fade_info.end;
+    }
+
     for (; fade_info.step != fade_info.end; fade_info.step += fade_info.inc) {
         av_sync();
         SDL_Delay(10);
@@ -0,0 +1,719 @@
+// This file handles headless computer-vs-computer games.
+//
+// With --simulate the game plays both sides itself, with every wait,
+// fade and animation skipped (see options.want_simulate), and prints
+// the outcome as JSON on standard output. With --games=N it plays N
+// games from consecutive seeds, spread over --jobs worker processes,
+// and prints statistics over all of them instead.
+
+#include "simulate.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifndef CONFIG_WIN32
+#include <csignal>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "Buzz_inc.h"
+#include "admin.h"
+#include "game_main.h"
+#include "json_cache.h"
+#include "options.h"
+#include "pace.h"
+#include "pbm.h"
+#include "prefs.h"
+#include "turn_history.h"
+#include "utils.h"
+
+LOG_DEFAULT_CATEGORY(LOG_ROOT_CAT)
+
+
+namespace
+{
+const char *SideName(int side)
+{
+    return (side == 0) ? "USA" : (side == 1) ? "USSR" : "none";
+}
+
+/* The state of both sides at the end of a turn. */
+struct SimulatedTurn {
+    int year;
+    int season;
+    int prestige[NUM_PLAYERS];  // Earned this turn
+    int budget[NUM_PLAYERS];
+    int cash[NUM_PLAYERS];
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(cereal::make_nvp("year", year));
+        ar(cereal::make_nvp("season", std::string(season ? "fall" : "spring")));
+
+        for (int i = 0; i < NUM_PLAYERS; i++) {
+            ar.setNextName(SideName(i));
+            ar.startNode();
+            ar(cereal::make_nvp("prestige", prestige[i]));
+            ar(cereal::make_nvp("budget", budget[i]));
+            ar(cereal::make_nvp("cash", cash[i]));
+            ar.finishNode();
+        }
+    }
+};
+
+/* A mission from a side's mission history. */
+struct SimulatedMission {
+    const char *side;
+    const struct PastInfo *mission;
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(cereal::make_nvp("side", std::string(side)));
+        ar(cereal::make_nvp("name", std::string(mission->MissionName[0])));
+        ar(cereal::make_nvp("code", (int)mission->MissionCode));
+        ar(cereal::make_nvp("year", 1900 + mission->MissionYear));
+        ar(cereal::make_nvp("month", mission->Month + 1));
+        ar(cereal::make_nvp("result", (int)mission->spResult));
+        ar(cereal::make_nvp("prestige", (int)mission->Prestige));
+        ar(cereal::make_nvp("duration", (int)mission->Duration));
+    }
+};
+
+std::vector<SimulatedTurn> simulatedTurns;
+
+
+/* The outcome of one game of a batch, as one CSV row. */
+struct GameSummary {
+    unsigned long long seed;
+    int winner;                     // -1 if nobody landed
+    int landingYear;                // 0 if nobody landed
+    int deaths[NUM_PLAYERS];        // Astronauts killed
+    double safety[NUM_PLAYERS];     // Mean safety of started programs
+    int budget[NUM_PLAYERS];
+    int missions[NUM_PLAYERS];
+};
+
+const char *const CSV_HEADER =
+    "seed,winner,landing_year,deaths_usa,deaths_ussr,"
+    "safety_usa,safety_ussr,budget_usa,budget_ussr,"
+    "missions_usa,missions_ussr\n";
+
+/*
+ * Statistics of one quantity over a batch.
+ *
+ * The mean and variance are kept running (Welford's method), which
+ * stays accurate over many games. The values themselves are kept for
+ * the percentiles, which show how the games spread where the mean
+ * alone can't.
+ */
+struct Statistic {
+    int count;
+    double mean;
+    double m2;      // Sum of squared differences from the mean
+    double min;
+    double max;
+    std::vector<double> values;
+
+    Statistic() : count(0), mean(0), m2(0), min(0), max(0) {}
+
+    void add(double value)
+    {
+        min = (count == 0) ? value : std::min(min, value);
+        max = (count == 0) ? value : std::max(max, value);
+        count++;
+
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+        values.push_back(value);
+    }
+
+    /* The sample standard deviation. */
+    double stddev() const
+    {
+        return (count > 1) ? std::sqrt(m2 / (count - 1)) : 0.0;
+    }
+
+    /* The value at a percentile of the sorted values, by nearest rank. */
+    static double percentile(const std::vector<double> &sorted, int pct)
+    {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+
+        size_t rank = (pct * sorted.size() + 99) / 100;
+        return sorted[std::max<size_t>(rank, 1) - 1];
+    }
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        const int percentiles[] = { 5, 25, 50, 75, 95 };
+        std::vector<double> sorted(values);
+        std::sort(sorted.begin(), sorted.end());
+
+        ar(cereal::make_nvp("mean", mean));
+        ar(cereal::make_nvp("stddev", stddev()));
+        ar(cereal::make_nvp("min", min));
+
+        for (size_t i = 0; i < sizeof(percentiles) / sizeof(*percentiles);
+             i++) {
+            std::string name = "p" + std::to_string(percentiles[i]);
+            ar(cereal::make_nvp(name.c_str(),
+                                percentile(sorted, percentiles[i])));
+        }
+
+        ar(cereal::make_nvp("max", max));
+    }
+};
+
+/* Statistics over a whole batch. */
+struct BatchSummary {
+    int games;
+    int jobs;
+    double seconds;
+    bool reproducible;              // A game replayed alone matched
+    int winners[NUM_PLAYERS + 1];   // Last is nobody
+    std::map<int, int> landingYears;
+    Statistic deaths[NUM_PLAYERS];
+    Statistic safety[NUM_PLAYERS];
+    Statistic budget[NUM_PLAYERS];
+
+    BatchSummary() : games(0), jobs(0), seconds(0), reproducible(false)
+    {
+        std::fill(winners, winners + NUM_PLAYERS + 1, 0);
+    }
+
+    void add(const GameSummary &game)
+    {
+        games++;
+        winners[(game.winner < 0) ? NUM_PLAYERS : game.winner]++;
+
+        if (game.landingYear) {
+            landingYears[game.landingYear]++;
+        }
+
+        for (int i = 0; i < NUM_PLAYERS; i++) {
+            deaths[i].add(game.deaths[i]);
+            safety[i].add(game.safety[i]);
+            budget[i].add(game.budget[i]);
+        }
+    }
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(cereal::make_nvp("games", games));
+        ar(cereal::make_nvp("jobs", jobs));
+        ar(cereal::make_nvp("seconds", seconds));
+        ar(cereal::make_nvp("reproducible", reproducible));
+
+        ar.setNextName("winner");
+        ar.startNode();
+
+        for (int i = 0; i <= NUM_PLAYERS; i++) {
+            ar(cereal::make_nvp(SideName((i < NUM_PLAYERS) ? i : -1),
+                                winners[i]));
+        }
+
+        ar.finishNode();
+
+        ar.setNextName("landing_year");
+        ar.startNode();
+
+        for (std::map<int, int>::const_iterator it = landingYears.begin();
+             it != landingYears.end(); ++it) {
+            std::string year = std::to_string(it->first);
+            ar(cereal::make_nvp(year.c_str(), it->second));
+        }
+
+        ar.finishNode();
+
+        SerializeBySide(ar, "deaths", deaths);
+        SerializeBySide(ar, "safety", safety);
+        SerializeBySide(ar, "budget", budget);
+    }
+
+    template<class Archive>
+    static void SerializeBySide(Archive &ar, const char *name,
+                                Statistic (&stats)[NUM_PLAYERS])
+    {
+        ar.setNextName(name);
+        ar.startNode();
+
+        for (int i = 0; i < NUM_PLAYERS; i++) {
+            ar(cereal::make_nvp(SideName(i), stats[i]));
+        }
+
+        ar.finishNode();
+    }
+};
+
+
+/* Summarize the game just played. */
+GameSummary Summarize(uint64_t seed)
+{
+    const struct PrestType &landing =
+        Data->Prestige[Prestige_MannedLunarLanding];
+    GameSummary game;
+
+    game.seed = seed;
+    game.winner = landing.Place;
+    game.landingYear = (landing.Place != -1) ? 1900 + landing.Year : 0;
+
+    for (int i = 0; i < NUM_PLAYERS; i++) {
+        const struct BuzzData &side = Data->P[i];
+        const Equipment *programs[4] = {
+            side.Probe, side.Rocket, side.Manned, side.Misc
+        };
+        const int sizes[4] = { 3, 5, 7, 6 };
+        int started = 0, total = 0;
+
+        game.deaths[i] = 0;
+
+        for (int j = 0; j < side.AstroCount; j++) {
+            if (side.Pool[j].Status == AST_ST_DEAD) {
+                game.deaths[i]++;
+            }
+        }
+
+        for (int j = 0; j < 4; j++) {
+            for (int k = 0; k < sizes[j]; k++) {
+                if (programs[j][k].Num >= 0) {
+                    total += programs[j][k].Safety;
+                    started++;
+                }
+            }
+        }
+
+        game.safety[i] = started ? (double)total / started : 0;
+        game.budget[i] = side.Budget;
+        game.missions[i] = side.PastMissionCount;
+    }
+
+    return game;
+}
+
+
+void WriteSummaryRow(FILE *out, const GameSummary &game)
+{
+    fprintf(out, "%llu,%d,%d,%d,%d,%.2f,%.2f,%d,%d,%d,%d\n",
+            game.seed, game.winner, game.landingYear,
+            game.deaths[0], game.deaths[1],
+            game.safety[0], game.safety[1],
+            game.budget[0], game.budget[1],
+            game.missions[0], game.missions[1]);
+}
+
+
+bool ReadSummaryRow(const char *line, GameSummary &game)
+{
+    return sscanf(line, "%llu,%d,%d,%d,%d,%lf,%lf,%d,%d,%d,%d",
+                  &game.seed, &game.winner, &game.landingYear,
+                  &game.deaths[0], &game.deaths[1],
+                  &game.safety[0], &game.safety[1],
+                  &game.budget[0], &game.budget[1],
+                  &game.missions[0], &game.missions[1]) == 11;
+}
+
+
+/* Play one game of a batch and write its row. */
+void PlayBatchGame(uint64_t seed, FILE *out)
+{
+    if (SetupSimulation(seed)) {
+        MainLoop();
+        WriteSummaryRow(out, Summarize(seed));
+    }
+}
+
+
+/**
+ * Play a game of the batch again on its own, and check it gives the
+ * same row, so that any game can be replayed alone with its seed.
+ *
+ * \param seed  the game's seed.
+ * \param row  the game's row from the batch.
+ * \return  true if the game played the same.
+ */
+bool ReplaysAlone(uint64_t seed, const std::string &row)
+{
+    FILE *out = tmpfile();
+    char line[256];
+    bool same = false;
+
+    if (out == NULL) {
+        return false;
+    }
+
+    PlayBatchGame(seed, out);
+    rewind(out);
+
+    if (fgets(line, sizeof(line), out) != NULL) {
+        same = (row == line);
+    }
+
+    fclose(out);
+    return same;
+}
+
+
+#ifndef CONFIG_WIN32
+/**
+ * Play a batch in worker processes.
+ *
+ * The workers are forked once the game data is loaded, and take game
+ * numbers from a shared pipe as they finish their last game, so a
+ * worker stuck with long games doesn't hold up the others. Each writes
+ * its rows to its own temporary file.
+ *
+ * \return  true if every worker finished.
+ */
+bool PlayBatchInWorkers(uint64_t seed, int games, int jobs,
+                        std::vector<FILE *> &rows)
+{
+    int tasks[2];
+    std::vector<pid_t> workers;
+    bool ok = true;
+
+    if (pipe(tasks) != 0) {
+        CRITICAL2("can't create worker pipe: %s", strerror(errno));
+        return false;
+    }
+
+    fflush(NULL);
+
+    for (int j = 0; j < jobs; j++) {
+        FILE *out = tmpfile();
+        pid_t pid = (out != NULL) ? fork() : -1;
+
+        if (pid == 0) {
+            uint32_t game;
+
+            close(tasks[1]);
+
+            while (read(tasks[0], &game, sizeof(game)) == sizeof(game)) {
+                PlayBatchGame(seed + game, out);
+            }
+
+            fflush(out);
+            _exit(EXIT_SUCCESS);
+        } else if (pid < 0) {
+            CRITICAL2("can't start worker: %s", strerror(errno));
+
+            if (out != NULL) {
+                fclose(out);
+            }
+
+            ok = false;
+            break;
+        }
+
+        workers.push_back(pid);
+        rows.push_back(out);
+    }
+
+    close(tasks[0]);
+
+    // With no workers left, writes fail rather than raising SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+
+    for (uint32_t game = 0; ok && game < (uint32_t)games; game++) {
+        if (write(tasks[1], &game, sizeof(game)) != sizeof(game)) {
+            CRITICAL2("can't hand out games: %s", strerror(errno));
+            ok = false;
+        }
+    }
+
+    close(tasks[1]);
+
+    for (size_t j = 0; j < workers.size(); j++) {
+        int status;
+
+        if (waitpid(workers[j], &status, 0) != workers[j] ||
+            !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            WARNING2("simulation worker %d failed", (int)workers[j]);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+
+int DefaultJobs()
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return (cpus > 0) ? (int)cpus : 1;
+}
+#else
+int DefaultJobs()
+{
+    return 1;
+}
+#endif
+
+
+void WriteResult(std::ostream &out, double seconds)
+{
+    const struct PrestType &landing =
+        Data->Prestige[Prestige_MannedLunarLanding];
+    std::vector<SimulatedMission> missions;
+
+    for (int i = 0; i < NUM_PLAYERS; i++) {
+        for (int j = 0; j < Data->P[i].PastMissionCount; j++) {
+            SimulatedMission mission = {SideName(i), &Data->P[i].History[j]};
+            missions.push_back(mission);
+        }
+    }
+
+    {
+        cereal::JSONOutputArchive archive(out);
+
+        archive(cereal::make_nvp("seed", (unsigned long long)gameRng.seedValue()));
+        archive(cereal::make_nvp("winner", std::string(SideName(landing.Place))));
+
+        if (landing.Place != -1) {
+            archive.setNextName("landing");
+            archive.startNode();
+            archive(cereal::make_nvp("year", 1900 + landing.Year));
+            archive(cereal::make_nvp("month", landing.Month + 1));
+            archive.finishNode();
+        }
+
+        archive(cereal::make_nvp("turns", simulatedTurns));
+        archive(cereal::make_nvp("missions", missions));
+        archive(cereal::make_nvp("seconds", seconds));
+    }
+
+    out << std::endl;
+}
+};
+
+
+/**
+ * Set up a new game between two computer players, as the new game
+ * screen would.
+ *
+ * \param seed  the seed for the game's random number generators.
+ * \return  false if the game data can't be used.
+ */
+bool SetupSimulation(uint64_t seed)
+{
+    DeserializeCachedJSON(Data, "urast.json");
+
+    if (Data->Checksum != (sizeof(struct Players))) {
+        CRITICAL1("wrong version of data file");
+        return false;
+    }
+
+    LOAD = QUIT = 0;
+    MAIL = Option = -1;
+
+    Data->Def.Plr1 = 2;
+    Data->Def.Plr2 = 3;
+    ApplyHardwareModel();
+    CacheCrewFile();
+
+    for (int i = 0; i < NUM_PLAYERS; i++) {
+        Data->plr[i] = plr[i] = 2 + i;
+        AI[i] = 1;
+    }
+
+    for (size_t i = 0; i < interimData.tempReplay.size(); i++) {
+        interimData.tempReplay[i].clear();
+    }
+
+    turnHistory.clear();
+    gameRng.seed(seed);
+    InitData();
+    simulatedTurns.clear();
+    return true;
+}
+
+
+/**
+ * \return  the seed given by --seed, or else one from the clock.
+ */
+uint64_t BaseSeed()
+{
+    return options.want_rng_seed ? options.rng_seed : ClockSeed();
+}
+
+
+/**
+ * Play a whole game between two computer players and print the result.
+ *
+ * The game starts as a new game with the default settings from
+ * urast.json, and is seeded from --seed if given. With --games, a
+ * batch is played instead; see RunSimulationBatch().
+ *
+ * \return  the exit status for the program.
+ */
+int RunSimulation(void)
+{
+    uint64_t seed = BaseSeed();
+
+    if (options.sim_games > 0) {
+        return RunSimulationBatch(seed);
+    }
+
+    if (!SetupSimulation(seed)) {
+        return EXIT_FAILURE;
+    }
+
+    double start = get_time();
+
+    MainLoop();
+    WriteResult(std::cout, get_time() - start);
+
+    return EXIT_SUCCESS;
+}
+
+
+/**
+ * Play a batch of games and print statistics over them.
+ *
+ * Game i is seeded with seed + i, so any game can be replayed alone
+ * with --simulate --seed. The per-game rows are written to the file
+ * named by --csv, if any.
+ *
+ * \param seed  the seed of the first game.
+ * \return  the exit status for the program.
+ */
+int RunSimulationBatch(uint64_t seed)
+{
+    int games = options.sim_games;
+    int jobs = options.sim_jobs ? (int)options.sim_jobs : DefaultJobs();
+    std::vector<FILE *> rows;
+    bool ok = true;
+    double start = get_time();
+
+    jobs = std::max(1, std::min(jobs, games));
+
+#ifndef CONFIG_WIN32
+
+    if (jobs > 1) {
+        ok = PlayBatchInWorkers(seed, games, jobs, rows);
+    } else
+#endif
+    {
+        FILE *out = tmpfile();
+
+        if (out == NULL) {
+            CRITICAL2("can't create temporary file: %s", strerror(errno));
+            return EXIT_FAILURE;
+        }
+
+        rows.push_back(out);
+
+        for (int i = 0; i < games; i++) {
+            PlayBatchGame(seed + i, out);
+        }
+    }
+
+    FILE *csv = NULL;
+
+    if (options.sim_csv != NULL && options.sim_csv[0] != '\0') {
+        csv = fopen(options.sim_csv, "w");
+
+        if (csv == NULL) {
+            ERROR3("can't write `%s': %s", options.sim_csv, strerror(errno));
+        } else {
+            fputs(CSV_HEADER, csv);
+        }
+    }
+
+    BatchSummary summary;
+    uint64_t lastSeed = seed + games - 1;
+    std::string lastRow;
+    char line[256];
+
+    for (size_t j = 0; j < rows.size(); j++) {
+        rewind(rows[j]);
+
+        while (fgets(line, sizeof(line), rows[j]) != NULL) {
+            GameSummary game;
+
+            if (ReadSummaryRow(line, game)) {
+                summary.add(game);
+
+                if (game.seed == lastSeed) {
+                    lastRow = line;
+                }
+
+                if (csv != NULL) {
+                    fputs(line, csv);
+                }
+            }
+        }
+
+        fclose(rows[j]);
+    }
+
+    if (csv != NULL && fclose(csv) != 0) {
+        ERROR3("can't write `%s': %s", options.sim_csv, strerror(errno));
+    }
+
+    if (summary.games < games) {
+        WARNING3("only %d of %d games finished", summary.games, games);
+        ok = false;
+    }
+
+    // The last game was played after others in the same process, so
+    // anything it carried over from them shows up here
+    summary.reproducible = !lastRow.empty() && ReplaysAlone(lastSeed, lastRow);
+
+    if (!summary.reproducible) {
+        WARNING2("game %llu plays differently alone than in the batch",
+                 (unsigned long long)lastSeed);
+        ok = false;
+    }
+
+    summary.jobs = jobs;
+    summary.seconds = get_time() - start;
+
+    {
+        cereal::JSONOutputArchive archive(std::cout);
+        archive(cereal::make_nvp("batch", summary));
+    }
+
+    std::cout << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/**
+ * Note the prestige and money of both sides at the end of a turn.
+ *
+ * Called by MainLoop() in simulations, before the turn's prestige is
+ * cleared.
+ */
+void RecordSimulatedTurn(void)
+{
+    SimulatedTurn turn;
+
+    turn.year = 1900 + Data->Year;
+    turn.season = Data->Season;
+
+    for (int i = 0; i < NUM_PLAYERS; i++) {
+        turn.prestige[i] = Data->P[i].Prestige;
+        turn.budget[i] = Data->P[i].Budget;
+        turn.cash[i] = Data->P[i].Cash;
+    }
+
+    simulatedTurns.push_back(turn);
+}
@@ -0,0 +1,12 @@
+#ifndef SIMULATE_H
+#define SIMULATE_H
+
+#include <stdint.h>
+
+bool SetupSimulation(uint64_t seed);
+uint64_t BaseSeed();
+int RunSimulation(void);
+int RunSimulationBatch(uint64_t seed);
+void RecordSimulatedTurn(void);
+
+#endif // SIMULATE_H
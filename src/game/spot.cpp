@@ -30,12 +30,15 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <cstring>
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "display/graphics.h"
 
 #include "data.h"
-#include "endianness.h"
 #include "fs.h"
 #include "gamedata.h"
 #include "logging.h"
@@ -73,29 +76,48 @@ struct CelHeader {
     uint8_t w, h;   // Width and Height
 };
 
+/* A decoded, scaled cel ready for drawing. */
+struct Cel {
+    int w, h;
+    std::vector<char> pixels;
+    // Runs of opaque pixels, as (start, length) offsets into pixels.
+    // Everything else is transparent and shows the Port background.
+    std::vector<std::pair<int, int> > opaque;
+};
+
 namespace
 {
 const int MAX_X = display::Graphics::WIDTH - 1;
 const int MAX_Y = display::Graphics::HEIGHT - 1;
 
+typedef std::pair<uint16_t, uint32_t> CelKey;  // Image, Scale bits
+
 boost::shared_ptr<display::LegacySurface> portViewBuffer;
+// Scratch surface for compositing a cel over the Port background
+boost::shared_ptr<display::LegacySurface> frameBuffer;
 bool SUSPEND = true;
 bool isTrackPlaying = false;
+bool animationLoaded = false;
 int16_t stepCount;     // stepCount is the number of steps
-FILE *sFin = NULL;
+std::vector<uint8_t> spotData;  // The contents of SPOTS.CDR
 struct SpotHeader mainHeader;
+std::vector<struct AnimationStep> animationSteps;
+std::map<CelKey, Cel> celCache;
 struct AnimationStep sPath;
-struct CelHeader sImg;
-uint32_t pLoc;
+const Cel *sImg = NULL;
+size_t pLoc;           // Index of the next step in animationSteps
 
 void AdvanceFrame();
 #if BABYSND
 std::string AudioTrack(int trackIndex);
 #endif
-size_t ImportSpotHeader(FILE *fin, struct SpotHeader &target);
-size_t ImportSPath(FILE *fin, struct AnimationStep &target);
-void SeekCelData(int celIndex);
-void SeekAnimation(int index);
+const Cel *GetCel(uint16_t image, float scale);
+bool LoadSpotData();
+bool ReadAnimation(int index);
+size_t ImportSpotHeader(const uint8_t *src, struct SpotHeader &target);
+size_t ImportSPath(const uint8_t *src, struct AnimationStep &target);
+uint16_t ReadLE16(const uint8_t *src);
+uint32_t ReadLE32(const uint8_t *src);
 };
 
 
@@ -129,6 +151,7 @@ void SpotClose()
 {
     SpotKill();
     portViewBuffer.reset();
+    frameBuffer.reset();
 }
 
 
@@ -141,7 +164,7 @@ void SpotClose()
  */
 void SpotInit()
 {
-    sFin = NULL;
+    animationLoaded = false;
     stepCount = -1;
     SUSPEND = false;
     isTrackPlaying = false;
@@ -154,24 +177,25 @@ void SpotInit()
     portViewBuffer->palette().copy_from(
         display::graphics.legacyScreen()->palette());
     portViewBuffer->draw(*display::graphics.screen(), 0, 0);
+
+    frameBuffer = boost::shared_ptr<display::LegacySurface>(
+                      new display::LegacySurface(width, height));
 }
 
 
 /**
  * Terminate any spaceport animation currently playing.
  *
- * Stops any active animation, any active sound effects, and closes
- * the animation file. An animation stopped with this function is
- * not paused. It may not be resumed and will have to be reloaded.
+ * Stops any active animation and any active sound effects. An
+ * animation stopped with this function is not paused. It may not be
+ * resumed and will have to be reloaded.
  *
  * Calling this should be safe when there is no animation loaded.
  */
 void SpotKill()
 {
-    if (sFin) {
-        fclose(sFin);
-        sFin = NULL;
-    }
+    animationLoaded = false;
+    sImg = NULL;
 
     sPath.iHold = 0;
     sPath.xPut = -1;
@@ -236,6 +260,10 @@ void SpotKill()
  *    iHold    - For timing, how many times to redraw this frame
  *    Scale    - A multiplier to scale the cel up or down
  *
+ * spots.cdr is read into memory on first use, and cels are decoded
+ * and scaled the first time they are drawn, so a running animation
+ * does no file I/O.
+ *
  * \param animationIndex  Animation's index in spots.cdr
  */
 void SpotLoad(int animationIndex)
@@ -245,15 +273,13 @@ void SpotLoad(int animationIndex)
         return;
     }
 
-    if (sFin) {
+    if (animationLoaded) {
         SpotKill();
     }
 
-    // Open File
-    sFin = sOpen("SPOTS.CDR", "rb", FT_DATA);
-
-    // Read in Spot Header
-    ImportSpotHeader(sFin, mainHeader);
+    if (!LoadSpotData()) {
+        return;
+    }
 
     if (animationIndex < 0 || animationIndex >= mainHeader.Qty) {
         SpotKill();
@@ -263,12 +289,17 @@ void SpotLoad(int animationIndex)
         return;
     }
 
-    char pathName[20];
-    SeekAnimation(animationIndex);  // go to correct path
-    fread(&pathName, sizeof pathName, 1, sFin);    // Animation name
-    fread(&stepCount, sizeof stepCount, 1, sFin);  // # of path parts
-    Swap16bit(stepCount);
-    pLoc = ftell(sFin);
+    if (!ReadAnimation(animationIndex)) {
+        SpotKill();
+        CERROR3(multimedia,
+                "Cannot load spaceport animation %d: Bad data",
+                animationIndex);
+        return;
+    }
+
+    animationLoaded = true;
+    stepCount = animationSteps.size();  // # of path parts
+    pLoc = 0;
 
     // Initialize some values because no animation step has been read.
     sPath.iHold = 1;
@@ -335,28 +366,31 @@ namespace
 {
 
 /**
+ * Draw the next step of the current animation.
  *
+ * The previous step's cel is erased with the cached Port display,
+ * and the new cel is composited over that background in frameBuffer
+ * before being copied to the screen.
  */
 void AdvanceFrame()
 {
     bool firstStep = (sPath.xPut == -1);
+    display::LegacySurface *screen = display::graphics.legacyScreen();
 
-    portViewBuffer->palette().copy_from(
-        display::graphics.legacyScreen()->palette());
+    portViewBuffer->palette().copy_from(screen->palette());
+    frameBuffer->palette().copy_from(screen->palette());
 
     // Draw over previous frame with cached Port display.
-    if (! firstStep) {
+    if (! firstStep && sImg) {
         portViewBuffer->copyTo(
-            display::graphics.legacyScreen(),
+            screen,
             sPath.xPut, sPath.yPut,
             sPath.xPut, sPath.yPut,
-            MIN(sPath.xPut + sImg.w - 1, MAX_X),
-            MIN(sPath.yPut + sImg.h - 1, MAX_Y));
+            MIN(sPath.xPut + sImg->w - 1, MAX_X),
+            MIN(sPath.yPut + sImg->h - 1, MAX_Y));
     }
 
-    fseek(sFin, pLoc, SEEK_SET);  // position at new path step
-    ImportSPath(sFin, sPath);     // Read the AnimationStep
-    pLoc = ftell(sFin);           // Save the next Path step's location
+    sPath = animationSteps.at(pLoc++);  // Read the AnimationStep
 
     // No point in creating expensive images if they won't be drawn.
     if (sPath.xPut > MAX_X || sPath.yPut > MAX_Y) {
@@ -364,44 +398,41 @@ void AdvanceFrame()
         return;
     }
 
-    SeekCelData(sPath.Image);     // point to next image
-    fread(&sImg.w, sizeof(sImg.w), 1, sFin);  // Get Cel dimensions
-    fread(&sImg.h, sizeof(sImg.h), 1, sFin);
+    sImg = GetCel(sPath.Image, sPath.Scale);
 
-    // Read in the raw image data
-    display::LegacySurface *celImage =
-        new display::LegacySurface(sImg.w, sImg.h);
-    fread(celImage->pixels(), sImg.w * sImg.h, 1, sFin);
+    if (sImg == NULL) {
+        sPath.xPut = -1;
+        return;
+    }
 
-    if (sPath.Scale != 1.0) {
-        sImg.w = (int)((float) sImg.w * sPath.Scale);
-        sImg.h = (int)((float) sImg.h * sPath.Scale);
-        display::LegacySurface *scaledImage =
-            new display::LegacySurface(sImg.w, sImg.h);
-        celImage->scaleTo(scaledImage);
+    const int x2 = MIN(sPath.xPut + sImg->w - 1, MAX_X);
+    const int y2 = MIN(sPath.yPut + sImg->h - 1, MAX_Y);
 
-        delete celImage;
-        celImage = scaledImage;
-    }
+    frameBuffer->copyFrom(portViewBuffer.get(),
+                          sPath.xPut, sPath.yPut, x2, y2,
+                          sPath.xPut, sPath.yPut);
 
-    display::LegacySurface *frameBackground =
-        new display::LegacySurface(sImg.w, sImg.h);
+    // Draw the opaque pixels of the cel over the background,
+    // clipped to the screen.
+    char *dest = frameBuffer->pixels();
+    const int pitch = frameBuffer->width();
 
-    frameBackground->copyFrom(portViewBuffer.get(),
-                              sPath.xPut, sPath.yPut,
-                              MIN(sPath.xPut + sImg.w - 1, MAX_X),
-                              MIN(sPath.yPut + sImg.h - 1, MAX_Y),
-                              0, 0);
+    for (size_t i = 0; i < sImg->opaque.size(); i++) {
+        int start = sImg->opaque[i].first;
+        int row = start / sImg->w;
+        int col = start % sImg->w;
+        int length = MIN(sImg->opaque[i].second, x2 - sPath.xPut - col + 1);
 
-    celImage->maskCopy(
-        frameBackground, 0, display::LegacySurface::DestinationEqual, 0);
-    celImage->copyTo(
-        display::graphics.legacyScreen(), sPath.xPut, sPath.yPut);
+        if (sPath.yPut + row > y2 || length <= 0) {
+            continue;
+        }
+
+        memcpy(dest + (sPath.yPut + row) * pitch + sPath.xPut + col,
+               &sImg->pixels[start], length);
+    }
 
-    delete frameBackground;
-    frameBackground = NULL;
-    delete celImage;
-    celImage = NULL;
+    frameBuffer->copyTo(screen, sPath.xPut, sPath.yPut,
+                        sPath.xPut, sPath.yPut, x2, y2);
 }
 
 
@@ -466,74 +497,134 @@ std::string AudioTrack(int trackIndex)
 
 
 /**
- * Read in the main header of a Spot animation file, correcting for
- * endianness.
+ * Get a cel, decoding and scaling it if it isn't cached.
  *
- * If import is not successful, the contents of the target
- * are not guaranteed.
+ * Images consist of a CelHeader followed by raw palettized pixel
+ * data, with pixels of color 0 being transparent.
  *
- * \param fin  An open data file at the start of the SpotHeader data.
- * \param target  The destination for the read data.
- * \return  1 if successfully read, 0 otherwise.
+ * \param image  the entry index in the SimpleHdr table.
+ * \param scale  the multiplier for the cel size.
+ * \return  the cel, or NULL if it can't be read or has no area.
  */
-size_t ImportSpotHeader(FILE *fin, struct SpotHeader &target)
+const Cel *GetCel(uint16_t image, float scale)
 {
-    bool read =
-        fread(&target.ID[0], sizeof(target.ID),   1, sFin) &&
-        fread(&target.Qty,   sizeof(target.Qty),  1, sFin) &&
-        fread(&target.sOff,  sizeof(target.sOff), 1, sFin) &&
-        fread(&target.pOff,  sizeof(target.pOff), 1, sFin);
-
-    if (read) {
-        Swap32bit(target.sOff);
-        Swap32bit(target.pOff);
+    uint32_t scaleBits;
+    memcpy(&scaleBits, &scale, sizeof scaleBits);
+    CelKey key(image, scaleBits);
+
+    std::map<CelKey, Cel>::const_iterator it = celCache.find(key);
+
+    if (it != celCache.end()) {
+        return &it->second;
+    }
+
+    size_t listing = mainHeader.sOff + image * sizeof_SimpleHdr;
+
+    if (listing + sizeof_SimpleHdr > spotData.size()) {
+        return NULL;
+    }
+
+    uint32_t offset = ReadLE32(&spotData[listing + 2]);
+
+    if (offset + sizeof(struct CelHeader) > spotData.size()) {
+        return NULL;
+    }
+
+    struct CelHeader header = { spotData[offset], spotData[offset + 1] };
+    const uint8_t *src = &spotData[offset + sizeof(struct CelHeader)];
+
+    if (offset + sizeof(struct CelHeader) + header.w * header.h >
+        spotData.size()) {
+        return NULL;
+    }
+
+    Cel cel;
+    cel.w = header.w;
+    cel.h = header.h;
+
+    if (scale != 1.0) {
+        cel.w = (int)((float) header.w * scale);
+        cel.h = (int)((float) header.h * scale);
     }
 
-    return read ? 1 : 0;
+    if (cel.w <= 0 || cel.h <= 0) {
+        return NULL;
+    }
+
+    // Nearest-neighbor scaling, as LegacySurface::scaleTo() does.
+    cel.pixels.resize(cel.w * cel.h);
+
+    for (int row = 0; row < cel.h; row++) {
+        int srcRow = (row * header.h) / cel.h;
+
+        for (int col = 0; col < cel.w; col++) {
+            int srcCol = (col * header.w) / cel.w;
+            cel.pixels[row * cel.w + col] = src[srcRow * header.w + srcCol];
+        }
+    }
+
+    for (int row = 0; row < cel.h; row++) {
+        for (int col = 0; col < cel.w;) {
+            int start = col;
+
+            while (col < cel.w && cel.pixels[row * cel.w + col] != 0) {
+                col++;
+            }
+
+            if (col > start) {
+                cel.opaque.push_back(
+                    std::make_pair(row * cel.w + start, col - start));
+            }
+
+            while (col < cel.w && cel.pixels[row * cel.w + col] == 0) {
+                col++;
+            }
+        }
+    }
+
+    return &(celCache[key] = cel);
 }
 
 
 /**
- * Read a AnimationStep struct stored as raw data in a file, correcting
- * for endianess.
- *
- * If import is not successful, the contents of the target AnimationStep
- * are not guaranteed.
+ * Read spots.cdr into memory, if it hasn't been already.
  *
- * The format of the AnimationStep is:
- *   uint16_t Image;        // Which image to Use
- *   int16_t  xPut, yPut;   // Where to place this image
- *   int16_t iHold;         // Repeat this # times
- *   float Scale;       // Scale object
- *
- * \param fin  An open port data file at the start of the AnimationStep data.
- * \param target  The destination for the read data.
- * \return  1 if successfully read, 0 otherwise.
+ * \return  true if the animation data is available.
  */
-size_t ImportSPath(FILE *fin, struct AnimationStep &target)
+bool LoadSpotData()
 {
-    // Chain freads so they stop if one fails...
-    bool read =
-        fread(&target.Image, sizeof(target.Image), 1, fin) &&
-        fread(&target.xPut, sizeof(target.xPut), 1, fin) &&
-        fread(&target.yPut, sizeof(target.yPut), 1, fin) &&
-        fread(&target.iHold, sizeof(target.iHold), 1, fin) &&
-        fread(&target.Scale, sizeof(target.Scale), 1, fin);
-
-    if (read) {
-        Swap16bit(target.Image);
-        Swap16bit(target.xPut);
-        Swap16bit(target.yPut);
-        Swap16bit(target.iHold);
-        Swap32bit(target.Scale);
+    if (!spotData.empty()) {
+        return true;
+    }
+
+    FILE *fin = sOpen("SPOTS.CDR", "rb", FT_DATA);
+
+    if (!fin) {
+        CERROR2(multimedia, "Cannot open SPOTS.CDR");
+        return false;
     }
 
-    return (read ? 1 : 0);
+    fseek(fin, 0, SEEK_END);
+    long length = ftell(fin);
+    rewind(fin);
+
+    std::vector<uint8_t> data(MAX(length, 0L));
+    bool read = length > 0 && fread(&data[0], length, 1, fin) == 1;
+    fclose(fin);
+
+    if (!read || !ImportSpotHeader(&data[0], mainHeader) ||
+        mainHeader.pOff + mainHeader.Qty * sizeof(uint32_t) > data.size()) {
+        CERROR2(multimedia, "Cannot read SPOTS.CDR");
+        return false;
+    }
+
+    spotData.swap(data);
+    return true;
 }
 
 
 /**
- * Seeks the beginning of the animation sequence.
+ * Read the steps of an animation sequence into animationSteps.
  *
  * There is an animation directory listing the location in the file of
  * each animation. The file's main header lists how many animations
@@ -541,38 +632,92 @@ size_t ImportSPath(FILE *fin, struct AnimationStep &target)
  * Each listing is a 32-bit offset value of where to find an animation
  * header.
  *
- * Modifies the global sFin file.
- *
  * \param index  the animation's index in the animation table.
+ * \return  true if the animation was read.
  */
-void SeekAnimation(int index)
+bool ReadAnimation(int index)
 {
-    uint32_t animOffset;
-    fseek(sFin, index * (sizeof animOffset) + (mainHeader.pOff), SEEK_SET);
-    fread(&animOffset, sizeof animOffset, 1, sFin);
-    Swap32bit(animOffset);
-    fseek(sFin, animOffset, SEEK_SET);
+    const size_t nameLength = 20;
+    const size_t stepSize = 12;
+
+    uint32_t animOffset =
+        ReadLE32(&spotData[mainHeader.pOff + index * sizeof(uint32_t)]);
+
+    if (animOffset + nameLength + sizeof(int16_t) > spotData.size()) {
+        return false;
+    }
+
+    // Skip the animation name
+    size_t pos = animOffset + nameLength;
+    int16_t count = (int16_t)ReadLE16(&spotData[pos]);
+    pos += sizeof(int16_t);
+
+    if (count < 0 || pos + count * stepSize > spotData.size()) {
+        return false;
+    }
+
+    animationSteps.resize(count);
+
+    for (int i = 0; i < count; i++) {
+        pos += ImportSPath(&spotData[pos], animationSteps[i]);
+    }
+
+    return true;
 }
 
 
 /**
- * Seeks to the beginning of a cel image's dimension header in the
- * currently opened animation file.
+ * Read in the main header of a Spot animation file.
  *
- * For a given index, finds the entry for the matching animation cel
- * at the start of the dimension data (uint8_t width, uint8_t height)
- * right before the raw pixel data.
+ * \param src  The file data, at the start of the SpotHeader data.
+ * \param target  The destination for the read data.
+ * \return  1 if successfully read, 0 otherwise.
+ */
+size_t ImportSpotHeader(const uint8_t *src, struct SpotHeader &target)
+{
+    memcpy(&target.ID[0], src, sizeof(target.ID));
+    target.Qty = src[40];
+    target.sOff = ReadLE32(src + 41);
+    target.pOff = ReadLE32(src + 45);
+    return 1;
+}
+
+
+/**
+ * Read a AnimationStep struct stored as raw data in a file.
  *
- * Requires the global FILE sFin be open and mainHeader already read.
+ * The format of the AnimationStep is:
+ *   uint16_t Image;        // Which image to Use
+ *   int16_t  xPut, yPut;   // Where to place this image
+ *   int16_t iHold;         // Repeat this # times
+ *   float Scale;       // Scale object
  *
- * \param celIndex  the entry index in the SimpleHdr table.
+ * \param src  The file data, at the start of the AnimationStep data.
+ * \param target  The destination for the read data.
+ * \return  the number of bytes read.
  */
-void SeekCelData(int celIndex)
+size_t ImportSPath(const uint8_t *src, struct AnimationStep &target)
+{
+    uint32_t scale = ReadLE32(src + 8);
+
+    target.Image = ReadLE16(src);
+    target.xPut = (int16_t)ReadLE16(src + 2);
+    target.yPut = (int16_t)ReadLE16(src + 4);
+    target.iHold = (int16_t)ReadLE16(src + 6);
+    memcpy(&target.Scale, &scale, sizeof target.Scale);
+    return 12;
+}
+
+
+uint16_t ReadLE16(const uint8_t *src)
+{
+    return src[0] | (src[1] << 8);
+}
+
+
+uint32_t ReadLE32(const uint8_t *src)
 {
-    SimpleHdr imageListing;
-    fseek(sFin, celIndex * sizeof_SimpleHdr + mainHeader.sOff, SEEK_SET);
-    fread_SimpleHdr(&imageListing, 1, sFin);
-    fseek(sFin, imageListing.offset, SEEK_SET);
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
 }
 
 };  // End of anonymous namespace
@@ -0,0 +1,295 @@
+// This file handles the in-memory history of past turns.
+
+#include "turn_history.h"
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+#include <cereal/archives/portable_binary.hpp>
+
+#include "Buzz_inc.h"
+#include "byte_delta.h"
+#include "rng.h"
+
+GAME_LOCAL TurnHistory turnHistory;
+
+
+namespace
+{
+int TurnNumber(int year, int season)
+{
+    return 2 * year + season;
+}
+
+// The game data comes first, so it can be read on its own.
+std::vector<uint8_t> Serialize(const struct Players &state,
+                               const INTERIMDATA &interim,
+                               const GameRng &rng)
+{
+    std::ostringstream os;
+    {
+        cereal::PortableBinaryOutputArchive archive(os);
+        archive(state, interim, rng);
+    }
+    std::string bytes = os.str();
+    return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+};
+
+
+TurnHistory::TurnHistory(size_t capacity)
+    : capacity(capacity < 1 ? 1 : capacity)
+{
+}
+
+
+/**
+ * Add the state at the start of a turn as the newest turn.
+ *
+ * \param state  the game state; its Year and Season name the turn.
+ * \param interim  the replay and news data of the missions flown.
+ * \param rng  the random number generators.
+ */
+void TurnHistory::record(const struct Players &state,
+                         const INTERIMDATA &interim, const GameRng &rng)
+{
+    int turn = TurnNumber(state.Year, state.Season);
+
+    while (!turns.empty() &&
+           TurnNumber(turns.back().year, turns.back().season) >= turn) {
+        dropNewest();
+    }
+
+    std::vector<uint8_t> bytes = Serialize(state, interim, rng);
+
+    // States may differ in size, so the shorter is padded with zeros
+    if (!turns.empty()) {
+        size_t size = std::max(newest.size(), bytes.size());
+        std::vector<uint8_t> to(bytes);
+
+        newest.resize(size, 0);
+        to.resize(size, 0);
+        turns.back().delta = EncodeDelta(&newest[0], &to[0], size);
+    }
+
+    newest.swap(bytes);
+
+    Turn entry;
+    entry.year = state.Year;
+    entry.season = state.Season;
+    entry.size = newest.size();
+    turns.push_back(entry);
+
+    // The oldest turn needs nothing from the others, so it can simply
+    // be dropped.
+    if (turns.size() > capacity) {
+        turns.erase(turns.begin(), turns.end() - capacity);
+    }
+}
+
+
+void TurnHistory::clear()
+{
+    turns.clear();
+    newest.clear();
+}
+
+
+size_t TurnHistory::size() const
+{
+    return turns.size();
+}
+
+
+/**
+ * The turn stored at a position in the history.
+ *
+ * \param index  0 for the oldest turn, up to size() - 1.
+ * \return  false if there is no such turn.
+ */
+bool TurnHistory::turnAt(size_t index, int &year, int &season) const
+{
+    if (index >= turns.size()) {
+        return false;
+    }
+
+    year = turns[index].year;
+    season = turns[index].season;
+    return true;
+}
+
+
+/**
+ * Rebuild the game data at the start of a turn.
+ *
+ * \param index  0 for the oldest turn, up to size() - 1.
+ * \param state  receives the game state.
+ * \return  false if there is no such turn, or its data is damaged.
+ */
+bool TurnHistory::stateAt(size_t index, struct Players &state) const
+{
+    std::vector<uint8_t> bytes;
+
+    if (!rebuild(index, bytes)) {
+        return false;
+    }
+
+    try {
+        std::istringstream is(std::string(bytes.begin(), bytes.end()));
+        cereal::PortableBinaryInputArchive archive(is);
+        archive(state);
+    } catch (cereal::Exception &) {
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Rebuild the whole state at the start of a turn, as when rewinding
+ * to it.
+ *
+ * \param index  0 for the oldest turn, up to size() - 1.
+ * \param state  receives the game state.
+ * \param interim  receives the replay and news data.
+ * \param rng  receives the random number generators.
+ * \return  false if there is no such turn, or its data is damaged.
+ *     Nothing is changed then.
+ */
+bool TurnHistory::stateAt(size_t index, struct Players &state,
+                          INTERIMDATA &interim, GameRng &rng) const
+{
+    std::vector<uint8_t> bytes;
+    std::unique_ptr<struct Players> readState(new struct Players());
+    INTERIMDATA readInterim;
+    GameRng readRng;
+
+    if (!rebuild(index, bytes)) {
+        return false;
+    }
+
+    try {
+        std::istringstream is(std::string(bytes.begin(), bytes.end()));
+        cereal::PortableBinaryInputArchive archive(is);
+        archive(*readState, readInterim, readRng);
+    } catch (cereal::Exception &) {
+        return false;
+    }
+
+    state = *readState;
+    std::swap(interim, readInterim);
+    std::swap(rng, readRng);
+    return true;
+}
+
+
+/**
+ * Rebuild the state at the start of the given turn.
+ *
+ * \return  false if the turn is not in the history.
+ */
+bool TurnHistory::find(int year, int season, struct Players &state) const
+{
+    for (size_t i = turns.size(); i-- > 0;) {
+        if (turns[i].year == year && turns[i].season == season) {
+            return stateAt(i, state);
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * Keep only the oldest turns, as when rewinding to an earlier turn.
+ *
+ * \param count  the number of turns to keep.
+ */
+void TurnHistory::truncate(size_t count)
+{
+    while (turns.size() > count) {
+        dropNewest();
+    }
+}
+
+
+/**
+ * The memory taken by the stored states, in bytes.
+ */
+size_t TurnHistory::memoryUsed() const
+{
+    size_t total = newest.size();
+
+    for (size_t i = 0; i < turns.size(); i++) {
+        total += turns[i].delta.size();
+    }
+
+    return total;
+}
+
+
+/**
+ * The serialized state at the start of a turn.
+ *
+ * \param index  0 for the oldest turn, up to size() - 1.
+ * \param bytes  receives the state.
+ * \return  false if there is no such turn, or its data is damaged.
+ */
+bool TurnHistory::rebuild(size_t index, std::vector<uint8_t> &bytes) const
+{
+    if (index >= turns.size() || newest.empty()) {
+        return false;
+    }
+
+    bytes = newest;
+
+    for (size_t i = turns.size() - 1; i > index; i--) {
+        if (!stepBack(bytes, turns[i - 1])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * Turn a serialized state into the one of the turn before it.
+ *
+ * \param state  the state of the turn after older.
+ * \param older  the turn to go back to.
+ * \return  false if the difference is damaged.
+ */
+bool TurnHistory::stepBack(std::vector<uint8_t> &state, const Turn &older)
+{
+    state.resize(std::max<size_t>(state.size(), older.size), 0);
+
+    if (!ApplyDelta(older.delta, &state[0], state.size())) {
+        return false;
+    }
+
+    state.resize(older.size);
+    return true;
+}
+
+
+void TurnHistory::dropNewest()
+{
+    turns.pop_back();
+
+    if (turns.empty()) {
+        newest.clear();
+        return;
+    }
+
+    if (!stepBack(newest, turns.back())) {
+        // Without a sound delta the older states are lost too.
+        clear();
+        return;
+    }
+
+    turns.back().delta.clear();
+}
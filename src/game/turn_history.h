@@ -0,0 +1,109 @@
+#ifndef TURN_HISTORY_H
+#define TURN_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include <cereal/types/vector.hpp>
+
+#include "game_context.h"
+
+class GameRng;
+struct INTERIMDATA;
+struct Players;
+
+
+/**
+ * A history of the game state at the start of each turn.
+ *
+ * Each state holds the game data together with the interim replay and
+ * news data and the random number generators, so going back to a turn
+ * leaves nothing of the turns after it. States are kept as they
+ * serialize themselves into binary saves, so a history saved on one
+ * machine loads on any other. Only the newest
+ * state is kept whole. Each older turn is stored as the difference
+ * from the turn after it, XORed byte by byte and run length encoded,
+ * so a turn costs little more than the bytes which changed in it.
+ * Going back n turns applies n differences.
+ *
+ * Recording a turn no later than the newest one, as happens after
+ * rewinding or loading an earlier save, discards the turns it replaces.
+ */
+class TurnHistory
+{
+public:
+    explicit TurnHistory(size_t capacity = 80);
+
+    void record(const struct Players &state, const INTERIMDATA &interim,
+                const GameRng &rng);
+    void clear();
+
+    size_t size() const;
+    bool turnAt(size_t index, int &year, int &season) const;
+    bool stateAt(size_t index, struct Players &state) const;
+    bool stateAt(size_t index, struct Players &state, INTERIMDATA &interim,
+                 GameRng &rng) const;
+    bool find(int year, int season, struct Players &state) const;
+    void truncate(size_t count);
+    size_t memoryUsed() const;
+
+    template<class Archive>
+    void serialize(Archive &ar)
+    {
+        ar(capacity, turns, newest);
+    }
+
+    /**
+     * Read past a history from a save older than version 4, which held
+     * the states as raw memory, only good on the machine that wrote it.
+     * The history is left empty.
+     */
+    template<class Archive>
+    void skipRawHistory(Archive &ar)
+    {
+        std::vector<RawTurn> raw;
+        ar(capacity, raw, newest);
+        clear();
+    }
+
+private:
+    struct Turn {
+        int8_t year;
+        int8_t season;
+        uint32_t size;  // Of the turn's serialized state
+        // Difference to the next turn's state; empty for the newest turn
+        std::vector<uint8_t> delta;
+
+        template<class Archive>
+        void serialize(Archive &ar)
+        {
+            ar(year, season, size, delta);
+        }
+    };
+
+    struct RawTurn {
+        int8_t year;
+        int8_t season;
+        std::vector<uint8_t> delta;
+
+        template<class Archive>
+        void serialize(Archive &ar)
+        {
+            ar(year, season, delta);
+        }
+    };
+
+    bool rebuild(size_t index, std::vector<uint8_t> &bytes) const;
+    static bool stepBack(std::vector<uint8_t> &state, const Turn &older);
+    void dropNewest();
+
+    uint32_t capacity;
+    std::vector<Turn> turns;        // Oldest first
+    std::vector<uint8_t> newest;    // The newest state, serialized whole
+};
+
+extern GAME_LOCAL TurnHistory turnHistory;
+
+#endif // TURN_HISTORY_H
@@ -44,6 +44,7 @@
 
 #include "gamedata.h"
 #include "Buzz_inc.h"
+#include "asset_registry.h"
 #include "draw.h"
 #include "options.h"
 #include "admin.h"
@@ -79,8 +80,8 @@ LOG_DEFAULT_CATEGORY(LOG_ROOT_CAT);
  * potential payload combinations available at assembly time, each of
  * which is stored in VAS.
  */
-struct VInfo VAS[7][4];
-int VASqty;  // How many payload configurations there are
+GAME_LOCAL struct VInfo VAS[7][4];
+GAME_LOCAL int VASqty;  // How many payload configurations there are
 
 /* MI contains the location of a vehicle equipment image and its
  * positioning when drawn inside a vehicle casing.
@@ -188,7 +189,7 @@ void VVals(char plr, char tx, Equipment *EQ, char v4, char sprite);
  
 void LoadMIVals() {
     try {
-        DESERIALIZE_JSON_FILE(&MI, locate_file("vtable.json", FT_DATA));
+        MI = *AssetRegistry::get<std::vector<MDA> >("vtable.json");
 
         // Check if vector MI is empty after deserialization
         if (MI.empty()) {
@@ -374,7 +375,7 @@ void DispVAB(char plr, char pad)
     draw_string(40, 111, "MISSION HARDWARE:");
     draw_string(10, 119, "SELECT PAYLOADS AND BOOSTER");
 
-    struct mStr missionPlan = GetMissionPlan(mission.MissionCode);
+    const struct mStr &missionPlan = GetMissionPlan(mission.MissionCode);
 
     display::graphics.setForegroundColor(1);
     draw_string(5, 53, (missionPlan.Abbr).c_str());
@@ -1,10 +1,12 @@
 #ifndef VAB_H
 #define VAB_H
 
+#include "game_context.h"
+
 void VAB(char plr);
 void BuildVAB(char plr, char mis, char ty, char pa, char pr);
 
-extern struct VInfo VAS[7][4];
-extern int VASqty;
+extern GAME_LOCAL struct VInfo VAS[7][4];
+extern GAME_LOCAL int VASqty;
 
 #endif // VAB_H
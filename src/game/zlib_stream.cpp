@@ -0,0 +1,212 @@
+// This file handles streaming zlib compression to and from files.
+
+#include "zlib_stream.h"
+
+#include <cstring>
+
+
+namespace
+{
+const size_t CHUNK_SIZE = 64 * 1024;
+};
+
+
+DeflateStreamBuf::DeflateStreamBuf(FILE *out, int level)
+    : out(out), inBuf(CHUNK_SIZE), outBuf(CHUNK_SIZE), ok(true),
+      finished(false)
+{
+    memset(&zs, 0, sizeof(zs));
+    ok = (deflateInit(&zs, level) == Z_OK);
+    setp(&inBuf[0], &inBuf[0] + inBuf.size());
+}
+
+
+DeflateStreamBuf::~DeflateStreamBuf()
+{
+    if (!finished) {
+        deflateEnd(&zs);
+    }
+}
+
+
+/**
+ * Compress any buffered input and end the zlib stream.
+ *
+ * Nothing may be written through the buffer afterwards.
+ *
+ * \return  true if all of the data was compressed and written.
+ */
+bool DeflateStreamBuf::finish()
+{
+    if (finished) {
+        return ok;
+    }
+
+    if (ok) {
+        deflatePending(Z_FINISH);
+    }
+
+    deflateEnd(&zs);
+    finished = true;
+    return ok;
+}
+
+
+/**
+ * The number of uncompressed bytes consumed so far.
+ *
+ * This counts only data that has reached zlib, so it is exact after
+ * finish().
+ */
+uint32_t DeflateStreamBuf::totalIn() const
+{
+    return (uint32_t)zs.total_in;
+}
+
+
+DeflateStreamBuf::int_type DeflateStreamBuf::overflow(int_type c)
+{
+    if (finished || !deflatePending(Z_NO_FLUSH)) {
+        return traits_type::eof();
+    }
+
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+}
+
+
+int DeflateStreamBuf::sync()
+{
+    return (!finished && deflatePending(Z_NO_FLUSH)) ? 0 : -1;
+}
+
+
+/**
+ * Feed the buffered input to zlib and write out what it produces.
+ *
+ * \param flush  Z_NO_FLUSH, or Z_FINISH to end the stream.
+ * \return  false if compressing or writing failed.
+ */
+bool DeflateStreamBuf::deflatePending(int flush)
+{
+    if (!ok) {
+        return false;
+    }
+
+    zs.next_in = (Bytef *)pbase();
+    zs.avail_in = (uInt)(pptr() - pbase());
+
+    int ret;
+
+    do {
+        zs.next_out = (Bytef *)&outBuf[0];
+        zs.avail_out = (uInt)outBuf.size();
+        ret = deflate(&zs, flush);
+
+        if (ret == Z_STREAM_ERROR) {
+            ok = false;
+            break;
+        }
+
+        size_t have = outBuf.size() - zs.avail_out;
+
+        if (have && fwrite(&outBuf[0], 1, have, out) != have) {
+            ok = false;
+            break;
+        }
+    } while (zs.avail_out == 0);
+
+    if (flush == Z_FINISH && ret != Z_STREAM_END) {
+        ok = false;
+    }
+
+    setp(&inBuf[0], &inBuf[0] + inBuf.size());
+    return ok;
+}
+
+
+InflateStreamBuf::InflateStreamBuf(FILE *in)
+    : in(in), inBuf(CHUNK_SIZE), outBuf(CHUNK_SIZE), status(Z_OK)
+{
+    memset(&zs, 0, sizeof(zs));
+    status = inflateInit(&zs);
+    setg(&outBuf[0], &outBuf[0], &outBuf[0]);
+}
+
+
+InflateStreamBuf::~InflateStreamBuf()
+{
+    inflateEnd(&zs);
+}
+
+
+/**
+ * Whether the stream has inflated without error so far.
+ *
+ * Once the input is exhausted, this is true only if the complete
+ * zlib stream was read.
+ */
+bool InflateStreamBuf::good() const
+{
+    return status == Z_OK || status == Z_STREAM_END;
+}
+
+
+InflateStreamBuf::int_type InflateStreamBuf::underflow()
+{
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    while (status == Z_OK) {
+        if (zs.avail_in == 0) {
+            size_t got = fread(&inBuf[0], 1, inBuf.size(), in);
+
+            if (got == 0) {
+                // The file ended before the zlib stream did.
+                status = Z_DATA_ERROR;
+                break;
+            }
+
+            zs.next_in = (Bytef *)&inBuf[0];
+            zs.avail_in = (uInt)got;
+        }
+
+        zs.next_out = (Bytef *)&outBuf[0];
+        zs.avail_out = (uInt)outBuf.size();
+        status = inflate(&zs, Z_NO_FLUSH);
+
+        if (status == Z_BUF_ERROR) {
+            status = Z_OK;
+        }
+
+        size_t have = outBuf.size() - zs.avail_out;
+
+        if (have) {
+            setg(&outBuf[0], &outBuf[0], &outBuf[0] + have);
+            return traits_type::to_int_type(*gptr());
+        }
+    }
+
+    return traits_type::eof();
+}
+
+
+/**
+ * Check whether two bytes open a zlib stream as written by this game.
+ *
+ * The second byte records the compression level, so this accepts the
+ * header for any level rather than the level 9 bytes (0x78 0xDA)
+ * alone. Only the default 32K window is accepted, to keep the check
+ * from mistaking other data for a zlib stream.
+ */
+bool IsZlibHeader(const unsigned char magic[2])
+{
+    return magic[0] == 0x78 &&
+           (magic[1] == 0x01 || magic[1] == 0x5E || magic[1] == 0x9C ||
+            magic[1] == 0xDA);
+}
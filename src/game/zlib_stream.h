@@ -0,0 +1,81 @@
+#ifndef ZLIB_STREAM_H
+#define ZLIB_STREAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <streambuf>
+#include <vector>
+
+#include <zlib.h>
+
+
+/**
+ * An output stream buffer that deflates everything written through it
+ * into a zlib stream in an open file.
+ *
+ * Data is compressed as it arrives, so the uncompressed document
+ * never has to be held in memory. Call finish() once writing is done
+ * to complete the zlib stream.
+ */
+class DeflateStreamBuf : public std::streambuf
+{
+public:
+    DeflateStreamBuf(FILE *out, int level = Z_DEFAULT_COMPRESSION);
+    virtual ~DeflateStreamBuf();
+
+    bool finish();
+    uint32_t totalIn() const;
+
+protected:
+    virtual int_type overflow(int_type c);
+    virtual int sync();
+
+private:
+    bool deflatePending(int flush);
+
+    FILE *out;
+    z_stream zs;
+    std::vector<char> inBuf;
+    std::vector<char> outBuf;
+    bool ok;
+    bool finished;
+
+    DeflateStreamBuf(const DeflateStreamBuf &);
+    DeflateStreamBuf &operator=(const DeflateStreamBuf &);
+};
+
+
+/**
+ * An input stream buffer that inflates a zlib stream read from an
+ * open file.
+ *
+ * Reading stops at the end of the zlib stream. A corrupt or truncated
+ * stream ends the input early and is reported by good().
+ */
+class InflateStreamBuf : public std::streambuf
+{
+public:
+    explicit InflateStreamBuf(FILE *in);
+    virtual ~InflateStreamBuf();
+
+    bool good() const;
+
+protected:
+    virtual int_type underflow();
+
+private:
+    FILE *in;
+    z_stream zs;
+    std::vector<char> inBuf;
+    std::vector<char> outBuf;
+    int status;
+
+    InflateStreamBuf(const InflateStreamBuf &);
+    InflateStreamBuf &operator=(const InflateStreamBuf &);
+};
+
+
+bool IsZlibHeader(const unsigned char magic[2]);
+
+#endif // ZLIB_STREAM_H
@@ -0,0 +1,106 @@
+#include <boost/test/unit_test.hpp>
+
+#include "game/aibench.h"
+#include "game/filesystem.h"
+
+
+BOOST_AUTO_TEST_SUITE(aibench_suite)
+
+BOOST_AUTO_TEST_CASE(aibench_counts_phases_test)
+{
+    AIBenchCounts run[AIBENCH_PHASES];
+
+    AIBenchStart(run);
+
+    {
+        AIBenchScope outer(AIBENCH_AIPur);
+        AIBenchFileOpened();
+
+        {
+            AIBenchScope inner(AIBENCH_SelectBest);
+            AIBenchFileOpened();
+        }
+    }
+
+    {
+        AIBenchScope again(AIBENCH_SelectBest);
+    }
+
+    AIBenchStop();
+
+    BOOST_CHECK_EQUAL(run[AIBENCH_AIPur].calls, 1u);
+    BOOST_CHECK_EQUAL(run[AIBENCH_AIPur].fileOpens, 2u);
+    BOOST_CHECK_EQUAL(run[AIBENCH_SelectBest].calls, 2u);
+    BOOST_CHECK_EQUAL(run[AIBENCH_SelectBest].fileOpens, 1u);
+    BOOST_CHECK_EQUAL(run[AIBENCH_AIMaster].calls, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(aibench_outside_run_test)
+{
+    AIBenchCounts run[AIBENCH_PHASES];
+
+    AIBenchStart(run);
+    AIBenchStop();
+
+    {
+        AIBenchScope scope(AIBENCH_NewAI);
+        AIBenchFileOpened();
+    }
+
+    BOOST_CHECK_EQUAL(run[AIBENCH_NewAI].calls, 0u);
+    BOOST_CHECK_EQUAL(run[AIBENCH_NewAI].fileOpens, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(aibench_open_hook_test)
+{
+    AIBenchCounts run[AIBENCH_PHASES];
+
+    AIBenchStart(run);
+
+    {
+        AIBenchScope scope(AIBENCH_AIEvent);
+        Filesystem::fileOpened();   // No hook yet
+        Filesystem::setOpenHook(AIBenchFileOpened);
+        Filesystem::fileOpened();
+        Filesystem::setOpenHook(NULL);
+    }
+
+    AIBenchStop();
+
+    BOOST_CHECK_EQUAL(run[AIBENCH_AIEvent].fileOpens, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(aibench_stop_inside_scope_test)
+{
+    AIBenchCounts run[AIBENCH_PHASES];
+
+    AIBenchStart(run);
+
+    {
+        AIBenchScope scope(AIBENCH_AILaunch);
+        AIBenchStop();
+    }
+
+    BOOST_CHECK_EQUAL(run[AIBENCH_AILaunch].calls, 0u);
+}
+
+#ifdef BENCH_ALLOCATIONS
+BOOST_AUTO_TEST_CASE(aibench_counts_allocations_test)
+{
+    AIBenchCounts run[AIBENCH_PHASES];
+
+    AIBenchStart(run);
+
+    {
+        AIBenchScope scope(AIBENCH_AIEvent);
+        delete new int(1);
+        delete[] new char[10];
+    }
+
+    AIBenchStop();
+
+    BOOST_CHECK_EQUAL(run[AIBENCH_AIEvent].allocations, 2u);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,142 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+
+#include "game/Buzz_inc.h"
+#include "game/asset_index.h"
+#include "game/game_main.h"
+#include "game/mc.h"
+#include "game/mis_m.h"
+#include "game/mission_odds.h"
+#include "game/pace.h"
+#include "game/rng.h"
+
+/*
+ * An unmanned mission of a launch and two probe steps, flown by the
+ * computer player. With no failure tables loaded, any failure ends
+ * the mission.
+ */
+struct MissionOddsFixture {
+    MissionOddsFixture()
+    {
+        Data = new struct Players();
+        Assets = new struct AssetData();
+        IndexAssets(*Assets);
+
+        AI[0] = 1;
+        JOINT = 0;
+        MANNED[0] = MANNED[1] = 0;
+        fEarly = 0;
+        memset(MH, 0x00, sizeof(MH));
+
+        Equipment *rocket = &Data->P[0].Rocket[0];
+        Equipment *probe = &Data->P[0].Probe[0];
+        rocket->MisSaf = 90;
+        probe->MisSaf = 85;
+        MH[0][Mission_PrimaryBooster] = rocket;
+        MH[0][Mission_Probe_DM] = probe;
+
+        Data->P[0].Mission[0].MissionCode = Mission_Orbital_Satellite;
+
+        memset(steps, 0x00, sizeof(steps));
+        AddStep(0, "AUP1", Mission_PrimaryBooster, 0);
+        AddStep(1, "BUP1", Mission_Probe_DM, 0);
+        AddStep(2, "CUP1", Mission_Probe_DM, -15);
+        steps[2].sgoto = 100;
+        steps[3].loc = 0x7f;
+
+        gameRng.seed(1957);
+    }
+    ~MissionOddsFixture()
+    {
+        delete Assets;
+        Assets = NULL;
+        delete Data;
+        Data = NULL;
+    }
+
+    void AddStep(int step, const char *name, int hardware, int asf)
+    {
+        steps[step].step = step;
+        steps[step].loc = step + 1;
+        steps[step].pad = 0;
+        steps[step].Class = hardware;
+        steps[step].Ep = MH[0][hardware];
+        steps[step].asf = asf;
+        steps[step].fgoto = -1;
+        strcpy(steps[step].Name, name);
+        strcpy(steps[step].FName, "F000");
+    }
+
+    /* Stage the mission again, rolling the dice as StageMission() does. */
+    void Stage()
+    {
+        memcpy(Mev, steps, sizeof(steps));
+        Data->P[0].Mission[0].Duration = 0;
+
+        for (int i = 0; Mev[i].loc != 0x7f; i++) {
+            if (Data->Def.Lev1 == 0) {
+                Mev[i].dice = MisRandom();
+            } else {
+                Mev[i].dice = brandom(98, RNG_Mission) + 1;
+            }
+
+            Mev[i].rnum = brandom(10000, RNG_Mission) + 1;
+        }
+    }
+
+    /* Fly the mission many times and compare how it went to the odds. */
+    void CheckOdds()
+    {
+        const int trials = 20000;
+        int succeeded = 0;
+        int failed = 0;
+        MissionView view;
+
+        Stage();
+        const struct MissionOdds odds = StagedMissionOdds(0, 0);
+
+        for (int i = 0; i < trials; i++) {
+            Stage();
+            std::vector<StepOutcome> trace = ResolveMission(0, 0, view);
+            bool problem = false;
+
+            for (size_t s = 0; s < trace.size(); s++) {
+                problem = problem || trace[s].problem;
+            }
+
+            if (problem) {
+                failed++;
+            } else {
+                succeeded++;
+            }
+
+            BOOST_REQUIRE_EQUAL(death, 0);
+        }
+
+        BOOST_CHECK_SMALL(succeeded / (double)trials - odds.success, 0.02);
+        BOOST_CHECK_SMALL(failed / (double)trials - odds.failure, 0.02);
+        BOOST_CHECK_SMALL(odds.partial, 1e-9);
+        BOOST_CHECK_SMALL(odds.crewLoss, 1e-9);
+    }
+
+    struct MisEval steps[MAX_STEPS];
+};
+
+
+BOOST_AUTO_TEST_SUITE(mission_odds_suite)
+
+BOOST_FIXTURE_TEST_CASE(mission_odds_uniform_test, MissionOddsFixture)
+{
+    Data->Def.Lev1 = 1;
+    CheckOdds();
+}
+
+BOOST_FIXTURE_TEST_CASE(mission_odds_easy_test, MissionOddsFixture)
+{
+    // The easiest level rolls with MisRandom()
+    Data->Def.Lev1 = 0;
+    CheckOdds();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
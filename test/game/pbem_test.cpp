@@ -0,0 +1,104 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "game/byte_delta.h"
+#include "game/pbm.h"
+
+struct PbemFixture {
+    PbemFixture()
+        : base(4000, 'a'), state(base)
+    {
+        state[10] = 'b';
+        state.replace(2000, 5, "xyzzy");
+        state.append("the rest of the turn");
+        SetPbemBase(base);
+    }
+    ~PbemFixture()
+    {
+        ClearPbemBase();
+    }
+
+    std::string base;
+    std::string state;
+};
+
+
+BOOST_AUTO_TEST_SUITE(pbem_suite)
+
+BOOST_AUTO_TEST_CASE(byte_delta_round_trip_test)
+{
+    std::vector<uint8_t> a(300, 7), b(a);
+    b[0] = 1;
+    b[150] = 2;
+    b[299] = 3;
+
+    std::vector<uint8_t> delta = EncodeDelta(a.data(), b.data(), a.size());
+    std::vector<uint8_t> result(a);
+
+    BOOST_CHECK(delta.size() < a.size());
+    BOOST_CHECK(ApplyDelta(delta, result.data(), result.size()));
+    BOOST_CHECK(result == b);
+
+    // The same delta turns it back
+    BOOST_CHECK(ApplyDelta(delta, result.data(), result.size()));
+    BOOST_CHECK(result == a);
+}
+
+BOOST_AUTO_TEST_CASE(byte_delta_size_mismatch_test)
+{
+    std::vector<uint8_t> a(100, 0), b(100, 1);
+    std::vector<uint8_t> delta = EncodeDelta(a.data(), b.data(), a.size());
+    std::vector<uint8_t> shorter(50, 0);
+
+    BOOST_CHECK(!ApplyDelta(delta, shorter.data(), shorter.size()));
+}
+
+BOOST_FIXTURE_TEST_CASE(pbem_delta_round_trip_test, PbemFixture)
+{
+    PbemDelta delta = MakePbemDelta(state);
+    std::string result;
+
+    BOOST_CHECK(delta.stateSize == state.size());
+    BOOST_CHECK(ApplyPbemDelta(delta, result));
+    BOOST_CHECK(result == state);
+}
+
+BOOST_FIXTURE_TEST_CASE(pbem_delta_shrink_test, PbemFixture)
+{
+    std::string shorter(base, 0, 1000);
+    PbemDelta delta = MakePbemDelta(shorter);
+    std::string result;
+
+    BOOST_CHECK(ApplyPbemDelta(delta, result));
+    BOOST_CHECK(result == shorter);
+}
+
+BOOST_FIXTURE_TEST_CASE(pbem_delta_crc_mismatch_test, PbemFixture)
+{
+    PbemDelta delta = MakePbemDelta(state);
+    std::string result("unchanged");
+
+    delta.stateHash ^= 1;
+    BOOST_CHECK(!ApplyPbemDelta(delta, result));
+    BOOST_CHECK(result == "unchanged");
+    BOOST_CHECK(HavePbemBase());
+}
+
+BOOST_FIXTURE_TEST_CASE(pbem_delta_wrong_base_test, PbemFixture)
+{
+    PbemDelta delta = MakePbemDelta(state);
+    std::string result;
+
+    // Against another base the delta gives another state, which the
+    // sender's checksum catches
+    base[20] = 'c';
+    SetPbemBase(base);
+    delta.baseHash = crc32(0L, (const Bytef *)base.data(), base.size());
+    BOOST_CHECK(!ApplyPbemDelta(delta, result));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,178 @@
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <sstream>
+
+#include <cereal/archives/portable_binary.hpp>
+
+#include "game/Buzz_inc.h"
+#include "game/admin.h"
+#include "game/data.h"
+#include "game/game_main.h"
+#include "game/pace.h"
+#include "game/rng.h"
+#include "game/turn_history.h"
+
+struct TurnHistoryFixture {
+    TurnHistoryFixture()
+        : state(new struct Players()), restored(new struct Players())
+    {
+        // Spring 1957 to Fall 1958, with the cash changing each turn
+        for (int turn = 0; turn < 4; turn++) {
+            state->Year = 57 + turn / 2;
+            state->Season = turn % 2;
+            state->P[0].Cash = 100 + turn;
+            state->P[1].Cash = 200 - turn;
+            history.record(*state, interim, rng);
+        }
+    }
+    ~TurnHistoryFixture()
+    {
+    }
+
+    std::unique_ptr<struct Players> state;
+    std::unique_ptr<struct Players> restored;
+    INTERIMDATA interim;
+    GameRng rng;
+    TurnHistory history;
+};
+
+
+/* The live game, going through the turns as Admin() records them. */
+struct RewindFixture {
+    RewindFixture()
+    {
+        Data = new struct Players();
+        Data->Year = 57;
+        Data->Season = 0;
+        interimData = INTERIMDATA();
+        gameRng.seed(1957);
+        turnHistory.clear();
+        turnHistory.record(*Data, interimData, gameRng);
+    }
+    ~RewindFixture()
+    {
+        turnHistory.clear();
+        interimData = INTERIMDATA();
+        delete Data;
+        Data = NULL;
+    }
+
+    /* Fly a mission as MisCheck() records its replay, then end the turn. */
+    void FlyMission()
+    {
+        brandom(100, RNG_Mission);
+        interimData.tempReplay[0].push_back({false, "AUP1"});
+        interimData.tempEvents[0] = "LAUNCH";
+        Data->P[0].Cash += 10;
+    }
+
+    void NextTurn()
+    {
+        Data->Season = 1;
+        turnHistory.record(*Data, interimData, gameRng);
+    }
+};
+
+
+BOOST_AUTO_TEST_SUITE(turn_history_suite)
+
+BOOST_FIXTURE_TEST_CASE(turn_history_state_at_test, TurnHistoryFixture)
+{
+    BOOST_CHECK_EQUAL(history.size(), 4u);
+
+    for (int turn = 0; turn < 4; turn++) {
+        BOOST_CHECK(history.stateAt(turn, *restored));
+        BOOST_CHECK_EQUAL(restored->Year, 57 + turn / 2);
+        BOOST_CHECK_EQUAL(restored->Season, turn % 2);
+        BOOST_CHECK_EQUAL(restored->P[0].Cash, 100 + turn);
+        BOOST_CHECK_EQUAL(restored->P[1].Cash, 200 - turn);
+    }
+
+    BOOST_CHECK(!history.stateAt(4, *restored));
+}
+
+BOOST_FIXTURE_TEST_CASE(turn_history_find_test, TurnHistoryFixture)
+{
+    BOOST_CHECK(history.find(57, 1, *restored));
+    BOOST_CHECK_EQUAL(restored->P[0].Cash, 101);
+    BOOST_CHECK(!history.find(59, 0, *restored));
+}
+
+BOOST_FIXTURE_TEST_CASE(turn_history_rewind_test, TurnHistoryFixture)
+{
+    // Recording an earlier turn again drops the turns after it
+    BOOST_CHECK(history.stateAt(1, *restored));
+    restored->P[0].Cash = 500;
+    history.record(*restored, interim, rng);
+
+    BOOST_CHECK_EQUAL(history.size(), 2u);
+    BOOST_CHECK(history.stateAt(0, *restored));
+    BOOST_CHECK_EQUAL(restored->P[0].Cash, 100);
+    BOOST_CHECK(history.stateAt(1, *restored));
+    BOOST_CHECK_EQUAL(restored->P[0].Cash, 500);
+}
+
+BOOST_FIXTURE_TEST_CASE(turn_history_whole_state_test, TurnHistoryFixture)
+{
+    INTERIMDATA readInterim;
+    GameRng readRng;
+
+    // The newest turn follows a mission's replay and some dice rolls
+    state->Season = 1;
+    interim.tempReplay[3].push_back({true, "F101"});
+    rng.stream(RNG_Mission).next();
+    history.record(*state, interim, rng);
+
+    BOOST_CHECK(history.stateAt(2, *restored, readInterim, readRng));
+    BOOST_CHECK(readInterim.tempReplay[3].empty());
+    BOOST_CHECK(history.stateAt(3, *restored, readInterim, readRng));
+    BOOST_CHECK_EQUAL(readInterim.tempReplay[3].size(), 1u);
+    BOOST_CHECK_EQUAL(readRng.stream(RNG_Mission).next(),
+                      rng.stream(RNG_Mission).next());
+}
+
+BOOST_FIXTURE_TEST_CASE(turn_history_serialize_test, TurnHistoryFixture)
+{
+    std::stringstream stream;
+    TurnHistory loaded;
+
+    {
+        cereal::PortableBinaryOutputArchive archive(stream);
+        archive(history);
+    }
+
+    {
+        cereal::PortableBinaryInputArchive archive(stream);
+        archive(loaded);
+    }
+
+    BOOST_CHECK_EQUAL(loaded.size(), 4u);
+    BOOST_CHECK(loaded.stateAt(2, *restored));
+    BOOST_CHECK_EQUAL(restored->Year, 58);
+    BOOST_CHECK_EQUAL(restored->P[1].Cash, 198);
+}
+
+BOOST_FIXTURE_TEST_CASE(turn_history_rewind_mission_test, RewindFixture)
+{
+    FlyMission();
+    NextTurn();
+
+    int roll = brandom(100, RNG_Mission);
+
+    BOOST_REQUIRE(RewindTurn());
+    BOOST_CHECK_EQUAL(Data->Season, 0);
+    BOOST_CHECK(interimData.tempReplay[0].empty());
+    BOOST_CHECK(interimData.tempEvents[0].empty());
+
+    // Flying it again replays the turn, without the first flight's replay
+    FlyMission();
+    NextTurn();
+
+    BOOST_CHECK_EQUAL(interimData.tempReplay[0].size(), 1u);
+    BOOST_CHECK_EQUAL(Data->P[0].Cash, 10);
+    BOOST_CHECK_EQUAL(brandom(100, RNG_Mission), roll);
+    BOOST_CHECK_EQUAL(turnHistory.size(), 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()